@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ * @file           : bl_host_cmsis.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_HOST_CMSIS_H
+#define BL_HOST_CMSIS_H
+
+/* Stands in for cmsis_gcc.h, which the build skips with -D__CMSIS_GCC_H: its
+ * intrinsics are Arm instructions the host assembler does not know. The
+ * attribute and unaligned access macros are the ones of cmsis_gcc.h, the
+ * intrinsics do nothing or are written in C. */
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include <stdint.h>
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+#define __ASM                                  __asm
+#define __INLINE                               inline
+#define __STATIC_INLINE                        static inline
+#define __STATIC_FORCEINLINE                   __attribute__((always_inline)) static inline
+#define __NO_RETURN                            __attribute__((__noreturn__))
+#define __USED                                 __attribute__((used))
+#define __WEAK                                 __attribute__((weak))
+#define __PACKED                               __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT                        struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION                         union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)                           __attribute__((aligned(x)))
+#define __RESTRICT                             __restrict
+
+__PACKED_STRUCT T_UINT16_WRITE { uint16_t v; };
+#define __UNALIGNED_UINT16_WRITE(addr, val)    (void)((((struct T_UINT16_WRITE *)(void *)(addr))->v) = (val))
+__PACKED_STRUCT T_UINT16_READ { uint16_t v; };
+#define __UNALIGNED_UINT16_READ(addr)          (((const struct T_UINT16_READ *)(const void *)(addr))->v)
+__PACKED_STRUCT T_UINT32_WRITE { uint32_t v; };
+#define __UNALIGNED_UINT32_WRITE(addr, val)    (void)((((struct T_UINT32_WRITE *)(void *)(addr))->v) = (val))
+__PACKED_STRUCT T_UINT32_READ { uint32_t v; };
+#define __UNALIGNED_UINT32_READ(addr)          (((const struct T_UINT32_READ *)(const void *)(addr))->v)
+
+#define __NOP()                                ((void)0)
+#define __WFI()                                ((void)0)
+#define __WFE()                                ((void)0)
+#define __SEV()                                ((void)0)
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+
+/*------------------ SW INTERFACES DECLARATIONS ---------------------*/
+__STATIC_FORCEINLINE void __enable_irq(void) {}
+__STATIC_FORCEINLINE void __disable_irq(void) {}
+__STATIC_FORCEINLINE void __set_MSP(uint32_t topOfMainStack) { (void)topOfMainStack; }
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask) { (void)priMask; }
+__STATIC_FORCEINLINE void __ISB(void) { __sync_synchronize(); }
+__STATIC_FORCEINLINE void __DSB(void) { __sync_synchronize(); }
+__STATIC_FORCEINLINE void __DMB(void) { __sync_synchronize(); }
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value) { return __builtin_bswap32(value); }
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value)
+{
+  uint32_t result = 0U;
+  uint32_t bit;
+  for (bit = 0U; bit < 32U; bit++)
+  {
+    result = (result << 1) | ((value >> bit) & 1U);
+  }
+  return result;
+}
+#define __CLZ(value)                           (((value) == 0U) ? 32U : (uint32_t)__builtin_clz(value))
+
+/*------------------ SW INTERFACES DECLARATIONS END -----------------*/
+
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ ******************************************************************************
+ * @file           : bl_host_stubs.c
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+/* The few HAL pieces the bootloader links against, for the host tests. The
+ * CRC unit is modelled (CRC-32, poly 0x04C11DB7, init 0xFFFFFFFF, one 32 bit
+ * word per write, no reflection) because the frame check goes through it.
+ * Flash is not there: every flash call fails, the tests stay off commands
+ * that need it. The UART swallows the debug messages. */
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "main.h"
+#include "crc.h"
+#include "usart.h"
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ GLOBAL DECLARATION ---------------------*/
+static CRC_TypeDef Host_CRC_Unit = { .DR = 0xFFFFFFFFU };
+
+CRC_HandleTypeDef  hcrc  = { .Instance = &Host_CRC_Unit, .Lock = HAL_UNLOCKED, .State = HAL_CRC_STATE_READY };
+UART_HandleTypeDef huart1;
+UART_HandleTypeDef huart2;
+
+/*------------------ GLOBAL DECLARATION END ---------------------*/
+
+
+
+/*------------------ SW INTERFACES DEFINITIONS ---------------------*/
+uint32_t HAL_CRC_Accumulate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength)
+{
+  uint32_t Word_Index = 0;
+  uint32_t Bit_Index  = 0;
+  uint32_t CRC32      = 0;
+
+  /* __HAL_CRC_DR_RESET only sets the bit, the unit would reload DR at once */
+  if(hcrc->Instance->CR & CRC_CR_RESET){
+    hcrc->Instance->DR  = 0xFFFFFFFFU;
+    hcrc->Instance->CR &= ~CRC_CR_RESET;
+  }
+  else {/*Nothing to be done */}
+
+  CRC32 = hcrc->Instance->DR;
+  for(Word_Index=0;Word_Index<BufferLength;Word_Index++){
+    CRC32 ^= pBuffer[Word_Index];
+    for(Bit_Index=0;Bit_Index<32U;Bit_Index++){
+      CRC32 = (CRC32 & 0x80000000U) ? ((CRC32 << 1) ^ 0x04C11DB7U) : (CRC32 << 1);
+    }
+  }
+  hcrc->Instance->DR = CRC32;
+  return CRC32;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+  (void)huart;
+  (void)pData;
+  (void)Size;
+  (void)Timeout;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+  return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+  (void)TypeProgram;
+  (void)Address;
+  (void)Data;
+  return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+  (void)pEraseInit;
+  *PageError = 0xFFFFFFFFU;
+  return HAL_ERROR;
+}
+
+void HAL_FLASHEx_OBGetConfig(FLASH_OBProgramInitTypeDef *pOBInit)
+{
+  pOBInit->RDPLevel = OB_RDP_LEVEL_0;
+  pOBInit->WRPPage  = 0U;
+}
+
+HAL_StatusTypeDef HAL_RCC_DeInit(void)
+{
+  return HAL_OK;
+}
+
+/*------------------ SW INTERFACES DEFINITIONS END -----------------*/
@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ * @file           : bl_host_test.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_HOST_TEST_H
+#define BL_HOST_TEST_H
+
+/* Check macro shared by the host tests. A failed check prints where it
+ * failed and counts, the test program returns the count so ctest sees it. */
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+#define BL_TEST_CHECK(Condition)                                          \
+  do {                                                                    \
+    BL_Test_Checks++;                                                     \
+    if(!(Condition)){                                                     \
+      BL_Test_Failures++;                                                 \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); \
+    }                                                                     \
+  } while(0)
+
+#define BL_TEST_RUN(Test)                                                 \
+  do {                                                                    \
+    uint32_t Failures_Before = BL_Test_Failures;                          \
+    Test();                                                               \
+    printf("%-40s %s\n", #Test, (BL_Test_Failures == Failures_Before) ? "PASS" : "FAIL"); \
+  } while(0)
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+
+/*------------------ GLOBAL DECLARATION ---------------------*/
+/* Defined once by each test program */
+extern uint32_t BL_Test_Checks;
+extern uint32_t BL_Test_Failures;
+
+/*------------------ GLOBAL DECLARATION END ---------------------*/
+
+
+#endif
@@ -0,0 +1,311 @@
+/**
+ ******************************************************************************
+ * @file           : test_loopback.c
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+/* Feeds frames to BL_UART_FETCH_HOST_COMMAND through the loopback transport
+ * and checks what comes back: a good frame is answered, a bad CRC, a short
+ * or a truncated frame gets a NACK, an empty or oversize frame gets nothing,
+ * and the next good frame is read from its first byte in every case. A batch
+ * of queries is answered entry by entry, an empty one with no entries. */
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include <string.h>
+#include "bootloader.h"
+#include "bl_transport.h"
+#include "bl_host_test.h"
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+#define TEST_FRAME_MAX_LENGTH                  (BL_LOOPBACK_BUFFER_SIZE)
+#define TEST_VERSION_REPLY_LENGTH              6U
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+
+/*------------------ GLOBAL DECLARATION ---------------------*/
+uint32_t BL_Test_Checks   = 0;
+uint32_t BL_Test_Failures = 0;
+
+static const uint8_t Test_Version_Reply[TEST_VERSION_REPLY_LENGTH] = {
+  CBL_SEND_ACK, 4U, CBL_VERSION_ID, CBL_SW_MAJOR_VERSION, CBL_SW_MINORR_VERSION, CBL_SW_PATCH_VERSION
+};
+
+/*------------------ GLOBAL DECLARATION END ---------------------*/
+
+
+
+/*------------------ SW INTERFACES DECLARATIONS ---------------------*/
+/**
+ * @brief The CRC the host puts after a frame: CRC-32 of the unit, each byte
+ *        fed as one 32 bit word, like Calculate_CRC32 in Host.py.
+ */
+static uint32_t Test_CRC32(const uint8_t *pData, uint32_t Length);
+
+/**
+ * @brief Builds [length][command][payload][CRC32, little endian].
+ *
+ * @return Number of bytes in pFrame.
+ */
+static uint16_t Test_Build_Frame(uint8_t *pFrame, uint8_t Command, const uint8_t *pPayload, uint8_t Payload_Length);
+
+/**
+ * @brief Injects a frame, runs one fetch and collects the answer.
+ *
+ * @return Number of bytes the bootloader sent.
+ */
+static uint16_t Test_Exchange(const uint8_t *pFrame, uint16_t Frame_Length, BL_status *pStatus, uint8_t *pReply);
+
+/**
+ * @brief Sends a good CBL_GET_VER_CMD and checks the version comes back and
+ *        nothing is left in the receive queue.
+ */
+static void Test_Expect_Synchronised(void);
+
+/*------------------ SW INTERFACES DECLARATIONS END -----------------*/
+
+
+
+/*------------------ SW INTERFACES DEFINITIONS ---------------------*/
+static uint32_t Test_CRC32(const uint8_t *pData, uint32_t Length)
+{
+  uint32_t CRC32      = 0xFFFFFFFFU;
+  uint32_t Byte_Index = 0;
+  uint32_t Bit_Index  = 0;
+  for(Byte_Index=0;Byte_Index<Length;Byte_Index++){
+    CRC32 ^= pData[Byte_Index];
+    for(Bit_Index=0;Bit_Index<32U;Bit_Index++){
+      CRC32 = (CRC32 & 0x80000000U) ? ((CRC32 << 1) ^ 0x04C11DB7U) : (CRC32 << 1);
+    }
+  }
+  return CRC32;
+}
+
+static uint16_t Test_Build_Frame(uint8_t *pFrame, uint8_t Command, const uint8_t *pPayload, uint8_t Payload_Length)
+{
+  uint16_t Frame_Length = 0;
+  uint32_t CRC32        = 0;
+  pFrame[0] = (uint8_t)(1U + Payload_Length + CRC_TYPE_SIZE);
+  pFrame[1] = Command;
+  if(Payload_Length > 0U){
+    memcpy(&pFrame[2], pPayload, Payload_Length);
+  }
+  else {/*Nothing to be done */}
+  Frame_Length = (uint16_t)(2U + Payload_Length);
+  CRC32 = Test_CRC32(pFrame, Frame_Length);
+  pFrame[Frame_Length++] = (uint8_t)(CRC32);
+  pFrame[Frame_Length++] = (uint8_t)(CRC32 >> 8);
+  pFrame[Frame_Length++] = (uint8_t)(CRC32 >> 16);
+  pFrame[Frame_Length++] = (uint8_t)(CRC32 >> 24);
+  return Frame_Length;
+}
+
+static uint16_t Test_Exchange(const uint8_t *pFrame, uint16_t Frame_Length, BL_status *pStatus, uint8_t *pReply)
+{
+  BL_TEST_CHECK(Frame_Length == BL_Loopback_Inject(pFrame, Frame_Length));
+  *pStatus = BL_UART_FETCH_HOST_COMMAND();
+  return BL_Loopback_Collect(pReply, TEST_FRAME_MAX_LENGTH);
+}
+
+static void Test_Expect_Synchronised(void)
+{
+  uint8_t   Frame[TEST_FRAME_MAX_LENGTH] = {0};
+  uint8_t   Reply[TEST_FRAME_MAX_LENGTH] = {0};
+  uint16_t  Frame_Length = 0;
+  uint16_t  Reply_Length = 0;
+  BL_status Status       = BL_NACK;
+  Frame_Length = Test_Build_Frame(Frame, CBL_GET_VER_CMD, NULL, 0);
+  Reply_Length = Test_Exchange(Frame, Frame_Length, &Status, Reply);
+  BL_TEST_CHECK(BL_OK == Status);
+  BL_TEST_CHECK(TEST_VERSION_REPLY_LENGTH == Reply_Length);
+  BL_TEST_CHECK(0 == memcmp(Reply, Test_Version_Reply, TEST_VERSION_REPLY_LENGTH));
+  /* Nothing of the frame may be left for the next fetch */
+  BL_TEST_CHECK(HAL_TIMEOUT == BL_Transport_Receive_Frame(Frame, BL_HOST_BUFFER_length));
+}
+
+static void Test_Good_Frame(void)
+{
+  BL_Transport_Open();
+  Test_Expect_Synchronised();
+}
+
+static void Test_Bad_CRC(void)
+{
+  uint8_t   Frame[TEST_FRAME_MAX_LENGTH] = {0};
+  uint8_t   Reply[TEST_FRAME_MAX_LENGTH] = {0};
+  uint16_t  Frame_Length = 0;
+  uint16_t  Reply_Length = 0;
+  BL_status Status       = BL_NACK;
+  BL_Transport_Open();
+  Frame_Length = Test_Build_Frame(Frame, CBL_GET_VER_CMD, NULL, 0);
+  Frame[Frame_Length - 1U] ^= 0x01U;
+  Reply_Length = Test_Exchange(Frame, Frame_Length, &Status, Reply);
+  BL_TEST_CHECK(1U == Reply_Length);
+  BL_TEST_CHECK(CBL_SEND_NACK == Reply[0]);
+  Test_Expect_Synchronised();
+}
+
+static void Test_Short_Lengths(void)
+{
+  uint8_t   Frame[TEST_FRAME_MAX_LENGTH] = {0};
+  uint8_t   Reply[TEST_FRAME_MAX_LENGTH] = {0};
+  uint16_t  Reply_Length = 0;
+  uint8_t   Length       = 0;
+  BL_status Status       = BL_OK;
+  BL_Transport_Open();
+  /* Too short for a command and its CRC: NACKed, all of it taken */
+  for(Length=1U;Length<(1U + CRC_TYPE_SIZE);Length++){
+    memset(Frame, 0xEE, sizeof(Frame));
+    Frame[0] = Length;
+    Frame[1] = CBL_GET_VER_CMD;
+    Reply_Length = Test_Exchange(Frame, (uint16_t)(1U + Length), &Status, Reply);
+    BL_TEST_CHECK(BL_NACK == Status);
+    BL_TEST_CHECK(1U == Reply_Length);
+    BL_TEST_CHECK(CBL_SEND_NACK == Reply[0]);
+    Test_Expect_Synchronised();
+  }
+}
+
+static void Test_Truncated_Frame(void)
+{
+  uint8_t   Frame[TEST_FRAME_MAX_LENGTH] = {0};
+  uint8_t   Reply[TEST_FRAME_MAX_LENGTH] = {0};
+  uint16_t  Frame_Length = 0;
+  uint16_t  Reply_Length = 0;
+  BL_status Status       = BL_OK;
+  BL_Transport_Open();
+  Frame_Length = Test_Build_Frame(Frame, CBL_GET_VER_CMD, NULL, 0);
+  Reply_Length = Test_Exchange(Frame, (uint16_t)(Frame_Length - 2U), &Status, Reply);
+  BL_TEST_CHECK(BL_NACK == Status);
+  BL_TEST_CHECK(1U == Reply_Length);
+  BL_TEST_CHECK(CBL_SEND_NACK == Reply[0]);
+  Test_Expect_Synchronised();
+}
+
+static void Test_Empty_Frame(void)
+{
+  uint8_t   Frame[TEST_FRAME_MAX_LENGTH] = {0};
+  uint8_t   Reply[TEST_FRAME_MAX_LENGTH] = {0};
+  uint16_t  Reply_Length = 0;
+  BL_status Status       = BL_OK;
+  BL_Transport_Open();
+  /* The zero a host sends to resynchronise is not answered */
+  Reply_Length = Test_Exchange(Frame, 1U, &Status, Reply);
+  BL_TEST_CHECK(BL_NACK == Status);
+  BL_TEST_CHECK(0U == Reply_Length);
+  Test_Expect_Synchronised();
+}
+
+static void Test_Oversize_Frame(void)
+{
+  uint8_t   Frame[TEST_FRAME_MAX_LENGTH] = {0};
+  uint8_t   Reply[TEST_FRAME_MAX_LENGTH] = {0};
+  uint16_t  Reply_Length = 0;
+  BL_status Status       = BL_OK;
+  BL_Transport_Open();
+  /* Longer than the host buffer: drained, not answered */
+  memset(Frame, 0x05, sizeof(Frame));
+  Frame[0] = 0xFFU;
+  Reply_Length = Test_Exchange(Frame, 1U + 0xFFU, &Status, Reply);
+  BL_TEST_CHECK(BL_NACK == Status);
+  BL_TEST_CHECK(0U == Reply_Length);
+  Test_Expect_Synchronised();
+}
+
+static void Test_Back_To_Back(void)
+{
+  uint8_t   Frame[TEST_FRAME_MAX_LENGTH] = {0};
+  uint8_t   Reply[TEST_FRAME_MAX_LENGTH] = {0};
+  uint16_t  Frame_Length = 0;
+  uint16_t  Reply_Length = 0;
+  BL_status Status       = BL_NACK;
+  BL_Transport_Open();
+  /* Two frames in one go: each fetch takes exactly one */
+  Frame_Length = Test_Build_Frame(Frame, CBL_GET_VER_CMD, NULL, 0);
+  memcpy(&Frame[Frame_Length], Frame, Frame_Length);
+  Reply_Length = Test_Exchange(Frame, (uint16_t)(2U * Frame_Length), &Status, Reply);
+  BL_TEST_CHECK(BL_OK == Status);
+  BL_TEST_CHECK(TEST_VERSION_REPLY_LENGTH == Reply_Length);
+  Status       = BL_UART_FETCH_HOST_COMMAND();
+  Reply_Length = BL_Loopback_Collect(Reply, TEST_FRAME_MAX_LENGTH);
+  BL_TEST_CHECK(BL_OK == Status);
+  BL_TEST_CHECK(TEST_VERSION_REPLY_LENGTH == Reply_Length);
+  BL_TEST_CHECK(0 == memcmp(Reply, Test_Version_Reply, TEST_VERSION_REPLY_LENGTH));
+}
+
+static void Test_Held_Byte(void)
+{
+  uint8_t   Frame[TEST_FRAME_MAX_LENGTH] = {0};
+  uint16_t  Frame_Length = 0;
+  BL_Transport_Open();
+  /* The byte that ends the boot window is the first one of the frame */
+  BL_TEST_CHECK(HAL_TIMEOUT == BL_Transport_Wait(1U));
+  Frame_Length = Test_Build_Frame(Frame, CBL_GET_VER_CMD, NULL, 0);
+  BL_TEST_CHECK(1U == BL_Loopback_Inject(Frame, 1U));
+  BL_TEST_CHECK(HAL_OK == BL_Transport_Wait(1U));
+  BL_TEST_CHECK((uint16_t)(Frame_Length - 1U) == BL_Loopback_Inject(&Frame[1], (uint16_t)(Frame_Length - 1U)));
+  BL_TEST_CHECK(BL_OK == BL_UART_FETCH_HOST_COMMAND());
+  BL_TEST_CHECK(TEST_VERSION_REPLY_LENGTH == BL_Loopback_Collect(Frame, TEST_FRAME_MAX_LENGTH));
+  BL_TEST_CHECK(0 == memcmp(Frame, Test_Version_Reply, TEST_VERSION_REPLY_LENGTH));
+}
+
+static void Test_Batch(void)
+{
+  uint8_t   Frame[TEST_FRAME_MAX_LENGTH] = {0};
+  uint8_t   Reply[TEST_FRAME_MAX_LENGTH] = {0};
+  uint8_t   Commands[2] = { CBL_GET_VER_CMD, CBL_GET_VER_CMD };
+  uint8_t   Too_Many[BL_BATCH_MAX_COMMANDS + 1] = {0};
+  uint16_t  Frame_Length = 0;
+  uint16_t  Reply_Length = 0;
+  BL_status Status       = BL_NACK;
+  BL_Transport_Open();
+  /* No command after CBL_BATCH_CMD: an ACK for zero bytes */
+  Frame_Length = Test_Build_Frame(Frame, CBL_BATCH_CMD, NULL, 0);
+  Reply_Length = Test_Exchange(Frame, Frame_Length, &Status, Reply);
+  BL_TEST_CHECK(BL_OK == Status);
+  BL_TEST_CHECK(2U == Reply_Length);
+  BL_TEST_CHECK((CBL_SEND_ACK == Reply[0]) && (0U == Reply[1]));
+  Test_Expect_Synchronised();
+  /* [command][length][reply] per entry */
+  Frame_Length = Test_Build_Frame(Frame, CBL_BATCH_CMD, Commands, sizeof(Commands));
+  Reply_Length = Test_Exchange(Frame, Frame_Length, &Status, Reply);
+  BL_TEST_CHECK(BL_OK == Status);
+  BL_TEST_CHECK((2U + 2U * (BL_BATCH_ENTRY_HEADER_SIZE + 4U)) == Reply_Length);
+  BL_TEST_CHECK((CBL_SEND_ACK == Reply[0]) && ((2U * (BL_BATCH_ENTRY_HEADER_SIZE + 4U)) == Reply[1]));
+  BL_TEST_CHECK((CBL_GET_VER_CMD == Reply[2]) && (4U == Reply[3]));
+  BL_TEST_CHECK(0 == memcmp(&Reply[4], &Test_Version_Reply[2], 4U));
+  BL_TEST_CHECK((CBL_GET_VER_CMD == Reply[8]) && (4U == Reply[9]));
+  BL_TEST_CHECK(0 == memcmp(&Reply[10], &Test_Version_Reply[2], 4U));
+  Test_Expect_Synchronised();
+  /* One command more than fits: a NACK, not the first BL_BATCH_MAX_COMMANDS answers */
+  memset(Too_Many, CBL_GET_VER_CMD, sizeof(Too_Many));
+  Frame_Length = Test_Build_Frame(Frame, CBL_BATCH_CMD, Too_Many, sizeof(Too_Many));
+  Reply_Length = Test_Exchange(Frame, Frame_Length, &Status, Reply);
+  BL_TEST_CHECK(1U == Reply_Length);
+  BL_TEST_CHECK(CBL_SEND_NACK == Reply[0]);
+  Test_Expect_Synchronised();
+}
+
+int main(void)
+{
+  BL_TEST_RUN(Test_Good_Frame);
+  BL_TEST_RUN(Test_Bad_CRC);
+  BL_TEST_RUN(Test_Short_Lengths);
+  BL_TEST_RUN(Test_Truncated_Frame);
+  BL_TEST_RUN(Test_Empty_Frame);
+  BL_TEST_RUN(Test_Oversize_Frame);
+  BL_TEST_RUN(Test_Back_To_Back);
+  BL_TEST_RUN(Test_Held_Byte);
+  BL_TEST_RUN(Test_Batch);
+  printf("%u checks, %u failed\n", (unsigned)BL_Test_Checks, (unsigned)BL_Test_Failures);
+  return (0U == BL_Test_Failures) ? 0 : 1;
+}
+
+/*------------------ SW INTERFACES DEFINITIONS END -----------------*/
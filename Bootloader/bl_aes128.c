@@ -0,0 +1,212 @@
+/**
+ ******************************************************************************
+ * @file           : bl_aes128.c
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "bl_aes128.h"
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+#define BL_AES128_ROTR(x, n)         (((x) >> (n)) | ((x) << (32U - (n))))
+
+/* One output column of a full round. The other three T-tables are rotations
+ * of the first, the M3 does the rotation inside the EOR for free, so one
+ * 1 KB table serves all four lookups. */
+#define BL_AES128_COLUMN(a, b, c, d, k) \
+	(BL_AES128_TE0[(a) >> 24] ^ \
+	 BL_AES128_ROTR(BL_AES128_TE0[((b) >> 16) & 0xFFU], 8U) ^ \
+	 BL_AES128_ROTR(BL_AES128_TE0[((c) >> 8) & 0xFFU], 16U) ^ \
+	 BL_AES128_ROTR(BL_AES128_TE0[(d) & 0xFFU], 24U) ^ (k))
+
+/* The last round has no MixColumns, only SubBytes and ShiftRows */
+#define BL_AES128_LAST_COLUMN(a, b, c, d, k) \
+	(((uint32_t)BL_AES128_SBOX[(a) >> 24] << 24) ^ \
+	 ((uint32_t)BL_AES128_SBOX[((b) >> 16) & 0xFFU] << 16) ^ \
+	 ((uint32_t)BL_AES128_SBOX[((c) >> 8) & 0xFFU] << 8) ^ \
+	 ((uint32_t)BL_AES128_SBOX[(d) & 0xFFU]) ^ (k))
+
+/* Big endian word from any address: one unaligned LDR and a REV on the M3 */
+#define BL_AES128_LOAD_BE(p)         __REV(__UNALIGNED_UINT32_READ(p))
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+/* ------------------------------GLOBAL VAR DECLERATIONS----------------------------*/
+/* const, so the tables stay in flash and cost no RAM. Entry x holds the
+ * MixColumns column of S[x]: 2S, S, S, 3S from the top byte down. */
+static const uint32_t BL_AES128_TE0[256] = {
+	0xC66363A5U, 0xF87C7C84U, 0xEE777799U, 0xF67B7B8DU, 0xFFF2F20DU, 0xD66B6BBDU, 0xDE6F6FB1U, 0x91C5C554U,
+	0x60303050U, 0x02010103U, 0xCE6767A9U, 0x562B2B7DU, 0xE7FEFE19U, 0xB5D7D762U, 0x4DABABE6U, 0xEC76769AU,
+	0x8FCACA45U, 0x1F82829DU, 0x89C9C940U, 0xFA7D7D87U, 0xEFFAFA15U, 0xB25959EBU, 0x8E4747C9U, 0xFBF0F00BU,
+	0x41ADADECU, 0xB3D4D467U, 0x5FA2A2FDU, 0x45AFAFEAU, 0x239C9CBFU, 0x53A4A4F7U, 0xE4727296U, 0x9BC0C05BU,
+	0x75B7B7C2U, 0xE1FDFD1CU, 0x3D9393AEU, 0x4C26266AU, 0x6C36365AU, 0x7E3F3F41U, 0xF5F7F702U, 0x83CCCC4FU,
+	0x6834345CU, 0x51A5A5F4U, 0xD1E5E534U, 0xF9F1F108U, 0xE2717193U, 0xABD8D873U, 0x62313153U, 0x2A15153FU,
+	0x0804040CU, 0x95C7C752U, 0x46232365U, 0x9DC3C35EU, 0x30181828U, 0x379696A1U, 0x0A05050FU, 0x2F9A9AB5U,
+	0x0E070709U, 0x24121236U, 0x1B80809BU, 0xDFE2E23DU, 0xCDEBEB26U, 0x4E272769U, 0x7FB2B2CDU, 0xEA75759FU,
+	0x1209091BU, 0x1D83839EU, 0x582C2C74U, 0x341A1A2EU, 0x361B1B2DU, 0xDC6E6EB2U, 0xB45A5AEEU, 0x5BA0A0FBU,
+	0xA45252F6U, 0x763B3B4DU, 0xB7D6D661U, 0x7DB3B3CEU, 0x5229297BU, 0xDDE3E33EU, 0x5E2F2F71U, 0x13848497U,
+	0xA65353F5U, 0xB9D1D168U, 0x00000000U, 0xC1EDED2CU, 0x40202060U, 0xE3FCFC1FU, 0x79B1B1C8U, 0xB65B5BEDU,
+	0xD46A6ABEU, 0x8DCBCB46U, 0x67BEBED9U, 0x7239394BU, 0x944A4ADEU, 0x984C4CD4U, 0xB05858E8U, 0x85CFCF4AU,
+	0xBBD0D06BU, 0xC5EFEF2AU, 0x4FAAAAE5U, 0xEDFBFB16U, 0x864343C5U, 0x9A4D4DD7U, 0x66333355U, 0x11858594U,
+	0x8A4545CFU, 0xE9F9F910U, 0x04020206U, 0xFE7F7F81U, 0xA05050F0U, 0x783C3C44U, 0x259F9FBAU, 0x4BA8A8E3U,
+	0xA25151F3U, 0x5DA3A3FEU, 0x804040C0U, 0x058F8F8AU, 0x3F9292ADU, 0x219D9DBCU, 0x70383848U, 0xF1F5F504U,
+	0x63BCBCDFU, 0x77B6B6C1U, 0xAFDADA75U, 0x42212163U, 0x20101030U, 0xE5FFFF1AU, 0xFDF3F30EU, 0xBFD2D26DU,
+	0x81CDCD4CU, 0x180C0C14U, 0x26131335U, 0xC3ECEC2FU, 0xBE5F5FE1U, 0x359797A2U, 0x884444CCU, 0x2E171739U,
+	0x93C4C457U, 0x55A7A7F2U, 0xFC7E7E82U, 0x7A3D3D47U, 0xC86464ACU, 0xBA5D5DE7U, 0x3219192BU, 0xE6737395U,
+	0xC06060A0U, 0x19818198U, 0x9E4F4FD1U, 0xA3DCDC7FU, 0x44222266U, 0x542A2A7EU, 0x3B9090ABU, 0x0B888883U,
+	0x8C4646CAU, 0xC7EEEE29U, 0x6BB8B8D3U, 0x2814143CU, 0xA7DEDE79U, 0xBC5E5EE2U, 0x160B0B1DU, 0xADDBDB76U,
+	0xDBE0E03BU, 0x64323256U, 0x743A3A4EU, 0x140A0A1EU, 0x924949DBU, 0x0C06060AU, 0x4824246CU, 0xB85C5CE4U,
+	0x9FC2C25DU, 0xBDD3D36EU, 0x43ACACEFU, 0xC46262A6U, 0x399191A8U, 0x319595A4U, 0xD3E4E437U, 0xF279798BU,
+	0xD5E7E732U, 0x8BC8C843U, 0x6E373759U, 0xDA6D6DB7U, 0x018D8D8CU, 0xB1D5D564U, 0x9C4E4ED2U, 0x49A9A9E0U,
+	0xD86C6CB4U, 0xAC5656FAU, 0xF3F4F407U, 0xCFEAEA25U, 0xCA6565AFU, 0xF47A7A8EU, 0x47AEAEE9U, 0x10080818U,
+	0x6FBABAD5U, 0xF0787888U, 0x4A25256FU, 0x5C2E2E72U, 0x381C1C24U, 0x57A6A6F1U, 0x73B4B4C7U, 0x97C6C651U,
+	0xCBE8E823U, 0xA1DDDD7CU, 0xE874749CU, 0x3E1F1F21U, 0x964B4BDDU, 0x61BDBDDCU, 0x0D8B8B86U, 0x0F8A8A85U,
+	0xE0707090U, 0x7C3E3E42U, 0x71B5B5C4U, 0xCC6666AAU, 0x904848D8U, 0x06030305U, 0xF7F6F601U, 0x1C0E0E12U,
+	0xC26161A3U, 0x6A35355FU, 0xAE5757F9U, 0x69B9B9D0U, 0x17868691U, 0x99C1C158U, 0x3A1D1D27U, 0x279E9EB9U,
+	0xD9E1E138U, 0xEBF8F813U, 0x2B9898B3U, 0x22111133U, 0xD26969BBU, 0xA9D9D970U, 0x078E8E89U, 0x339494A7U,
+	0x2D9B9BB6U, 0x3C1E1E22U, 0x15878792U, 0xC9E9E920U, 0x87CECE49U, 0xAA5555FFU, 0x50282878U, 0xA5DFDF7AU,
+	0x038C8C8FU, 0x59A1A1F8U, 0x09898980U, 0x1A0D0D17U, 0x65BFBFDAU, 0xD7E6E631U, 0x844242C6U, 0xD06868B8U,
+	0x824141C3U, 0x299999B0U, 0x5A2D2D77U, 0x1E0F0F11U, 0x7BB0B0CBU, 0xA85454FCU, 0x6DBBBBD6U, 0x2C16163AU
+};
+
+static const uint8_t BL_AES128_SBOX[256] = {
+	0x63U, 0x7CU, 0x77U, 0x7BU, 0xF2U, 0x6BU, 0x6FU, 0xC5U, 0x30U, 0x01U, 0x67U, 0x2BU, 0xFEU, 0xD7U, 0xABU, 0x76U,
+	0xCAU, 0x82U, 0xC9U, 0x7DU, 0xFAU, 0x59U, 0x47U, 0xF0U, 0xADU, 0xD4U, 0xA2U, 0xAFU, 0x9CU, 0xA4U, 0x72U, 0xC0U,
+	0xB7U, 0xFDU, 0x93U, 0x26U, 0x36U, 0x3FU, 0xF7U, 0xCCU, 0x34U, 0xA5U, 0xE5U, 0xF1U, 0x71U, 0xD8U, 0x31U, 0x15U,
+	0x04U, 0xC7U, 0x23U, 0xC3U, 0x18U, 0x96U, 0x05U, 0x9AU, 0x07U, 0x12U, 0x80U, 0xE2U, 0xEBU, 0x27U, 0xB2U, 0x75U,
+	0x09U, 0x83U, 0x2CU, 0x1AU, 0x1BU, 0x6EU, 0x5AU, 0xA0U, 0x52U, 0x3BU, 0xD6U, 0xB3U, 0x29U, 0xE3U, 0x2FU, 0x84U,
+	0x53U, 0xD1U, 0x00U, 0xEDU, 0x20U, 0xFCU, 0xB1U, 0x5BU, 0x6AU, 0xCBU, 0xBEU, 0x39U, 0x4AU, 0x4CU, 0x58U, 0xCFU,
+	0xD0U, 0xEFU, 0xAAU, 0xFBU, 0x43U, 0x4DU, 0x33U, 0x85U, 0x45U, 0xF9U, 0x02U, 0x7FU, 0x50U, 0x3CU, 0x9FU, 0xA8U,
+	0x51U, 0xA3U, 0x40U, 0x8FU, 0x92U, 0x9DU, 0x38U, 0xF5U, 0xBCU, 0xB6U, 0xDAU, 0x21U, 0x10U, 0xFFU, 0xF3U, 0xD2U,
+	0xCDU, 0x0CU, 0x13U, 0xECU, 0x5FU, 0x97U, 0x44U, 0x17U, 0xC4U, 0xA7U, 0x7EU, 0x3DU, 0x64U, 0x5DU, 0x19U, 0x73U,
+	0x60U, 0x81U, 0x4FU, 0xDCU, 0x22U, 0x2AU, 0x90U, 0x88U, 0x46U, 0xEEU, 0xB8U, 0x14U, 0xDEU, 0x5EU, 0x0BU, 0xDBU,
+	0xE0U, 0x32U, 0x3AU, 0x0AU, 0x49U, 0x06U, 0x24U, 0x5CU, 0xC2U, 0xD3U, 0xACU, 0x62U, 0x91U, 0x95U, 0xE4U, 0x79U,
+	0xE7U, 0xC8U, 0x37U, 0x6DU, 0x8DU, 0xD5U, 0x4EU, 0xA9U, 0x6CU, 0x56U, 0xF4U, 0xEAU, 0x65U, 0x7AU, 0xAEU, 0x08U,
+	0xBAU, 0x78U, 0x25U, 0x2EU, 0x1CU, 0xA6U, 0xB4U, 0xC6U, 0xE8U, 0xDDU, 0x74U, 0x1FU, 0x4BU, 0xBDU, 0x8BU, 0x8AU,
+	0x70U, 0x3EU, 0xB5U, 0x66U, 0x48U, 0x03U, 0xF6U, 0x0EU, 0x61U, 0x35U, 0x57U, 0xB9U, 0x86U, 0xC1U, 0x1DU, 0x9EU,
+	0xE1U, 0xF8U, 0x98U, 0x11U, 0x69U, 0xD9U, 0x8EU, 0x94U, 0x9BU, 0x1EU, 0x87U, 0xE9U, 0xCEU, 0x55U, 0x28U, 0xDFU,
+	0x8CU, 0xA1U, 0x89U, 0x0DU, 0xBFU, 0xE6U, 0x42U, 0x68U, 0x41U, 0x99U, 0x2DU, 0x0FU, 0xB0U, 0x54U, 0xBBU, 0x16U
+};
+
+static const uint8_t BL_AES128_RCON[BL_AES128_ROUNDS] = {
+	0x01U, 0x02U, 0x04U, 0x08U, 0x10U, 0x20U, 0x40U, 0x80U, 0x1BU, 0x36U
+};
+
+/* ------------------------------GLOBAL VAR DECLERATIONS END----------------------------*/
+
+/*------------------ Static Functions Declarations -----------------*/
+/**
+ * @brief Encrypts one block held as four big endian words.
+ *
+ * @param pRound_Key The expanded key.
+ * @param Input      The plain block.
+ * @param Output     The cipher block, may be Input.
+ */
+static void BL_AES128_Encrypt_Block(const uint32_t *pRound_Key, const uint32_t Input[4], uint32_t Output[4]);
+
+/*------------------ Static Functions Declarations END -----------------*/
+
+
+/*------------------ Functions Definitions -----------------*/
+void BL_AES128_Init(BL_AES128_Context_t *pContext, const uint8_t Key[BL_AES128_KEY_SIZE]){
+	uint32_t *pRound_Key = pContext->Round_Key;
+	uint32_t Word = 0;
+	uint8_t Round = 0;
+
+	pRound_Key[0] = BL_AES128_LOAD_BE(&Key[0]);
+	pRound_Key[1] = BL_AES128_LOAD_BE(&Key[4]);
+	pRound_Key[2] = BL_AES128_LOAD_BE(&Key[8]);
+	pRound_Key[3] = BL_AES128_LOAD_BE(&Key[12]);
+	for(Round = 0; Round < BL_AES128_ROUNDS; Round++){
+		Word = pRound_Key[3];
+		/* SubWord(RotWord(w)) ^ Rcon */
+		pRound_Key[4] = pRound_Key[0] ^
+		                ((uint32_t)BL_AES128_SBOX[(Word >> 16) & 0xFFU] << 24) ^
+		                ((uint32_t)BL_AES128_SBOX[(Word >> 8) & 0xFFU] << 16) ^
+		                ((uint32_t)BL_AES128_SBOX[Word & 0xFFU] << 8) ^
+		                ((uint32_t)BL_AES128_SBOX[Word >> 24]) ^
+		                ((uint32_t)BL_AES128_RCON[Round] << 24);
+		pRound_Key[5] = pRound_Key[1] ^ pRound_Key[4];
+		pRound_Key[6] = pRound_Key[2] ^ pRound_Key[5];
+		pRound_Key[7] = pRound_Key[3] ^ pRound_Key[6];
+		pRound_Key += 4;
+	}
+}
+
+void BL_AES128_CTR_Xor(const BL_AES128_Context_t *pContext, const uint8_t Nonce[BL_AES128_NONCE_SIZE],
+                       uint8_t *pData, uint32_t Length){
+	uint8_t Counter_Block[BL_AES128_BLOCK_SIZE] = {0};
+
+	memcpy(Counter_Block, Nonce, BL_AES128_NONCE_SIZE);
+	BL_AES128_CTR_Xor_Counter(pContext, Counter_Block, pData, Length);
+}
+
+void BL_AES128_CTR_Xor_Counter(const BL_AES128_Context_t *pContext, const uint8_t Counter_Block[BL_AES128_BLOCK_SIZE],
+                               uint8_t *pData, uint32_t Length){
+	uint32_t Counter[4];
+	uint32_t Key_Stream[4];
+	uint8_t Byte_Index = 0;
+
+	Counter[0] = BL_AES128_LOAD_BE(&Counter_Block[0]);
+	Counter[1] = BL_AES128_LOAD_BE(&Counter_Block[4]);
+	Counter[2] = BL_AES128_LOAD_BE(&Counter_Block[8]);
+	Counter[3] = BL_AES128_LOAD_BE(&Counter_Block[12]);
+	while(Length > 0U){
+		BL_AES128_Encrypt_Block(pContext->Round_Key, Counter, Key_Stream);
+		Counter[3]++;
+		if(0U == Counter[3]){
+			Counter[2]++;
+		}
+		else {/*Nothing to be done */}
+
+		if(Length >= BL_AES128_BLOCK_SIZE){
+			/* Whole blocks a word at a time, the payload sits unaligned in the frame */
+			__UNALIGNED_UINT32_WRITE(&pData[0], __UNALIGNED_UINT32_READ(&pData[0]) ^ __REV(Key_Stream[0]));
+			__UNALIGNED_UINT32_WRITE(&pData[4], __UNALIGNED_UINT32_READ(&pData[4]) ^ __REV(Key_Stream[1]));
+			__UNALIGNED_UINT32_WRITE(&pData[8], __UNALIGNED_UINT32_READ(&pData[8]) ^ __REV(Key_Stream[2]));
+			__UNALIGNED_UINT32_WRITE(&pData[12], __UNALIGNED_UINT32_READ(&pData[12]) ^ __REV(Key_Stream[3]));
+			pData += BL_AES128_BLOCK_SIZE;
+			Length -= BL_AES128_BLOCK_SIZE;
+		}
+		else {
+			for(Byte_Index = 0; Byte_Index < Length; Byte_Index++){
+				pData[Byte_Index] ^= (uint8_t)(Key_Stream[Byte_Index >> 2] >> (24U - (8U * (Byte_Index & 3U))));
+			}
+			Length = 0;
+		}
+	}
+}
+
+/*------------------ Functions Definitions END -----------------*/
+
+
+/*------------------ Static Functions Definitions -----------------*/
+static void BL_AES128_Encrypt_Block(const uint32_t *pRound_Key, const uint32_t Input[4], uint32_t Output[4]){
+	uint32_t s0 = Input[0] ^ pRound_Key[0];
+	uint32_t s1 = Input[1] ^ pRound_Key[1];
+	uint32_t s2 = Input[2] ^ pRound_Key[2];
+	uint32_t s3 = Input[3] ^ pRound_Key[3];
+	uint32_t t0, t1, t2, t3;
+	uint8_t Round = 0;
+
+	for(Round = 1; Round < BL_AES128_ROUNDS; Round++){
+		pRound_Key += 4;
+		t0 = BL_AES128_COLUMN(s0, s1, s2, s3, pRound_Key[0]);
+		t1 = BL_AES128_COLUMN(s1, s2, s3, s0, pRound_Key[1]);
+		t2 = BL_AES128_COLUMN(s2, s3, s0, s1, pRound_Key[2]);
+		t3 = BL_AES128_COLUMN(s3, s0, s1, s2, pRound_Key[3]);
+		s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+	}
+	pRound_Key += 4;
+	Output[0] = BL_AES128_LAST_COLUMN(s0, s1, s2, s3, pRound_Key[0]);
+	Output[1] = BL_AES128_LAST_COLUMN(s1, s2, s3, s0, pRound_Key[1]);
+	Output[2] = BL_AES128_LAST_COLUMN(s2, s3, s0, s1, pRound_Key[2]);
+	Output[3] = BL_AES128_LAST_COLUMN(s3, s0, s1, s2, pRound_Key[3]);
+}
+
+/*------------------ Static Functions Definitions END -----------------*/
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * @file           : bl_aes128.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_AES128_H
+#define BL_AES128_H
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "main.h"
+#include <string.h>
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+#define BL_AES128_BLOCK_SIZE         16U
+#define BL_AES128_KEY_SIZE           16U
+#define BL_AES128_ROUNDS             10U
+/* CTR: the counter block is the nonce followed by a 64 bit big endian block
+ * counter that starts at 0, as in NIST SP 800-38A. */
+#define BL_AES128_NONCE_SIZE         8U
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+
+/*------------------ DATA TYPES DECLARATIONS ---------------------*/
+/* The expanded key, big endian words. Built once, the cipher only reads it. */
+typedef struct{
+	uint32_t Round_Key[4U * (BL_AES128_ROUNDS + 1U)];
+}BL_AES128_Context_t;
+
+/*------------------ DATA TYPES DECLARATIONS END ---------------------*/
+
+
+
+/*------------------ SW INTERFACES DECLARATIONS ---------------------*/
+/**
+ * @brief Expands the key.
+ *
+ * @param pContext The context to fill.
+ * @param Key      The 16 byte key.
+ */
+void BL_AES128_Init(BL_AES128_Context_t *pContext, const uint8_t Key[BL_AES128_KEY_SIZE]);
+
+/**
+ * @brief Encrypts or decrypts in place in CTR mode, both are the same XOR with
+ *        the key stream. Every call starts at block counter 0.
+ *
+ * @param pContext The expanded key.
+ * @param Nonce    The 8 byte nonce of the message.
+ * @param pData    The bytes, any alignment.
+ * @param Length   Number of bytes.
+ */
+void BL_AES128_CTR_Xor(const BL_AES128_Context_t *pContext, const uint8_t Nonce[BL_AES128_NONCE_SIZE],
+                       uint8_t *pData, uint32_t Length);
+
+/**
+ * @brief The same as BL_AES128_CTR_Xor from a given counter block. The low 64
+ *        bits count up, big endian, the high 64 bits stay as they are.
+ *
+ * @param pContext      The expanded key.
+ * @param Counter_Block The counter block of the first 16 bytes of pData.
+ * @param pData         The bytes, any alignment.
+ * @param Length        Number of bytes.
+ */
+void BL_AES128_CTR_Xor_Counter(const BL_AES128_Context_t *pContext, const uint8_t Counter_Block[BL_AES128_BLOCK_SIZE],
+                               uint8_t *pData, uint32_t Length);
+
+/*------------------ SW INTERFACES DECLARATIONS END -----------------*/
+
+
+#endif
@@ -0,0 +1,24 @@
+/**
+ ******************************************************************************
+ * @file           : bl_aes_key.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_AES_KEY_H
+#define BL_AES_KEY_H
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+/* Key the images are encrypted with. Paste the line Host.py keygen --aes
+ * prints. The key sits in the bootloader flash, set read protection level 1
+ * on production boards so it cannot be read back over SWD. The zero key is a
+ * placeholder, a bootloader built with it fails every encrypted write. */
+#define BL_AES_KEY { \
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00  \
+}
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+#endif
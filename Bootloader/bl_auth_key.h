@@ -0,0 +1,26 @@
+/**
+ ******************************************************************************
+ * @file           : bl_auth_key.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_AUTH_KEY_H
+#define BL_AUTH_KEY_H
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+/* Public key the images are signed with, X || Y big endian. Paste the lines
+ * Host.py keygen prints. The zero key is not on the curve, a bootloader built
+ * with it refuses every image. */
+#define BL_AUTH_PUBLIC_KEY { \
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00  \
+}
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+#endif
@@ -0,0 +1,502 @@
+/**
+ ******************************************************************************
+ * @file           : bl_ecdsa_p256.c
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "bl_ecdsa_p256.h"
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+/* 256 bit numbers are 8 words, least significant word first */
+#define BL_P256_WORDS                8U
+
+#define BL_P256_ADD_DONE             0x00
+#define BL_P256_ADD_DOUBLE           0x01
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+/*------------------ DATA TYPES DECLARATIONS ---------------------*/
+/* A modulus with what Montgomery multiplication needs: R = 2^256, One is R mod
+ * M and M0_Inverse is -1/M mod 2^32. */
+typedef struct{
+	uint32_t Modulus[BL_P256_WORDS];
+	uint32_t R2[BL_P256_WORDS];
+	uint32_t One[BL_P256_WORDS];
+	uint32_t M0_Inverse;
+}BL_P256_Field_t;
+
+/* Jacobian coordinates in Montgomery form: x = X / Z^2, y = Y / Z^3, Z = 0 is
+ * the point at infinity. */
+typedef struct{
+	uint32_t X[BL_P256_WORDS];
+	uint32_t Y[BL_P256_WORDS];
+	uint32_t Z[BL_P256_WORDS];
+}BL_P256_Point_t;
+
+/*------------------ DATA TYPES DECLARATIONS END ---------------------*/
+
+/* ------------------------------GLOBAL VAR DECLERATIONS----------------------------*/
+/* The curve constants are const tables in flash, the ones used in point
+ * arithmetic already in Montgomery form. */
+static const BL_P256_Field_t BL_P256_Prime = {
+	{0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000001U, 0xFFFFFFFFU},
+	{0x00000003U, 0x00000000U, 0xFFFFFFFFU, 0xFFFFFFFBU, 0xFFFFFFFEU, 0xFFFFFFFFU, 0xFFFFFFFDU, 0x00000004U},
+	{0x00000001U, 0x00000000U, 0x00000000U, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFEU, 0x00000000U},
+	0x00000001U
+};
+
+static const BL_P256_Field_t BL_P256_Order = {
+	{0xFC632551U, 0xF3B9CAC2U, 0xA7179E84U, 0xBCE6FAADU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0x00000000U, 0xFFFFFFFFU},
+	{0xBE79EEA2U, 0x83244C95U, 0x49BD6FA6U, 0x4699799CU, 0x2B6BEC59U, 0x2845B239U, 0xF3D95620U, 0x66E12D94U},
+	{0x039CDAAFU, 0x0C46353DU, 0x58E8617BU, 0x43190552U, 0x00000000U, 0x00000000U, 0xFFFFFFFFU, 0x00000000U},
+	0xEE00BC4FU
+};
+
+static const uint32_t BL_P256_B[BL_P256_WORDS] = {
+	0x29C4BDDFU, 0xD89CDF62U, 0x78843090U, 0xACF005CDU, 0xF7212ED6U, 0xE5A220ABU, 0x04874834U, 0xDC30061DU
+};
+
+static const uint32_t BL_P256_Gx[BL_P256_WORDS] = {
+	0x18A9143CU, 0x79E730D4U, 0x5FEDB601U, 0x75BA95FCU, 0x77622510U, 0x79FB732BU, 0xA53755C6U, 0x18905F76U
+};
+
+static const uint32_t BL_P256_Gy[BL_P256_WORDS] = {
+	0xCE95560AU, 0xDDF25357U, 0xBA19E45CU, 0x8B4AB8E4U, 0xDD21F325U, 0xD2E88688U, 0x25885D85U, 0x8571FF18U
+};
+
+static const uint32_t BL_P256_Plain_One[BL_P256_WORDS] = {1U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
+
+/* The points live here and not on the stack, the bootloader has 1 KB of it:
+ * G, Q and G + Q for the double scalar multiplication, and the sum. */
+static BL_P256_Point_t BL_P256_Table[3];
+static BL_P256_Point_t BL_P256_Sum;
+
+/* ------------------------------GLOBAL VAR DECLERATIONS END----------------------------*/
+
+/*------------------ Static Functions Declarations -----------------*/
+/**
+ * @brief Reads a big endian 32 byte number.
+ */
+static void BL_P256_From_Bytes(uint32_t *pNumber, const uint8_t *pBytes);
+
+/**
+ * @brief pResult = pA + pB.
+ *
+ * @return The carry out.
+ */
+static uint32_t BL_P256_Add(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB);
+
+/**
+ * @brief pResult = pA - pB.
+ *
+ * @return 1 when it borrowed, pA was below pB.
+ */
+static uint32_t BL_P256_Sub(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB);
+
+/**
+ * @return 1 when pA < pB.
+ */
+static uint8_t BL_P256_Is_Below(const uint32_t *pA, const uint32_t *pB);
+
+/**
+ * @return 1 when the number is 0.
+ */
+static uint8_t BL_P256_Is_Zero(const uint32_t *pA);
+
+/**
+ * @brief Addition and subtraction modulo the field modulus, inputs already reduced.
+ */
+static void BL_P256_Mod_Add(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB, const BL_P256_Field_t *pField);
+static void BL_P256_Mod_Sub(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB, const BL_P256_Field_t *pField);
+
+/**
+ * @brief Montgomery product pA * pB / R mod M, word by word (CIOS) so the
+ *        inner loops compile to UMLAL. pA may be any 256 bit number, pB must be
+ *        below M, the result is fully reduced.
+ */
+static void BL_P256_Mont_Mul(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB, const BL_P256_Field_t *pField);
+
+/**
+ * @brief Inverse in Montgomery form by Fermat, pA^(M-2). pA must not be 0.
+ */
+static void BL_P256_Mont_Inverse(uint32_t *pResult, const uint32_t *pA, const BL_P256_Field_t *pField);
+
+/**
+ * @brief pResult = 2 * pPoint with the a = -3 formulas. The two may be the same point.
+ */
+static void BL_P256_Point_Double(BL_P256_Point_t *pResult, const BL_P256_Point_t *pPoint);
+
+/**
+ * @brief pResult = pP + pQ, pResult may be pP or pQ.
+ *
+ * @return BL_P256_ADD_DONE, or BL_P256_ADD_DOUBLE when pP and pQ are the same
+ *         point, pResult is untouched then and the caller doubles instead.
+ */
+static uint8_t BL_P256_Point_Add(BL_P256_Point_t *pResult, const BL_P256_Point_t *pP, const BL_P256_Point_t *pQ);
+
+/*------------------ Static Functions Declarations END -----------------*/
+
+
+/*------------------ Functions Definitions -----------------*/
+uint8_t BL_ECDSA_P256_Verify(const uint8_t Public_Key[BL_ECDSA_P256_KEY_SIZE],
+                             const uint8_t Hash[BL_ECDSA_P256_SCALAR_SIZE],
+                             const uint8_t Signature[BL_ECDSA_P256_SIGNATURE_SIZE]){
+	uint32_t Left[BL_P256_WORDS];
+	uint32_t Right[BL_P256_WORDS];
+	uint32_t r[BL_P256_WORDS];
+	uint32_t u1[BL_P256_WORDS];
+	uint32_t u2[BL_P256_WORDS];
+	uint8_t Bit_Index = 0;
+	uint8_t Table_Index = 0;
+	BL_P256_Point_t *pG = &BL_P256_Table[0];
+	BL_P256_Point_t *pQ = &BL_P256_Table[1];
+
+	/* The key: both coordinates below p and on y^2 = x^3 - 3x + b */
+	BL_P256_From_Bytes(Left, &Public_Key[0]);
+	BL_P256_From_Bytes(Right, &Public_Key[BL_ECDSA_P256_SCALAR_SIZE]);
+	if((0U == BL_P256_Is_Below(Left, BL_P256_Prime.Modulus)) || (0U == BL_P256_Is_Below(Right, BL_P256_Prime.Modulus))){
+		return BL_ECDSA_P256_INVALID;
+	}
+	else {/*Nothing to be done */}
+	BL_P256_Mont_Mul(pQ->X, Left, BL_P256_Prime.R2, &BL_P256_Prime);
+	BL_P256_Mont_Mul(pQ->Y, Right, BL_P256_Prime.R2, &BL_P256_Prime);
+	memcpy(pQ->Z, BL_P256_Prime.One, sizeof(pQ->Z));
+
+	BL_P256_Mont_Mul(Left, pQ->Y, pQ->Y, &BL_P256_Prime);
+	BL_P256_Mont_Mul(Right, pQ->X, pQ->X, &BL_P256_Prime);
+	BL_P256_Mont_Mul(Right, Right, pQ->X, &BL_P256_Prime);
+	BL_P256_Mod_Sub(Right, Right, pQ->X, &BL_P256_Prime);
+	BL_P256_Mod_Sub(Right, Right, pQ->X, &BL_P256_Prime);
+	BL_P256_Mod_Sub(Right, Right, pQ->X, &BL_P256_Prime);
+	BL_P256_Mod_Add(Right, Right, BL_P256_B, &BL_P256_Prime);
+	if(0 != memcmp(Left, Right, sizeof(Left))){
+		return BL_ECDSA_P256_INVALID;
+	}
+	else {/*Nothing to be done */}
+
+	/* r and s in [1, n-1] */
+	BL_P256_From_Bytes(r, &Signature[0]);
+	BL_P256_From_Bytes(Left, &Signature[BL_ECDSA_P256_SCALAR_SIZE]);
+	if((1U == BL_P256_Is_Zero(r)) || (0U == BL_P256_Is_Below(r, BL_P256_Order.Modulus)) ||
+	   (1U == BL_P256_Is_Zero(Left)) || (0U == BL_P256_Is_Below(Left, BL_P256_Order.Modulus))){
+		return BL_ECDSA_P256_INVALID;
+	}
+	else {/*Nothing to be done */}
+
+	/* w = 1/s in Montgomery form, then u1 = e * w and u2 = r * w: a Montgomery
+	 * product of a plain and a Montgomery number is plain again. The digest is
+	 * as wide as n, it needs no cutting, and the product reduces it. */
+	BL_P256_Mont_Mul(Right, Left, BL_P256_Order.R2, &BL_P256_Order);
+	BL_P256_Mont_Inverse(Right, Right, &BL_P256_Order);
+	BL_P256_From_Bytes(Left, Hash);
+	BL_P256_Mont_Mul(u1, Left, Right, &BL_P256_Order);
+	BL_P256_Mont_Mul(u2, r, Right, &BL_P256_Order);
+
+	/* u1 * G + u2 * Q in one pass over the bits (Shamir's trick) */
+	memcpy(pG->X, BL_P256_Gx, sizeof(pG->X));
+	memcpy(pG->Y, BL_P256_Gy, sizeof(pG->Y));
+	memcpy(pG->Z, BL_P256_Prime.One, sizeof(pG->Z));
+	if(BL_P256_ADD_DOUBLE == BL_P256_Point_Add(&BL_P256_Table[2], pG, pQ)){
+		BL_P256_Point_Double(&BL_P256_Table[2], pG);
+	}
+	else {/*Nothing to be done */}
+
+	memset(&BL_P256_Sum, 0, sizeof(BL_P256_Sum));
+	Bit_Index = 255U;
+	do{
+		BL_P256_Point_Double(&BL_P256_Sum, &BL_P256_Sum);
+		Table_Index = (uint8_t)(((u1[Bit_Index >> 5] >> (Bit_Index & 31U)) & 1U) |
+		                        (((u2[Bit_Index >> 5] >> (Bit_Index & 31U)) & 1U) << 1));
+		if(Table_Index > 0U){
+			if(BL_P256_ADD_DOUBLE == BL_P256_Point_Add(&BL_P256_Sum, &BL_P256_Sum, &BL_P256_Table[Table_Index - 1U])){
+				BL_P256_Point_Double(&BL_P256_Sum, &BL_P256_Sum);
+			}
+			else {/*Nothing to be done */}
+		}
+		else {/*Nothing to be done */}
+	}while(Bit_Index-- > 0U);
+
+	if(1U == BL_P256_Is_Zero(BL_P256_Sum.Z)){
+		return BL_ECDSA_P256_INVALID;
+	}
+	else {/*Nothing to be done */}
+
+	/* x = X / Z^2 out of Montgomery form, then reduced mod n and compared with r */
+	BL_P256_Mont_Inverse(Left, BL_P256_Sum.Z, &BL_P256_Prime);
+	BL_P256_Mont_Mul(Right, Left, Left, &BL_P256_Prime);
+	BL_P256_Mont_Mul(Right, Right, BL_P256_Sum.X, &BL_P256_Prime);
+	BL_P256_Mont_Mul(Left, BL_P256_Plain_One, Right, &BL_P256_Prime);
+	if(0U == BL_P256_Is_Below(Left, BL_P256_Order.Modulus)){
+		(void)BL_P256_Sub(Left, Left, BL_P256_Order.Modulus);
+	}
+	else {/*Nothing to be done */}
+
+	return (0 == memcmp(Left, r, sizeof(r))) ? BL_ECDSA_P256_VALID : BL_ECDSA_P256_INVALID;
+}
+
+/*------------------ Functions Definitions END -----------------*/
+
+
+/*------------------ Static Functions Definitions -----------------*/
+static void BL_P256_From_Bytes(uint32_t *pNumber, const uint8_t *pBytes){
+	uint8_t Word_Index = 0;
+	for(Word_Index = 0; Word_Index < BL_P256_WORDS; Word_Index++){
+		const uint8_t *pWord = &pBytes[4U * (BL_P256_WORDS - 1U - Word_Index)];
+		pNumber[Word_Index] = ((uint32_t)pWord[0] << 24) | ((uint32_t)pWord[1] << 16) |
+		                      ((uint32_t)pWord[2] << 8) | (uint32_t)pWord[3];
+	}
+}
+
+static uint32_t BL_P256_Add(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB){
+	uint64_t Accumulator = 0;
+	uint8_t Word_Index = 0;
+	for(Word_Index = 0; Word_Index < BL_P256_WORDS; Word_Index++){
+		Accumulator += (uint64_t)pA[Word_Index] + pB[Word_Index];
+		pResult[Word_Index] = (uint32_t)Accumulator;
+		Accumulator >>= 32;
+	}
+	return (uint32_t)Accumulator;
+}
+
+static uint32_t BL_P256_Sub(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB){
+	uint64_t Accumulator = 0;
+	uint32_t Borrow = 0;
+	uint8_t Word_Index = 0;
+	for(Word_Index = 0; Word_Index < BL_P256_WORDS; Word_Index++){
+		Accumulator = (uint64_t)pA[Word_Index] - pB[Word_Index] - Borrow;
+		pResult[Word_Index] = (uint32_t)Accumulator;
+		Borrow = (uint32_t)(Accumulator >> 32) & 1U;
+	}
+	return Borrow;
+}
+
+static uint8_t BL_P256_Is_Below(const uint32_t *pA, const uint32_t *pB){
+	uint8_t Word_Index = BL_P256_WORDS;
+	while(Word_Index-- > 0U){
+		if(pA[Word_Index] != pB[Word_Index]){
+			return (pA[Word_Index] < pB[Word_Index]) ? 1U : 0U;
+		}
+		else {/*Nothing to be done */}
+	}
+	return 0U;
+}
+
+static uint8_t BL_P256_Is_Zero(const uint32_t *pA){
+	uint32_t Bits = 0;
+	uint8_t Word_Index = 0;
+	for(Word_Index = 0; Word_Index < BL_P256_WORDS; Word_Index++){
+		Bits |= pA[Word_Index];
+	}
+	return (0U == Bits) ? 1U : 0U;
+}
+
+static void BL_P256_Mod_Add(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB, const BL_P256_Field_t *pField){
+	if((0U != BL_P256_Add(pResult, pA, pB)) || (0U == BL_P256_Is_Below(pResult, pField->Modulus))){
+		(void)BL_P256_Sub(pResult, pResult, pField->Modulus);
+	}
+	else {/*Nothing to be done */}
+}
+
+static void BL_P256_Mod_Sub(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB, const BL_P256_Field_t *pField){
+	if(0U != BL_P256_Sub(pResult, pA, pB)){
+		(void)BL_P256_Add(pResult, pResult, pField->Modulus);
+	}
+	else {/*Nothing to be done */}
+}
+
+static void BL_P256_Mont_Mul(uint32_t *pResult, const uint32_t *pA, const uint32_t *pB, const BL_P256_Field_t *pField){
+	uint32_t T[BL_P256_WORDS + 2U] = {0};
+	uint64_t Accumulator = 0;
+	uint32_t m = 0;
+	uint8_t i = 0;
+	uint8_t j = 0;
+
+	for(i = 0; i < BL_P256_WORDS; i++){
+		/* T += A * B[i] */
+		Accumulator = 0;
+		for(j = 0; j < BL_P256_WORDS; j++){
+			Accumulator = ((uint64_t)pA[j] * pB[i]) + T[j] + (Accumulator >> 32);
+			T[j] = (uint32_t)Accumulator;
+		}
+		Accumulator = (uint64_t)T[BL_P256_WORDS] + (Accumulator >> 32);
+		T[BL_P256_WORDS] = (uint32_t)Accumulator;
+		T[BL_P256_WORDS + 1U] = (uint32_t)(Accumulator >> 32);
+
+		/* T = (T + m * M) / 2^32, m makes the low word 0 */
+		m = T[0] * pField->M0_Inverse;
+		Accumulator = ((uint64_t)m * pField->Modulus[0]) + T[0];
+		for(j = 1; j < BL_P256_WORDS; j++){
+			Accumulator = ((uint64_t)m * pField->Modulus[j]) + T[j] + (Accumulator >> 32);
+			T[j - 1U] = (uint32_t)Accumulator;
+		}
+		Accumulator = (uint64_t)T[BL_P256_WORDS] + (Accumulator >> 32);
+		T[BL_P256_WORDS - 1U] = (uint32_t)Accumulator;
+		T[BL_P256_WORDS] = T[BL_P256_WORDS + 1U] + (uint32_t)(Accumulator >> 32);
+	}
+
+	/* T < 2M here, one subtraction is enough */
+	if((0U != T[BL_P256_WORDS]) || (0U == BL_P256_Is_Below(T, pField->Modulus))){
+		(void)BL_P256_Sub(T, T, pField->Modulus);
+	}
+	else {/*Nothing to be done */}
+	memcpy(pResult, T, BL_P256_WORDS * sizeof(uint32_t));
+}
+
+static void BL_P256_Mont_Inverse(uint32_t *pResult, const uint32_t *pA, const BL_P256_Field_t *pField){
+	uint32_t Exponent[BL_P256_WORDS];
+	uint32_t Power[BL_P256_WORDS];
+	uint8_t Bit_Index = 255U;
+
+	/* The low word of p and of n is well above 2, M - 2 does not borrow */
+	memcpy(Exponent, pField->Modulus, sizeof(Exponent));
+	Exponent[0] -= 2U;
+	memcpy(Power, pField->One, sizeof(Power));
+	do{
+		BL_P256_Mont_Mul(Power, Power, Power, pField);
+		if(0U != ((Exponent[Bit_Index >> 5] >> (Bit_Index & 31U)) & 1U)){
+			BL_P256_Mont_Mul(Power, Power, pA, pField);
+		}
+		else {/*Nothing to be done */}
+	}while(Bit_Index-- > 0U);
+	memcpy(pResult, Power, sizeof(Power));
+}
+
+static void BL_P256_Point_Double(BL_P256_Point_t *pResult, const BL_P256_Point_t *pPoint){
+	const BL_P256_Field_t *pField = &BL_P256_Prime;
+	uint32_t Delta[BL_P256_WORDS];
+	uint32_t Gamma[BL_P256_WORDS];
+	uint32_t Beta[BL_P256_WORDS];
+	uint32_t Alpha[BL_P256_WORDS];
+	uint32_t Z3[BL_P256_WORDS];
+	uint32_t Temp[BL_P256_WORDS];
+
+	if(1U == BL_P256_Is_Zero(pPoint->Z)){
+		memset(pResult->Z, 0, sizeof(pResult->Z));
+		return;
+	}
+	else {/*Nothing to be done */}
+
+	BL_P256_Mont_Mul(Delta, pPoint->Z, pPoint->Z, pField);
+	BL_P256_Mont_Mul(Gamma, pPoint->Y, pPoint->Y, pField);
+	BL_P256_Mont_Mul(Beta, pPoint->X, Gamma, pField);
+
+	/* Z3 = (Y + Z)^2 - gamma - delta */
+	BL_P256_Mod_Add(Z3, pPoint->Y, pPoint->Z, pField);
+	BL_P256_Mont_Mul(Z3, Z3, Z3, pField);
+	BL_P256_Mod_Sub(Z3, Z3, Gamma, pField);
+	BL_P256_Mod_Sub(Z3, Z3, Delta, pField);
+
+	/* alpha = 3 (X - delta)(X + delta) */
+	BL_P256_Mod_Sub(Temp, pPoint->X, Delta, pField);
+	BL_P256_Mod_Add(Alpha, pPoint->X, Delta, pField);
+	BL_P256_Mont_Mul(Temp, Temp, Alpha, pField);
+	BL_P256_Mod_Add(Alpha, Temp, Temp, pField);
+	BL_P256_Mod_Add(Alpha, Alpha, Temp, pField);
+
+	/* X3 = alpha^2 - 8 beta, Beta holds 4 beta from here on */
+	BL_P256_Mod_Add(Beta, Beta, Beta, pField);
+	BL_P256_Mod_Add(Beta, Beta, Beta, pField);
+	BL_P256_Mont_Mul(Temp, Alpha, Alpha, pField);
+	BL_P256_Mod_Sub(Temp, Temp, Beta, pField);
+	BL_P256_Mod_Sub(pResult->X, Temp, Beta, pField);
+
+	/* Y3 = alpha (4 beta - X3) - 8 gamma^2 */
+	BL_P256_Mod_Sub(Beta, Beta, pResult->X, pField);
+	BL_P256_Mont_Mul(Beta, Alpha, Beta, pField);
+	BL_P256_Mont_Mul(Gamma, Gamma, Gamma, pField);
+	BL_P256_Mod_Add(Gamma, Gamma, Gamma, pField);
+	BL_P256_Mod_Add(Gamma, Gamma, Gamma, pField);
+	BL_P256_Mod_Add(Gamma, Gamma, Gamma, pField);
+	BL_P256_Mod_Sub(pResult->Y, Beta, Gamma, pField);
+	memcpy(pResult->Z, Z3, sizeof(Z3));
+}
+
+static uint8_t BL_P256_Point_Add(BL_P256_Point_t *pResult, const BL_P256_Point_t *pP, const BL_P256_Point_t *pQ){
+	const BL_P256_Field_t *pField = &BL_P256_Prime;
+	uint32_t Z1Z1[BL_P256_WORDS];
+	uint32_t Z2Z2[BL_P256_WORDS];
+	uint32_t U1[BL_P256_WORDS];
+	uint32_t H[BL_P256_WORDS];
+	uint32_t S1[BL_P256_WORDS];
+	uint32_t Rr[BL_P256_WORDS];
+	uint32_t Z3[BL_P256_WORDS];
+
+	if(1U == BL_P256_Is_Zero(pP->Z)){
+		if(pResult != pQ){
+			memcpy(pResult, pQ, sizeof(BL_P256_Point_t));
+		}
+		else {/*Nothing to be done */}
+		return BL_P256_ADD_DONE;
+	}
+	else if(1U == BL_P256_Is_Zero(pQ->Z)){
+		if(pResult != pP){
+			memcpy(pResult, pP, sizeof(BL_P256_Point_t));
+		}
+		else {/*Nothing to be done */}
+		return BL_P256_ADD_DONE;
+	}
+	else {/*Nothing to be done */}
+
+	/* U1 = X1 Z2^2, U2 = X2 Z1^2, S1 = Y1 Z2^3, S2 = Y2 Z1^3 */
+	BL_P256_Mont_Mul(Z1Z1, pP->Z, pP->Z, pField);
+	BL_P256_Mont_Mul(Z2Z2, pQ->Z, pQ->Z, pField);
+	BL_P256_Mont_Mul(U1, pP->X, Z2Z2, pField);
+	BL_P256_Mont_Mul(H, pQ->X, Z1Z1, pField);
+	BL_P256_Mont_Mul(S1, pP->Y, pQ->Z, pField);
+	BL_P256_Mont_Mul(S1, S1, Z2Z2, pField);
+	BL_P256_Mont_Mul(Rr, pQ->Y, pP->Z, pField);
+	BL_P256_Mont_Mul(Rr, Rr, Z1Z1, pField);
+
+	/* H = U2 - U1, r = S2 - S1 */
+	BL_P256_Mod_Sub(H, H, U1, pField);
+	BL_P256_Mod_Sub(Rr, Rr, S1, pField);
+	if(1U == BL_P256_Is_Zero(H)){
+		if(1U == BL_P256_Is_Zero(Rr)){
+			return BL_P256_ADD_DOUBLE;
+		}
+		else {
+			/* P = -Q */
+			memset(pResult->Z, 0, sizeof(pResult->Z));
+			return BL_P256_ADD_DONE;
+		}
+	}
+	else {/*Nothing to be done */}
+
+	/* Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) H */
+	BL_P256_Mod_Add(Z3, pP->Z, pQ->Z, pField);
+	BL_P256_Mont_Mul(Z3, Z3, Z3, pField);
+	BL_P256_Mod_Sub(Z3, Z3, Z1Z1, pField);
+	BL_P256_Mod_Sub(Z3, Z3, Z2Z2, pField);
+	BL_P256_Mont_Mul(Z3, Z3, H, pField);
+
+	/* I = (2H)^2 in Z1Z1, J = H I in Z2Z2, V = U1 I in U1, r doubled */
+	BL_P256_Mod_Add(Z1Z1, H, H, pField);
+	BL_P256_Mont_Mul(Z1Z1, Z1Z1, Z1Z1, pField);
+	BL_P256_Mont_Mul(Z2Z2, H, Z1Z1, pField);
+	BL_P256_Mont_Mul(U1, U1, Z1Z1, pField);
+	BL_P256_Mod_Add(Rr, Rr, Rr, pField);
+
+	/* X3 = r^2 - J - 2V */
+	BL_P256_Mont_Mul(H, Rr, Rr, pField);
+	BL_P256_Mod_Sub(H, H, Z2Z2, pField);
+	BL_P256_Mod_Sub(H, H, U1, pField);
+	BL_P256_Mod_Sub(H, H, U1, pField);
+
+	/* Y3 = r (V - X3) - 2 S1 J */
+	BL_P256_Mod_Sub(U1, U1, H, pField);
+	BL_P256_Mont_Mul(U1, Rr, U1, pField);
+	BL_P256_Mont_Mul(S1, S1, Z2Z2, pField);
+	BL_P256_Mod_Add(S1, S1, S1, pField);
+	BL_P256_Mod_Sub(pResult->Y, U1, S1, pField);
+	memcpy(pResult->X, H, sizeof(H));
+	memcpy(pResult->Z, Z3, sizeof(Z3));
+	return BL_P256_ADD_DONE;
+}
+
+/*------------------ Static Functions Definitions END -----------------*/
@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ * @file           : bl_ecdsa_p256.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_ECDSA_P256_H
+#define BL_ECDSA_P256_H
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "main.h"
+#include <string.h>
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+/* Numbers on the wire are big endian: a public key is X || Y, a signature r || s */
+#define BL_ECDSA_P256_SCALAR_SIZE    32U
+#define BL_ECDSA_P256_KEY_SIZE       64U
+#define BL_ECDSA_P256_SIGNATURE_SIZE 64U
+
+#define BL_ECDSA_P256_INVALID        0x00
+#define BL_ECDSA_P256_VALID          0x01
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+
+/*------------------ SW INTERFACES DECLARATIONS ---------------------*/
+/**
+ * @brief Checks an ECDSA signature on the NIST P-256 curve. Everything it works
+ *        on is public, so it is not written to run in constant time.
+ *
+ * @param Public_Key The signer's key, rejected when it is not on the curve.
+ * @param Hash       The SHA-256 digest of the message.
+ * @param Signature  r and s, both must be in [1, n-1].
+ *
+ * @return BL_ECDSA_P256_VALID or BL_ECDSA_P256_INVALID.
+ */
+uint8_t BL_ECDSA_P256_Verify(const uint8_t Public_Key[BL_ECDSA_P256_KEY_SIZE],
+                             const uint8_t Hash[BL_ECDSA_P256_SCALAR_SIZE],
+                             const uint8_t Signature[BL_ECDSA_P256_SIGNATURE_SIZE]);
+
+/*------------------ SW INTERFACES DECLARATIONS END -----------------*/
+
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file           : bl_mailbox.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_MAILBOX_H
+#define BL_MAILBOX_H
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "main.h"
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+/* The application asks for an update session through the last 32 bytes of
+ * SRAM. The C startup of neither side touches them and a reset keeps them, a
+ * power cycle leaves garbage that fails the check. The application:
+ *   1. fills Baud_Rate, Transport, Flags and Session_Key,
+ *   2. sets Magic to BL_MAILBOX_MAGIC and Check to BL_Mailbox_Check_Word,
+ *   3. calls NVIC_SystemReset.
+ * The bootloader takes the request before it waits for the first frame: it
+ * sets the link to Baud_Rate, loads the session key and clears the mailbox,
+ * so the next reset boots normally. A request for another transport than the
+ * one the bootloader is built for is dropped as a whole.
+ * Both linker setups have to keep the 32 bytes out of their RAM: the
+ * bootloader's IRAM1 ends at 0x20004FE0, the application's RAM and initial
+ * stack pointer have to end there as well. */
+#define BL_MAILBOX_ADDRESS           0x20004FE0U
+#define BL_MAILBOX_MAGIC             0xB00710ADU
+
+/* Transport: the BL_TRANSPORT_x value of bl_transport.h, or any */
+#define BL_MAILBOX_TRANSPORT_ANY     0xFFU
+
+/* Flags */
+#define BL_MAILBOX_FLAG_SESSION_KEY  0x01U  /* Session_Key replaces the BL_AES key until the next reset */
+
+#define BL_MAILBOX_KEY_SIZE          16U
+
+#define BL_MAILBOX                   ((volatile BL_Mailbox_t *)BL_MAILBOX_ADDRESS)
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+
+/*------------------ DATA TYPES DECLARATIONS ---------------------*/
+typedef struct{
+	uint32_t Magic;                                /* BL_MAILBOX_MAGIC while a request is pending */
+	uint32_t Baud_Rate;                            /* For BL_Transport_Set_Speed, 0 keeps the built in one */
+	uint8_t  Transport;                            /* BL_TRANSPORT_x or BL_MAILBOX_TRANSPORT_ANY */
+	uint8_t  Flags;                                /* BL_MAILBOX_FLAG_x */
+	uint16_t Reserved;                             /* 0 */
+	uint8_t  Session_Key[BL_MAILBOX_KEY_SIZE];
+	uint32_t Check;                                /* BL_Mailbox_Check_Word of the words before */
+}BL_Mailbox_t;
+
+/*------------------ DATA TYPES DECLARATIONS END ---------------------*/
+
+
+
+/*------------------ SW INTERFACES DECLARATIONS ---------------------*/
+/**
+ * @brief The check word: the inverted XOR of all words in front of Check. A
+ *        request torn by a reset, or the garbage after power up, fails it.
+ *        Inline, the application uses it without linking the bootloader.
+ *
+ * @param pMailbox The mailbox.
+ *
+ * @return The value Check has to hold.
+ */
+static inline uint32_t BL_Mailbox_Check_Word(const volatile BL_Mailbox_t *pMailbox){
+	const volatile uint32_t *pWord = (const volatile uint32_t *)pMailbox;
+	uint32_t Check = 0;
+	uint8_t  Word_Index = 0;
+	for(Word_Index = 0; Word_Index < ((sizeof(BL_Mailbox_t) / 4U) - 1U); Word_Index++){
+		Check ^= pWord[Word_Index];
+	}
+	return ~Check;
+}
+
+/**
+ * @brief Tells whether the mailbox holds a request.
+ *
+ * @return 1 for a valid request, 0 otherwise.
+ */
+static inline uint8_t BL_Mailbox_Is_Pending(void){
+	return ((BL_MAILBOX_MAGIC == BL_MAILBOX->Magic) && (BL_Mailbox_Check_Word(BL_MAILBOX) == BL_MAILBOX->Check)) ? 1U : 0U;
+}
+
+/*------------------ SW INTERFACES DECLARATIONS END -----------------*/
+
+
+#endif
@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ * @file           : bl_sha256.c
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "bl_sha256.h"
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+#define BL_SHA256_ROTR(x, n)         (((x) >> (n)) | ((x) << (32U - (n))))
+
+#define BL_SHA256_CH(x, y, z)        ((z) ^ ((x) & ((y) ^ (z))))
+#define BL_SHA256_MAJ(x, y, z)       (((x) & (y)) | ((z) & ((x) | (y))))
+#define BL_SHA256_SUM0(x)            (BL_SHA256_ROTR((x), 2U) ^ BL_SHA256_ROTR((x), 13U) ^ BL_SHA256_ROTR((x), 22U))
+#define BL_SHA256_SUM1(x)            (BL_SHA256_ROTR((x), 6U) ^ BL_SHA256_ROTR((x), 11U) ^ BL_SHA256_ROTR((x), 25U))
+#define BL_SHA256_SIGMA0(x)          (BL_SHA256_ROTR((x), 7U) ^ BL_SHA256_ROTR((x), 18U) ^ ((x) >> 3U))
+#define BL_SHA256_SIGMA1(x)          (BL_SHA256_ROTR((x), 17U) ^ BL_SHA256_ROTR((x), 19U) ^ ((x) >> 10U))
+
+/* The message schedule is a ring of 16 words, word i of the 64 lives in W[i & 15] */
+#define BL_SHA256_EXPAND(W, i)       ((W)[(i) & 15U] += BL_SHA256_SIGMA1((W)[((i) - 2U) & 15U]) + \
+                                                        (W)[((i) - 7U) & 15U] + \
+                                                        BL_SHA256_SIGMA0((W)[((i) - 15U) & 15U]))
+
+/* One round. Instead of shifting a..h down by one every round the callers
+ * rotate the names, so a round writes only d and h. */
+#define BL_SHA256_ROUND(a, b, c, d, e, f, g, h, Wi, Ki) do{ \
+	uint32_t T1 = (h) + BL_SHA256_SUM1(e) + BL_SHA256_CH((e), (f), (g)) + (Ki) + (Wi); \
+	(d) += T1; \
+	(h) = T1 + BL_SHA256_SUM0(a) + BL_SHA256_MAJ((a), (b), (c)); \
+}while(0)
+
+/* Eight rounds bring the names back to where they started */
+#define BL_SHA256_EIGHT_ROUNDS(W, i, Next) do{ \
+	BL_SHA256_ROUND(a, b, c, d, e, f, g, h, Next(W, (i) + 0U), BL_SHA256_K[(i) + 0U]); \
+	BL_SHA256_ROUND(h, a, b, c, d, e, f, g, Next(W, (i) + 1U), BL_SHA256_K[(i) + 1U]); \
+	BL_SHA256_ROUND(g, h, a, b, c, d, e, f, Next(W, (i) + 2U), BL_SHA256_K[(i) + 2U]); \
+	BL_SHA256_ROUND(f, g, h, a, b, c, d, e, Next(W, (i) + 3U), BL_SHA256_K[(i) + 3U]); \
+	BL_SHA256_ROUND(e, f, g, h, a, b, c, d, Next(W, (i) + 4U), BL_SHA256_K[(i) + 4U]); \
+	BL_SHA256_ROUND(d, e, f, g, h, a, b, c, Next(W, (i) + 5U), BL_SHA256_K[(i) + 5U]); \
+	BL_SHA256_ROUND(c, d, e, f, g, h, a, b, Next(W, (i) + 6U), BL_SHA256_K[(i) + 6U]); \
+	BL_SHA256_ROUND(b, c, d, e, f, g, h, a, Next(W, (i) + 7U), BL_SHA256_K[(i) + 7U]); \
+}while(0)
+
+#define BL_SHA256_LOADED(W, i)       ((W)[(i) & 15U])
+
+/* Big endian word from any address: one unaligned LDR and a REV on the M3 */
+#define BL_SHA256_LOAD_BE(p)         __REV(__UNALIGNED_UINT32_READ(p))
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+/* ------------------------------GLOBAL VAR DECLERATIONS----------------------------*/
+/* const, so the table stays in flash and costs no RAM */
+static const uint32_t BL_SHA256_K[64] = {
+	0x428A2F98U, 0x71374491U, 0xB5C0FBCFU, 0xE9B5DBA5U, 0x3956C25BU, 0x59F111F1U, 0x923F82A4U, 0xAB1C5ED5U,
+	0xD807AA98U, 0x12835B01U, 0x243185BEU, 0x550C7DC3U, 0x72BE5D74U, 0x80DEB1FEU, 0x9BDC06A7U, 0xC19BF174U,
+	0xE49B69C1U, 0xEFBE4786U, 0x0FC19DC6U, 0x240CA1CCU, 0x2DE92C6FU, 0x4A7484AAU, 0x5CB0A9DCU, 0x76F988DAU,
+	0x983E5152U, 0xA831C66DU, 0xB00327C8U, 0xBF597FC7U, 0xC6E00BF3U, 0xD5A79147U, 0x06CA6351U, 0x14292967U,
+	0x27B70A85U, 0x2E1B2138U, 0x4D2C6DFCU, 0x53380D13U, 0x650A7354U, 0x766A0ABBU, 0x81C2C92EU, 0x92722C85U,
+	0xA2BFE8A1U, 0xA81A664BU, 0xC24B8B70U, 0xC76C51A3U, 0xD192E819U, 0xD6990624U, 0xF40E3585U, 0x106AA070U,
+	0x19A4C116U, 0x1E376C08U, 0x2748774CU, 0x34B0BCB5U, 0x391C0CB3U, 0x4ED8AA4AU, 0x5B9CCA4FU, 0x682E6FF3U,
+	0x748F82EEU, 0x78A5636FU, 0x84C87814U, 0x8CC70208U, 0x90BEFFFAU, 0xA4506CEBU, 0xBEF9A3F7U, 0xC67178F2U
+};
+
+static const uint32_t BL_SHA256_Initial_State[8] = {
+	0x6A09E667U, 0xBB67AE85U, 0x3C6EF372U, 0xA54FF53AU, 0x510E527FU, 0x9B05688CU, 0x1F83D9ABU, 0x5BE0CD19U
+};
+
+/* ------------------------------GLOBAL VAR DECLERATIONS END----------------------------*/
+
+/*------------------ Static Functions Declarations -----------------*/
+/**
+ * @brief Runs the compression function over whole blocks.
+ *
+ * @param State   The chaining value.
+ * @param pData   The blocks, any alignment.
+ * @param Blocks  Number of 64 byte blocks.
+ */
+static void BL_SHA256_Compress(uint32_t State[8], const uint8_t *pData, uint32_t Blocks);
+
+/*------------------ Static Functions Declarations END -----------------*/
+
+
+/*------------------ Functions Definitions -----------------*/
+void BL_SHA256_Init(BL_SHA256_Context_t *pContext){
+	memcpy(pContext->State, BL_SHA256_Initial_State, sizeof(pContext->State));
+	pContext->Total_Length = 0;
+	pContext->Block_Length = 0;
+}
+
+void BL_SHA256_Update(BL_SHA256_Context_t *pContext, const uint8_t *pData, uint32_t Length){
+	uint32_t Copy_Length = 0;
+
+	pContext->Total_Length += Length;
+
+	/* Top up a partial block first */
+	if(pContext->Block_Length > 0U){
+		Copy_Length = BL_SHA256_BLOCK_SIZE - pContext->Block_Length;
+		if(Copy_Length > Length){
+			Copy_Length = Length;
+		}
+		else {/*Nothing to be done */}
+		memcpy(&pContext->Block[pContext->Block_Length], pData, Copy_Length);
+		pContext->Block_Length += Copy_Length;
+		pData += Copy_Length;
+		Length -= Copy_Length;
+		if(BL_SHA256_BLOCK_SIZE == pContext->Block_Length){
+			BL_SHA256_Compress(pContext->State, pContext->Block, 1U);
+			pContext->Block_Length = 0;
+		}
+		else {/*Nothing to be done */}
+	}
+	else {/*Nothing to be done */}
+
+	/* Whole blocks straight from the caller's memory */
+	if(Length >= BL_SHA256_BLOCK_SIZE){
+		BL_SHA256_Compress(pContext->State, pData, Length / BL_SHA256_BLOCK_SIZE);
+		pData += Length & ~(BL_SHA256_BLOCK_SIZE - 1U);
+		Length &= (BL_SHA256_BLOCK_SIZE - 1U);
+	}
+	else {/*Nothing to be done */}
+
+	if(Length > 0U){
+		memcpy(&pContext->Block[pContext->Block_Length], pData, Length);
+		pContext->Block_Length += Length;
+	}
+	else {/*Nothing to be done */}
+}
+
+void BL_SHA256_Final(BL_SHA256_Context_t *pContext, uint8_t Digest[BL_SHA256_DIGEST_SIZE]){
+	uint32_t Bit_Length_High = pContext->Total_Length >> 29;
+	uint32_t Bit_Length_Low = pContext->Total_Length << 3;
+	uint8_t Word_Index = 0;
+
+	pContext->Block[pContext->Block_Length++] = 0x80;
+	if(pContext->Block_Length > (BL_SHA256_BLOCK_SIZE - 8U)){
+		memset(&pContext->Block[pContext->Block_Length], 0, BL_SHA256_BLOCK_SIZE - pContext->Block_Length);
+		BL_SHA256_Compress(pContext->State, pContext->Block, 1U);
+		pContext->Block_Length = 0;
+	}
+	else {/*Nothing to be done */}
+	memset(&pContext->Block[pContext->Block_Length], 0, (BL_SHA256_BLOCK_SIZE - 8U) - pContext->Block_Length);
+
+	pContext->Block[56] = (uint8_t)(Bit_Length_High >> 24);
+	pContext->Block[57] = (uint8_t)(Bit_Length_High >> 16);
+	pContext->Block[58] = (uint8_t)(Bit_Length_High >> 8);
+	pContext->Block[59] = (uint8_t)(Bit_Length_High);
+	pContext->Block[60] = (uint8_t)(Bit_Length_Low >> 24);
+	pContext->Block[61] = (uint8_t)(Bit_Length_Low >> 16);
+	pContext->Block[62] = (uint8_t)(Bit_Length_Low >> 8);
+	pContext->Block[63] = (uint8_t)(Bit_Length_Low);
+	BL_SHA256_Compress(pContext->State, pContext->Block, 1U);
+
+	for(Word_Index = 0; Word_Index < 8U; Word_Index++){
+		Digest[(4U * Word_Index) + 0U] = (uint8_t)(pContext->State[Word_Index] >> 24);
+		Digest[(4U * Word_Index) + 1U] = (uint8_t)(pContext->State[Word_Index] >> 16);
+		Digest[(4U * Word_Index) + 2U] = (uint8_t)(pContext->State[Word_Index] >> 8);
+		Digest[(4U * Word_Index) + 3U] = (uint8_t)(pContext->State[Word_Index]);
+	}
+}
+
+/*------------------ Functions Definitions END -----------------*/
+
+
+/*------------------ Static Functions Definitions -----------------*/
+static void BL_SHA256_Compress(uint32_t State[8], const uint8_t *pData, uint32_t Blocks){
+	uint32_t W[16];
+	uint32_t a, b, c, d, e, f, g, h;
+	uint32_t Round = 0;
+	uint8_t Word_Index = 0;
+
+	while(Blocks-- > 0U){
+		for(Word_Index = 0; Word_Index < 16U; Word_Index++){
+			W[Word_Index] = BL_SHA256_LOAD_BE(pData + (4U * Word_Index));
+		}
+
+		a = State[0]; b = State[1]; c = State[2]; d = State[3];
+		e = State[4]; f = State[5]; g = State[6]; h = State[7];
+
+		for(Round = 0; Round < 16U; Round += 8U){
+			BL_SHA256_EIGHT_ROUNDS(W, Round, BL_SHA256_LOADED);
+		}
+		for(; Round < 64U; Round += 8U){
+			BL_SHA256_EIGHT_ROUNDS(W, Round, BL_SHA256_EXPAND);
+		}
+
+		State[0] += a; State[1] += b; State[2] += c; State[3] += d;
+		State[4] += e; State[5] += f; State[6] += g; State[7] += h;
+		pData += BL_SHA256_BLOCK_SIZE;
+	}
+}
+
+/*------------------ Static Functions Definitions END -----------------*/
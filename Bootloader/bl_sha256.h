@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ * @file           : bl_sha256.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_SHA256_H
+#define BL_SHA256_H
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "main.h"
+#include <string.h>
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+#define BL_SHA256_BLOCK_SIZE         64U
+#define BL_SHA256_DIGEST_SIZE        32U
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+
+/*------------------ DATA TYPES DECLARATIONS ---------------------*/
+/* The hash is fed in pieces of any size, a partial block waits in Block until
+ * the next BL_SHA256_Update fills it. */
+typedef struct{
+	uint32_t State[8];
+	uint32_t Total_Length;
+	uint32_t Block_Length;
+	uint8_t Block[BL_SHA256_BLOCK_SIZE];
+}BL_SHA256_Context_t;
+
+/*------------------ DATA TYPES DECLARATIONS END ---------------------*/
+
+
+
+/*------------------ SW INTERFACES DECLARATIONS ---------------------*/
+/**
+ * @brief Starts a new hash.
+ */
+void BL_SHA256_Init(BL_SHA256_Context_t *pContext);
+
+/**
+ * @brief Hashes the next bytes of the message. Whole blocks are taken straight
+ *        from pData, flash included, only the ends are copied.
+ *
+ * @param pContext The hash started by BL_SHA256_Init.
+ * @param pData    The bytes, any alignment.
+ * @param Length   Number of bytes.
+ */
+void BL_SHA256_Update(BL_SHA256_Context_t *pContext, const uint8_t *pData, uint32_t Length);
+
+/**
+ * @brief Pads the message and gives the digest. The context must be started
+ *        again before it is used for another message.
+ *
+ * @param pContext The hash.
+ * @param Digest   The 32 byte digest, big endian as in FIPS 180-4.
+ */
+void BL_SHA256_Final(BL_SHA256_Context_t *pContext, uint8_t Digest[BL_SHA256_DIGEST_SIZE]);
+
+/*------------------ SW INTERFACES DECLARATIONS END -----------------*/
+
+
+#endif
@@ -0,0 +1,519 @@
+/**
+ ******************************************************************************
+ * @file           : bl_transport.c
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "bl_transport.h"
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+/* ------------------------------GLOBAL VAR DECLERATIONS----------------------------*/
+#if (BL_TRANSPORT == BL_TRANSPORT_SPI)
+#ifndef HAL_SPI_MODULE_ENABLED
+#error "BL_TRANSPORT_SPI needs SPI1 enabled in Simple_BL_M3.ioc"
+#endif
+extern SPI_HandleTypeDef hspi1;
+
+#elif (BL_TRANSPORT == BL_TRANSPORT_CAN)
+#ifndef HAL_CAN_MODULE_ENABLED
+#error "BL_TRANSPORT_CAN needs CAN enabled in Simple_BL_M3.ioc"
+#endif
+extern CAN_HandleTypeDef hcan;
+
+/* Bytes of the last data frame that are not taken yet */
+static uint8_t BL_CAN_Rx_Data[8];
+static uint8_t BL_CAN_Rx_Count = 0;
+static uint8_t BL_CAN_Rx_Index = 0;
+
+#elif (BL_TRANSPORT == BL_TRANSPORT_USB_CDC)
+#ifndef HAL_PCD_MODULE_ENABLED
+#error "BL_TRANSPORT_USB_CDC needs USB enabled in Simple_BL_M3.ioc"
+#endif
+extern PCD_HandleTypeDef hpcd_USB_FS;
+
+#elif ((BL_TRANSPORT == BL_TRANSPORT_UART) && (BL_UART_RX_DMA == BL_UART_RX_DMA_ENABLE))
+#ifndef HAL_DMA_MODULE_ENABLED
+#error "BL_UART_RX_DMA_ENABLE needs HAL_DMA_MODULE_ENABLED in stm32f1xx_hal_conf.h"
+#endif
+/* Written by the DMA, the write index is the channel counter, see BL_UART_Rx_Written */
+static uint8_t BL_UART_Rx_Ring[BL_UART_RX_BUFFER_SIZE];
+/* Bytes taken from the ring since BL_UART_Rx_Start, the tail is this count modulo the ring size */
+static uint32_t BL_UART_Rx_Read = 0;
+/* Half rings the DMA has filled since BL_UART_Rx_Start, counted by the HT and TC events */
+static volatile uint32_t BL_UART_Rx_Halves = 0;
+static DMA_HandleTypeDef BL_UART_Rx_DMA;
+
+#elif (BL_TRANSPORT == BL_TRANSPORT_LOOPBACK)
+static uint8_t BL_Loopback_Rx[BL_LOOPBACK_BUFFER_SIZE];
+static uint16_t BL_Loopback_Rx_Head = 0;
+static uint16_t BL_Loopback_Rx_Tail = 0;
+static uint8_t BL_Loopback_Tx[BL_LOOPBACK_BUFFER_SIZE];
+static uint16_t BL_Loopback_Tx_Count = 0;
+#endif
+
+static uint8_t BL_Transport_Quiet = BL_TRANSPORT_TALK;
+/* Byte taken by BL_Transport_Wait, it starts the next frame */
+static uint8_t BL_Transport_Held_Byte = 0;
+static uint8_t BL_Transport_Byte_Held = 0;
+
+/* ------------------------------GLOBAL VAR DECLERATIONS END----------------------------*/
+
+/*------------------ Static Functions Declarations -----------------*/
+/**
+ * @brief Receives bytes on the selected transport.
+ *
+ * @param pBuffer Where the bytes go.
+ * @param Length  Number of bytes.
+ * @param Timeout Longest wait in ms for the whole call.
+ *
+ * @return HAL_OK, or HAL_TIMEOUT when the bytes did not come in time.
+ */
+static HAL_StatusTypeDef BL_Transport_Receive(uint8_t *pBuffer, uint16_t Length, uint32_t Timeout);
+
+/**
+ * @brief Receives the body of a frame with BL_INTER_BYTE_TIMEOUT_MS between two bytes.
+ *
+ * @param pBuffer     Where the body goes, right after the length byte.
+ * @param Data_length Number of bytes announced by the length byte.
+ *
+ * @return HAL_OK, or HAL_TIMEOUT when the bytes stopped.
+ */
+static HAL_StatusTypeDef BL_Transport_Receive_Body(uint8_t *pBuffer, uint16_t Data_length);
+
+#if ((BL_TRANSPORT == BL_TRANSPORT_UART) && (BL_UART_RX_DMA == BL_UART_RX_DMA_ENABLE))
+/**
+ * @brief (Re)starts the circular DMA reception into an empty ring.
+ */
+static void BL_UART_Rx_Start(void);
+
+/**
+ * @brief Bytes the DMA has written since BL_UART_Rx_Start, laps included.
+ */
+static uint32_t BL_UART_Rx_Written(void);
+
+/**
+ * @brief Sleeps until an interrupt when the ring is empty. Without a timeout
+ *        SysTick is stopped too, then only the UART or the DMA wakes the core.
+ *
+ * @param Timeout The timeout of the receive, HAL_MAX_DELAY for none.
+ */
+static void BL_UART_Rx_Sleep(uint32_t Timeout);
+#endif
+
+/*------------------ Static Functions Declarations END -----------------*/
+
+
+/*------------------ Functions Definitions -----------------*/
+void BL_Transport_Open(void){
+#if (BL_TRANSPORT == BL_TRANSPORT_CAN)
+	CAN_FilterTypeDef CAN_Filter = {0};
+	/* Only the host ID gets into FIFO 0 */
+	CAN_Filter.FilterBank = 0;
+	CAN_Filter.FilterMode = CAN_FILTERMODE_IDMASK;
+	CAN_Filter.FilterScale = CAN_FILTERSCALE_32BIT;
+	CAN_Filter.FilterIdHigh = (uint16_t)(BL_CAN_HOST_ID << 5);
+	CAN_Filter.FilterIdLow = 0;
+	CAN_Filter.FilterMaskIdHigh = (uint16_t)(0x7FFU << 5);
+	CAN_Filter.FilterMaskIdLow = 0;
+	CAN_Filter.FilterFIFOAssignment = CAN_RX_FIFO0;
+	CAN_Filter.FilterActivation = ENABLE;
+	CAN_Filter.SlaveStartFilterBank = 14;
+	HAL_CAN_ConfigFilter(BL_HOST_COMMUNICATION_CAN, &CAN_Filter);
+	HAL_CAN_Start(BL_HOST_COMMUNICATION_CAN);
+	BL_CAN_Rx_Count = 0;
+	BL_CAN_Rx_Index = 0;
+#elif (BL_TRANSPORT == BL_TRANSPORT_USB_CDC)
+	BL_USB_CDC_Open(BL_HOST_COMMUNICATION_USB);
+#elif (BL_TRANSPORT == BL_TRANSPORT_LOOPBACK)
+	BL_Loopback_Rx_Head = 0;
+	BL_Loopback_Rx_Tail = 0;
+	BL_Loopback_Tx_Count = 0;
+#elif (BL_TRANSPORT == BL_TRANSPORT_UART)
+#if (BL_RS485_DE == BL_RS485_DE_ENABLE)
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	/* Receive until there is something to send */
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	HAL_GPIO_WritePin(BL_RS485_DE_PORT, BL_RS485_DE_PIN, GPIO_PIN_RESET);
+	GPIO_InitStruct.Pin = BL_RS485_DE_PIN;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_Init(BL_RS485_DE_PORT, &GPIO_InitStruct);
+#endif
+#if (BL_UART_RX_DMA == BL_UART_RX_DMA_ENABLE)
+	/* The channel is not in Simple_BL_M3.ioc, it is set up here like the DE pin */
+	__HAL_RCC_DMA1_CLK_ENABLE();
+	BL_UART_Rx_DMA.Instance = BL_UART_RX_DMA_CHANNEL;
+	BL_UART_Rx_DMA.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	BL_UART_Rx_DMA.Init.PeriphInc = DMA_PINC_DISABLE;
+	BL_UART_Rx_DMA.Init.MemInc = DMA_MINC_ENABLE;
+	BL_UART_Rx_DMA.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	BL_UART_Rx_DMA.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	BL_UART_Rx_DMA.Init.Mode = DMA_CIRCULAR;
+	BL_UART_Rx_DMA.Init.Priority = DMA_PRIORITY_HIGH;
+	HAL_DMA_Init(&BL_UART_Rx_DMA);
+	__HAL_LINKDMA(BL_HOST_COMMUNICATION_UART, hdmarx, BL_UART_Rx_DMA);
+	HAL_NVIC_SetPriority(BL_UART_RX_DMA_IRQ, 0, 0);
+	HAL_NVIC_EnableIRQ(BL_UART_RX_DMA_IRQ);
+	HAL_NVIC_SetPriority(BL_UART_IRQ, 0, 0);
+	HAL_NVIC_EnableIRQ(BL_UART_IRQ);
+	BL_UART_Rx_Start();
+#endif
+#else
+	/* SPI is ready once MX_ has set it up */
+#endif
+	BL_Transport_Quiet = BL_TRANSPORT_TALK;
+}
+
+void BL_Transport_Close(void){
+#if (BL_TRANSPORT == BL_TRANSPORT_CAN)
+	HAL_CAN_Stop(BL_HOST_COMMUNICATION_CAN);
+#elif (BL_TRANSPORT == BL_TRANSPORT_USB_CDC)
+	HAL_PCD_Stop(BL_HOST_COMMUNICATION_USB);
+#elif ((BL_TRANSPORT == BL_TRANSPORT_UART) && (BL_UART_RX_DMA == BL_UART_RX_DMA_ENABLE))
+	/* Also called before BL_Transport_Open when the watchdog reset starts the application */
+	if(HAL_DMA_STATE_RESET != BL_UART_Rx_DMA.State){
+		HAL_NVIC_DisableIRQ(BL_UART_IRQ);
+		HAL_NVIC_DisableIRQ(BL_UART_RX_DMA_IRQ);
+		HAL_UART_AbortReceive(BL_HOST_COMMUNICATION_UART);
+		HAL_DMA_DeInit(&BL_UART_Rx_DMA);
+	}
+	else {/*Nothing to be done */}
+#else
+	/* The polled transports leave nothing running */
+#endif
+}
+
+HAL_StatusTypeDef BL_Transport_Receive_Frame(uint8_t *pBuffer, uint16_t Buffer_Length){
+	HAL_StatusTypeDef HAL_STATUS = HAL_ERROR;
+	uint16_t Data_length = 0;
+	uint8_t Dropped_Byte = 0;
+	if(0U != BL_Transport_Byte_Held){
+		pBuffer[0] = BL_Transport_Held_Byte;
+		BL_Transport_Byte_Held = 0;
+		HAL_STATUS = HAL_OK;
+	}
+	else {
+		HAL_STATUS = BL_Transport_Receive(pBuffer, 1, HAL_MAX_DELAY);
+	}
+	if(HAL_OK == HAL_STATUS){
+		Data_length = pBuffer[0];
+		if(0U == Data_length){
+			/* Empty frame, e.g. the zero bytes a host sends to resynchronise */
+			HAL_STATUS = HAL_ERROR;
+		}
+		else if(Data_length < BL_FRAME_MIN_LENGTH){
+			/* No room for a command and its CRC: take its bytes and have it NACKed like a frame that lost some */
+			HAL_STATUS = BL_Transport_Receive_Body(&pBuffer[1], Data_length);
+			if(HAL_OK == HAL_STATUS){
+				HAL_STATUS = HAL_TIMEOUT;
+			}
+			else {/*Nothing to be done */}
+		}
+		else if(Data_length < Buffer_Length){
+			HAL_STATUS = BL_Transport_Receive_Body(&pBuffer[1], Data_length);
+		}
+		else {
+			/* Too long for the buffer: take the whole frame so that its bytes do not start a new one */
+			HAL_STATUS = BL_Transport_Receive_Body(&pBuffer[1], Buffer_Length - 1U);
+			for(Data_length -= (Buffer_Length - 1U);(Data_length > 0U) && (HAL_OK == HAL_STATUS);Data_length--){
+				HAL_STATUS = BL_Transport_Receive_Body(&Dropped_Byte, 1);
+			}
+			if(HAL_OK == HAL_STATUS){
+				HAL_STATUS = HAL_ERROR;
+			}
+			else {/*Nothing to be done */}
+		}
+	}
+	else {/*Nothing to be done */}
+	return HAL_STATUS;
+}
+
+HAL_StatusTypeDef BL_Transport_Wait(uint32_t Timeout){
+	HAL_StatusTypeDef HAL_STATUS = HAL_OK;
+	if(0U == BL_Transport_Byte_Held){
+		HAL_STATUS = BL_Transport_Receive(&BL_Transport_Held_Byte, 1, Timeout);
+		if(HAL_OK == HAL_STATUS){
+			BL_Transport_Byte_Held = 1;
+		}
+		else {/*Nothing to be done */}
+	}
+	else {/*Nothing to be done */}
+	return HAL_STATUS;
+}
+
+void BL_Transport_Send(const uint8_t *pBuffer, uint16_t Length){
+	if(BL_TRANSPORT_QUIET == BL_Transport_Quiet){
+		return;
+	}
+	else {/*Nothing to be done */}
+#if (BL_TRANSPORT == BL_TRANSPORT_UART)
+#if (BL_RS485_DE == BL_RS485_DE_ENABLE)
+	/* HAL_UART_Transmit returns after the stop bit of the last byte, DE can drop right away */
+	HAL_GPIO_WritePin(BL_RS485_DE_PORT, BL_RS485_DE_PIN, GPIO_PIN_SET);
+	HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)pBuffer, Length, HAL_MAX_DELAY);
+	HAL_GPIO_WritePin(BL_RS485_DE_PORT, BL_RS485_DE_PIN, GPIO_PIN_RESET);
+#else
+	HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)pBuffer, Length, HAL_MAX_DELAY);
+#endif
+#elif (BL_TRANSPORT == BL_TRANSPORT_SPI)
+	HAL_SPI_Transmit(BL_HOST_COMMUNICATION_SPI, (uint8_t *)pBuffer, Length, BL_SPI_SEND_TIMEOUT_MS);
+#elif (BL_TRANSPORT == BL_TRANSPORT_CAN)
+	CAN_TxHeaderTypeDef CAN_Tx_Header = {0};
+	uint32_t CAN_Tx_Mailbox = 0;
+	uint32_t Tick_Start = 0;
+	CAN_Tx_Header.StdId = BL_CAN_BL_ID;
+	CAN_Tx_Header.IDE = CAN_ID_STD;
+	CAN_Tx_Header.RTR = CAN_RTR_DATA;
+	while(Length > 0U){
+		CAN_Tx_Header.DLC = (Length > 8U) ? 8U : Length;
+		Tick_Start = HAL_GetTick();
+		while((0U == HAL_CAN_GetTxMailboxesFreeLevel(BL_HOST_COMMUNICATION_CAN)) &&
+		      ((HAL_GetTick() - Tick_Start) < BL_CAN_SEND_TIMEOUT_MS)){}
+		if(HAL_OK != HAL_CAN_AddTxMessage(BL_HOST_COMMUNICATION_CAN, &CAN_Tx_Header, (uint8_t *)pBuffer, &CAN_Tx_Mailbox)){
+			/* Nobody acknowledges on the bus, the host times out and sends again */
+			break;
+		}
+		else {/*Nothing to be done */}
+		pBuffer += CAN_Tx_Header.DLC;
+		Length -= (uint16_t)CAN_Tx_Header.DLC;
+	}
+#elif (BL_TRANSPORT == BL_TRANSPORT_USB_CDC)
+	BL_USB_CDC_Send(pBuffer, Length);
+#elif (BL_TRANSPORT == BL_TRANSPORT_LOOPBACK)
+	while((Length > 0U) && (BL_Loopback_Tx_Count < BL_LOOPBACK_BUFFER_SIZE)){
+		BL_Loopback_Tx[BL_Loopback_Tx_Count++] = *pBuffer++;
+		Length--;
+	}
+#endif
+}
+
+void BL_Transport_Set_Quiet(uint8_t Quiet){
+	BL_Transport_Quiet = Quiet;
+}
+
+HAL_StatusTypeDef BL_Transport_Set_Speed(uint32_t Speed){
+	HAL_StatusTypeDef HAL_STATUS = HAL_ERROR;
+#if (BL_TRANSPORT == BL_TRANSPORT_UART)
+	if(0U != Speed){
+		(BL_HOST_COMMUNICATION_UART)->Init.BaudRate = Speed;
+		HAL_STATUS = HAL_UART_Init(BL_HOST_COMMUNICATION_UART);
+#if (BL_UART_RX_DMA == BL_UART_RX_DMA_ENABLE)
+		/* HAL_UART_Init leaves the reception stopped, bytes at the old rate are of no use anyway */
+		BL_UART_Rx_Start();
+#endif
+	}
+	else {/*Nothing to be done */}
+#elif (BL_TRANSPORT == BL_TRANSPORT_CAN)
+	uint32_t Time_Quanta = 0;
+	uint32_t Prescaler = 0;
+	/* One bit is the sync quantum plus both segments, the prescaler has to divide PCLK1 exactly */
+	Time_Quanta = 1U + (((BL_HOST_COMMUNICATION_CAN)->Init.TimeSeg1 >> CAN_BTR_TS1_Pos) + 1U)
+	                 + (((BL_HOST_COMMUNICATION_CAN)->Init.TimeSeg2 >> CAN_BTR_TS2_Pos) + 1U);
+	if(0U != Speed){
+		Prescaler = HAL_RCC_GetPCLK1Freq() / (Speed * Time_Quanta);
+	}
+	else {/*Nothing to be done */}
+	if((Prescaler >= 1U) && (Prescaler <= 1024U) && ((Prescaler * Speed * Time_Quanta) == HAL_RCC_GetPCLK1Freq())){
+		HAL_CAN_Stop(BL_HOST_COMMUNICATION_CAN);
+		(BL_HOST_COMMUNICATION_CAN)->Init.Prescaler = Prescaler;
+		HAL_STATUS = HAL_CAN_Init(BL_HOST_COMMUNICATION_CAN);
+		if(HAL_OK == HAL_STATUS){
+			HAL_STATUS = HAL_CAN_Start(BL_HOST_COMMUNICATION_CAN);
+		}
+		else {/*Nothing to be done */}
+	}
+	else {/*Nothing to be done */}
+#else
+	/* The SPI master sets the clock, USB has a fixed one and the loopback none */
+	(void)Speed;
+	HAL_STATUS = HAL_OK;
+#endif
+	return HAL_STATUS;
+}
+
+#if (BL_TRANSPORT == BL_TRANSPORT_LOOPBACK)
+uint16_t BL_Loopback_Inject(const uint8_t *pBuffer, uint16_t Length){
+	uint16_t Queued = 0;
+	uint16_t Next_Head = 0;
+	for(Queued=0;Queued<Length;Queued++){
+		Next_Head = (uint16_t)((BL_Loopback_Rx_Head + 1U) % BL_LOOPBACK_BUFFER_SIZE);
+		if(Next_Head == BL_Loopback_Rx_Tail){
+			break;
+		}
+		else {/*Nothing to be done */}
+		BL_Loopback_Rx[BL_Loopback_Rx_Head] = pBuffer[Queued];
+		BL_Loopback_Rx_Head = Next_Head;
+	}
+	return Queued;
+}
+
+uint16_t BL_Loopback_Collect(uint8_t *pBuffer, uint16_t Length){
+	uint16_t Copied = (Length < BL_Loopback_Tx_Count) ? Length : BL_Loopback_Tx_Count;
+	memcpy(pBuffer, BL_Loopback_Tx, Copied);
+	memmove(BL_Loopback_Tx, &BL_Loopback_Tx[Copied], BL_Loopback_Tx_Count - Copied);
+	BL_Loopback_Tx_Count -= Copied;
+	return Copied;
+}
+#endif
+
+#if ((BL_TRANSPORT == BL_TRANSPORT_UART) && (BL_UART_RX_DMA == BL_UART_RX_DMA_ENABLE))
+/* The vectors of USART2 and its RX channel, they move with BL_UART_RX_DMA_CHANNEL and BL_UART_IRQ */
+void DMA1_Channel6_IRQHandler(void){
+	HAL_DMA_IRQHandler(&BL_UART_Rx_DMA);
+}
+
+void USART2_IRQHandler(void){
+	HAL_UART_IRQHandler(BL_HOST_COMMUNICATION_UART);
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size){
+	(void)Size;
+	/* The idle events only wake the core, the half and full ring ones count the laps */
+	if((BL_HOST_COMMUNICATION_UART == huart) && (HAL_UART_RXEVENT_IDLE != HAL_UARTEx_GetRxEventType(huart))){
+		BL_UART_Rx_Halves++;
+	}
+	else {/*Nothing to be done */}
+}
+#endif
+
+/*------------------ Functions Definitions END -----------------*/
+
+
+/*------------------ Static Functions Definitions -----------------*/
+static HAL_StatusTypeDef BL_Transport_Receive(uint8_t *pBuffer, uint16_t Length, uint32_t Timeout){
+	HAL_StatusTypeDef HAL_STATUS = HAL_ERROR;
+#if ((BL_TRANSPORT == BL_TRANSPORT_UART) && (BL_UART_RX_DMA == BL_UART_RX_DMA_ENABLE))
+	uint32_t Tick_Start = HAL_GetTick();
+	uint32_t Pending = 0;
+	HAL_STATUS = HAL_OK;
+	while((Length > 0U) && (HAL_OK == HAL_STATUS)){
+		Pending = BL_UART_Rx_Written() - BL_UART_Rx_Read;
+		if(Pending > BL_UART_RX_BUFFER_SIZE){
+			/* The DMA has lapped the tail, the bytes it overwrote are gone: start over on an empty
+			   ring and have the frame NACKed, the host sends what it had in flight again */
+			BL_UART_Rx_Start();
+			HAL_STATUS = HAL_TIMEOUT;
+		}
+		else if(0U != Pending){
+			*pBuffer++ = BL_UART_Rx_Ring[BL_UART_Rx_Read % BL_UART_RX_BUFFER_SIZE];
+			BL_UART_Rx_Read++;
+			Length--;
+		}
+		else if(HAL_UART_STATE_READY == (BL_HOST_COMMUNICATION_UART)->RxState){
+			/* An overrun or a DMA error has stopped the reception, the frame it cut runs into the timeout */
+			BL_UART_Rx_Start();
+		}
+		else if((HAL_MAX_DELAY != Timeout) && ((HAL_GetTick() - Tick_Start) >= Timeout)){
+			HAL_STATUS = HAL_TIMEOUT;
+		}
+		else {
+			BL_UART_Rx_Sleep(Timeout);
+		}
+	}
+#elif (BL_TRANSPORT == BL_TRANSPORT_UART)
+	HAL_STATUS = HAL_UART_Receive(BL_HOST_COMMUNICATION_UART, pBuffer, Length, Timeout);
+#elif (BL_TRANSPORT == BL_TRANSPORT_SPI)
+	HAL_STATUS = HAL_SPI_Receive(BL_HOST_COMMUNICATION_SPI, pBuffer, Length, Timeout);
+#elif (BL_TRANSPORT == BL_TRANSPORT_CAN)
+	CAN_RxHeaderTypeDef CAN_Rx_Header = {0};
+	uint32_t Tick_Start = HAL_GetTick();
+	HAL_STATUS = HAL_OK;
+	while((Length > 0U) && (HAL_OK == HAL_STATUS)){
+		if(BL_CAN_Rx_Index < BL_CAN_Rx_Count){
+			*pBuffer++ = BL_CAN_Rx_Data[BL_CAN_Rx_Index++];
+			Length--;
+		}
+		else if(0U != HAL_CAN_GetRxFifoFillLevel(BL_HOST_COMMUNICATION_CAN, CAN_RX_FIFO0)){
+			HAL_CAN_GetRxMessage(BL_HOST_COMMUNICATION_CAN, CAN_RX_FIFO0, &CAN_Rx_Header, BL_CAN_Rx_Data);
+			BL_CAN_Rx_Count = (uint8_t)CAN_Rx_Header.DLC;
+			BL_CAN_Rx_Index = 0;
+		}
+		else if((HAL_MAX_DELAY != Timeout) && ((HAL_GetTick() - Tick_Start) >= Timeout)){
+			HAL_STATUS = HAL_TIMEOUT;
+		}
+		else {/*Nothing to be done */}
+	}
+#elif (BL_TRANSPORT == BL_TRANSPORT_USB_CDC)
+	HAL_STATUS = BL_USB_CDC_Receive(pBuffer, Length, Timeout);
+#elif (BL_TRANSPORT == BL_TRANSPORT_LOOPBACK)
+	/* Nothing queued is a timeout at once, a test injects the whole frame before it fetches it */
+	(void)Timeout;
+	HAL_STATUS = HAL_OK;
+	while((Length > 0U) && (HAL_OK == HAL_STATUS)){
+		if(BL_Loopback_Rx_Tail != BL_Loopback_Rx_Head){
+			*pBuffer++ = BL_Loopback_Rx[BL_Loopback_Rx_Tail];
+			BL_Loopback_Rx_Tail = (uint16_t)((BL_Loopback_Rx_Tail + 1U) % BL_LOOPBACK_BUFFER_SIZE);
+			Length--;
+		}
+		else {
+			HAL_STATUS = HAL_TIMEOUT;
+		}
+	}
+#endif
+	return HAL_STATUS;
+}
+
+static HAL_StatusTypeDef BL_Transport_Receive_Body(uint8_t *pBuffer, uint16_t Data_length){
+	HAL_StatusTypeDef HAL_STATUS = HAL_OK;
+	uint16_t Byte_Index = 0;
+#if (BL_TRANSPORT == BL_TRANSPORT_SPI)
+	/* The master clocks the frame in one burst, a byte call each would overrun at multi-Mbit rates */
+	(void)Byte_Index;
+	HAL_STATUS = BL_Transport_Receive(pBuffer, Data_length, BL_INTER_BYTE_TIMEOUT_MS);
+#else
+	/* One byte per call: the HAL timeout runs over a whole call, here it has to run between bytes */
+	for(Byte_Index=0;(Byte_Index<Data_length) && (HAL_OK==HAL_STATUS);Byte_Index++){
+		HAL_STATUS = BL_Transport_Receive(&pBuffer[Byte_Index], 1, BL_INTER_BYTE_TIMEOUT_MS);
+	}
+#endif
+	return HAL_STATUS;
+}
+
+#if ((BL_TRANSPORT == BL_TRANSPORT_UART) && (BL_UART_RX_DMA == BL_UART_RX_DMA_ENABLE))
+static void BL_UART_Rx_Start(void){
+	HAL_UART_AbortReceive(BL_HOST_COMMUNICATION_UART);
+	BL_UART_Rx_Read = 0;
+	BL_UART_Rx_Halves = 0;
+	/* The idle line ends every frame with an interrupt, the core wakes once per frame */
+	HAL_UARTEx_ReceiveToIdle_DMA(BL_HOST_COMMUNICATION_UART, BL_UART_Rx_Ring, BL_UART_RX_BUFFER_SIZE);
+}
+
+static uint32_t BL_UART_Rx_Written(void){
+	uint32_t Halves = 0;
+	uint32_t Head = 0;
+	do {
+		Halves = BL_UART_Rx_Halves;
+		/* The counter reloads to the buffer size as soon as it reaches 0 */
+		Head = (BL_UART_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(&BL_UART_Rx_DMA)) % BL_UART_RX_BUFFER_SIZE;
+	} while(Halves != BL_UART_Rx_Halves);
+	/* Offset from the start of the half the last event left the DMA in. The modulo covers a
+	   half that is filled but whose event has not run yet, e.g. with the interrupts masked */
+	return (Halves * (BL_UART_RX_BUFFER_SIZE / 2U))
+	     + ((Head + BL_UART_RX_BUFFER_SIZE - ((Halves % 2U) * (BL_UART_RX_BUFFER_SIZE / 2U))) % BL_UART_RX_BUFFER_SIZE);
+}
+
+static void BL_UART_Rx_Sleep(uint32_t Timeout){
+	/* With the interrupts masked an interrupt still ends __WFI, it only runs after
+	   __enable_irq, so a frame that ends between the check and __WFI cannot be slept through */
+	__disable_irq();
+	if(BL_UART_Rx_Read == BL_UART_Rx_Written()){
+		if(HAL_MAX_DELAY == Timeout){
+			HAL_SuspendTick();
+			__WFI();
+			HAL_ResumeTick();
+		}
+		else {
+			/* SysTick wakes the core every ms for the timeout */
+			__WFI();
+		}
+	}
+	else {/*Nothing to be done */}
+	__enable_irq();
+}
+#endif
+
+/*------------------ Static Functions Definitions END -----------------*/
@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ * @file           : bl_transport.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_TRANSPORT_H
+#define BL_TRANSPORT_H
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "usart.h"
+#include <string.h>
+#include "bl_usb_cdc.h"
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+/* The link the host commands come in on. The frame format is the same on all
+ * of them, the debug messages stay on BL_DEBUG_UART (USART1), the UART link
+ * is USART2. SPI and CAN need their peripheral enabled in Simple_BL_M3.ioc,
+ * CubeMX then generates hspi1 / hcan / hpcd_USB_FS, for USB it also sets the
+ * PLL up for the 48 MHz USB clock.
+ * The loopback keeps both directions in RAM, a test pushes a frame with
+ * BL_Loopback_Inject, calls BL_UART_FETCH_HOST_COMMAND and reads the answer
+ * back with BL_Loopback_Collect. */
+#define BL_TRANSPORT_UART            0x00
+#define BL_TRANSPORT_SPI             0x01
+#define BL_TRANSPORT_CAN             0x02
+#define BL_TRANSPORT_LOOPBACK        0x03
+#define BL_TRANSPORT_USB_CDC         0x04
+#ifndef BL_TRANSPORT
+/* The host tests build with -DBL_TRANSPORT=BL_TRANSPORT_LOOPBACK */
+#define BL_TRANSPORT                 BL_TRANSPORT_UART
+#endif
+
+#define BL_HOST_COMMUNICATION_UART   &huart2
+#define BL_HOST_COMMUNICATION_SPI    &hspi1
+#define BL_HOST_COMMUNICATION_CAN    &hcan
+#define BL_HOST_COMMUNICATION_USB    &hpcd_USB_FS
+
+/* A frame whose bytes stop for longer than this is dropped and NACKed, the
+ * next byte is taken as a new length byte. The host keeps the line quiet for
+ * at least this long before it sends a frame again after an error. */
+#define BL_INTER_BYTE_TIMEOUT_MS     10U
+
+/* The shortest frame the length byte may announce: a command byte and the CRC32 */
+#define BL_FRAME_MIN_LENGTH          5U
+
+/* SPI slave: the master clocks a whole frame in one go, so the body is taken
+ * in one call. For the answer the master keeps clocking until it has read it,
+ * a master that gives up leaves the bootloader waiting no longer than this. */
+#define BL_SPI_SEND_TIMEOUT_MS       1000U
+
+/* CAN: the byte stream is cut into 8 byte data frames. The host sends on
+ * BL_CAN_HOST_ID, the bootloader answers on BL_CAN_BL_ID, both standard IDs. */
+#define BL_CAN_HOST_ID               0x701U
+#define BL_CAN_BL_ID                 0x702U
+#define BL_CAN_SEND_TIMEOUT_MS       100U
+
+/* Holds the longest reply, CBL_READ_SECTOR_STATUS_CMD on a 128 KB part */
+#define BL_LOOPBACK_BUFFER_SIZE      640U
+
+/* RS-485: the UART drives the transceiver's DE pin high only while it sends,
+ * so the nodes on a shared bus stay off the line between their answers. */
+#define BL_RS485_DE_DISABLE          0x00
+#define BL_RS485_DE_ENABLE           0x01
+#define BL_RS485_DE                  BL_RS485_DE_DISABLE
+#define BL_RS485_DE_PORT             GPIOA
+#define BL_RS485_DE_PIN              GPIO_PIN_1
+
+/* UART receive: USART2_RX runs a circular DMA transfer (DMA1 channel 6) into
+ * a ring, so the bytes keep coming in while the bootloader erases or programs
+ * and frames that arrive back to back queue up in it. The idle line, half and
+ * full transfer interrupts wake the core, which sleeps in __WFI while the ring
+ * is empty. With BL_UART_RX_DMA_DISABLE the UART is polled as before. */
+#define BL_UART_RX_DMA_DISABLE       0x00
+#define BL_UART_RX_DMA_ENABLE        0x01
+#define BL_UART_RX_DMA               BL_UART_RX_DMA_ENABLE
+#define BL_UART_RX_DMA_CHANNEL       DMA1_Channel6
+#define BL_UART_RX_DMA_IRQ           DMA1_Channel6_IRQn
+#define BL_UART_IRQ                  USART2_IRQn
+/* Four frames of the longest length. Host.py keeps the bytes it has in flight
+ * within it, a DMA that laps the tail anyway restarts the ring and the frame
+ * is NACKed. Change BL_UART_RX_BUFFER_SIZE in Host.py along with it. */
+#define BL_UART_RX_BUFFER_SIZE       1024U
+
+/* A quiet transport drops everything the bootloader sends, see BL_Transport_Set_Quiet */
+#define BL_TRANSPORT_TALK            0x00
+#define BL_TRANSPORT_QUIET           0x01
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+
+/*------------------ SW INTERFACES DECLARATIONS ---------------------*/
+/**
+ * @brief Starts the selected transport, the peripheral itself is set up by the MX_ init functions.
+ */
+void BL_Transport_Open(void);
+
+/**
+ * @brief Stops what BL_Transport_Open started, the DMA and the interrupts of
+ *        the link, before the bootloader hands over to the application.
+ */
+void BL_Transport_Close(void);
+
+/**
+ * @brief Receives one frame: waits for the length byte, then takes the body
+ *        with BL_INTER_BYTE_TIMEOUT_MS between two bytes.
+ *
+ * @param pBuffer       Frame buffer, the length byte goes to pBuffer[0].
+ * @param Buffer_Length Size of pBuffer.
+ *
+ * @return HAL_OK, HAL_TIMEOUT when the bytes stopped or the length byte
+ *         announced less than BL_FRAME_MIN_LENGTH bytes, both are NACKed,
+ *         HAL_ERROR for an empty frame or one longer than the buffer.
+ */
+HAL_StatusTypeDef BL_Transport_Receive_Frame(uint8_t *pBuffer, uint16_t Buffer_Length);
+
+/**
+ * @brief Waits for the first byte from the host without taking it: the next
+ *        BL_Transport_Receive_Frame starts with it.
+ *
+ * @param Timeout Longest wait in ms.
+ *
+ * @return HAL_OK when a byte came, HAL_TIMEOUT otherwise.
+ */
+HAL_StatusTypeDef BL_Transport_Wait(uint32_t Timeout);
+
+/**
+ * @brief Sends bytes to the host, an ACK and its reply are two calls.
+ *
+ * @param pBuffer Bytes to send.
+ * @param Length  Number of bytes.
+ */
+void BL_Transport_Send(const uint8_t *pBuffer, uint16_t Length);
+
+/**
+ * @brief Changes the speed of the link: baud rate for UART, bit rate for CAN.
+ *        The SPI master sets the SPI clock and USB runs at 12 Mbit/s, the call
+ *        changes nothing there.
+ *
+ * @param Speed Bits per second.
+ *
+ * @return HAL_OK, or HAL_ERROR when the peripheral cannot run at that speed.
+ */
+HAL_StatusTypeDef BL_Transport_Set_Speed(uint32_t Speed);
+
+/**
+ * @brief Mutes or unmutes BL_Transport_Send. A node on a shared bus that is
+ *        not addressed must not answer, not even with a NACK.
+ *
+ * @param Quiet BL_TRANSPORT_QUIET or BL_TRANSPORT_TALK.
+ */
+void BL_Transport_Set_Quiet(uint8_t Quiet);
+
+#if (BL_TRANSPORT == BL_TRANSPORT_LOOPBACK)
+/**
+ * @brief Queues bytes for the bootloader to receive.
+ *
+ * @return Number of bytes queued, less than Length when the buffer is full.
+ */
+uint16_t BL_Loopback_Inject(const uint8_t *pBuffer, uint16_t Length);
+
+/**
+ * @brief Takes the bytes the bootloader has sent.
+ *
+ * @return Number of bytes copied to pBuffer.
+ */
+uint16_t BL_Loopback_Collect(uint8_t *pBuffer, uint16_t Length);
+#endif
+
+/*------------------ SW INTERFACES DECLARATIONS END -----------------*/
+
+
+#endif
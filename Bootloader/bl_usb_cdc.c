@@ -0,0 +1,473 @@
+/**
+ ******************************************************************************
+ * @file           : bl_usb_cdc.c
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "bl_transport.h"
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+#if (BL_TRANSPORT == BL_TRANSPORT_USB_CDC)
+
+/*------------------ MACRO DECLARATION ----------------------*/
+#define BL_USB_REQ_TYPE_MASK                 0x60U
+#define BL_USB_REQ_TYPE_STANDARD             0x00U
+#define BL_USB_REQ_TYPE_CLASS                0x20U
+
+#define BL_USB_REQ_GET_STATUS                0x00U
+#define BL_USB_REQ_CLEAR_FEATURE             0x01U
+#define BL_USB_REQ_SET_FEATURE               0x03U
+#define BL_USB_REQ_SET_ADDRESS               0x05U
+#define BL_USB_REQ_GET_DESCRIPTOR            0x06U
+#define BL_USB_REQ_GET_CONFIGURATION         0x08U
+#define BL_USB_REQ_SET_CONFIGURATION         0x09U
+#define BL_USB_REQ_GET_INTERFACE             0x0AU
+#define BL_USB_REQ_SET_INTERFACE             0x0BU
+
+#define BL_CDC_SET_LINE_CODING               0x20U
+#define BL_CDC_GET_LINE_CODING               0x21U
+#define BL_CDC_SET_CONTROL_LINE_STATE        0x22U
+
+#define BL_USB_DESC_DEVICE                   0x01U
+#define BL_USB_DESC_CONFIGURATION            0x02U
+#define BL_USB_DESC_STRING                   0x03U
+
+#define BL_USB_SERIAL_DIGITS                 24U
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+/* ------------------------------GLOBAL VAR DECLERATIONS----------------------------*/
+static const uint8_t BL_USB_Device_Descriptor[18] = {
+	18, BL_USB_DESC_DEVICE, 0x00, 0x02,
+	0x02, 0x00, 0x00,                            /* CDC class on the interfaces */
+	BL_USB_MAX_PACKET,
+	(uint8_t)BL_USB_VID, (uint8_t)(BL_USB_VID >> 8),
+	(uint8_t)BL_USB_PID, (uint8_t)(BL_USB_PID >> 8),
+	0x00, 0x02,                                  /* bcdDevice 2.00 */
+	1, 2, 3,                                     /* manufacturer, product, serial number */
+	1
+};
+
+static const uint8_t BL_USB_Configuration_Descriptor[67] = {
+	9, BL_USB_DESC_CONFIGURATION, 67, 0, 2, 1, 0, 0x80, 50,
+	/* Interface 0: communication, one interrupt endpoint */
+	9, 0x04, 0, 0, 1, 0x02, 0x02, 0x01, 0,
+	5, 0x24, 0x00, 0x10, 0x01,                   /* header, CDC 1.10 */
+	5, 0x24, 0x01, 0x00, 0x01,                   /* call management, data on interface 1 */
+	4, 0x24, 0x02, 0x02,                         /* ACM: line coding and control line state */
+	5, 0x24, 0x06, 0x00, 0x01,                   /* union: interface 0 controls interface 1 */
+	7, 0x05, BL_USB_CMD_EP, 0x03, BL_USB_CMD_PACKET, 0, 0x10,
+	/* Interface 1: data, two bulk endpoints */
+	9, 0x04, 1, 0, 2, 0x0A, 0x00, 0x00, 0,
+	7, 0x05, BL_USB_DATA_OUT_EP, 0x02, BL_USB_MAX_PACKET, 0, 0,
+	7, 0x05, BL_USB_DATA_IN_EP, 0x02, BL_USB_MAX_PACKET, 0, 0
+};
+
+static const uint8_t BL_USB_Language_String[4] = {4, BL_USB_DESC_STRING, 0x09, 0x04};
+static const char BL_USB_Manufacturer[] = "STMicroelectronics";
+static const char BL_USB_Product[] = "STM32F103 Bootloader";
+static char BL_USB_Serial_Number[BL_USB_SERIAL_DIGITS + 1];
+/* The longest string is the serial number, two bytes per character */
+static uint8_t BL_USB_String_Descriptor[2 + (2 * BL_USB_SERIAL_DIGITS)];
+
+/* 115200 8N1 until the host sets something else, the value is only stored */
+static uint8_t BL_USB_Line_Coding[7] = {0x00, 0xC2, 0x01, 0x00, 0x00, 0x00, 0x08};
+static uint8_t BL_USB_Status_Reply[2] = {0};
+static uint8_t BL_USB_Configuration = 0;
+
+/* Data stage of a control read. The PCD driver sends one packet per call on
+ * endpoint 0 and keeps no count of the rest, so it is kept here. */
+static const uint8_t *BL_USB_Ep0_Data = NULL;
+static uint16_t BL_USB_Ep0_Remaining = 0;
+static uint8_t BL_USB_Ep0_ZLP = 0;
+static uint8_t BL_USB_Ep0_Data_Stage = 0;
+
+static uint8_t BL_USB_Rx_Packet[BL_USB_MAX_PACKET];
+static uint8_t BL_USB_Tx_Packet[BL_USB_MAX_PACKET];
+static uint8_t BL_USB_Rx_Buffer[BL_USB_RX_BUFFER_SIZE];
+static volatile uint16_t BL_USB_Rx_Head = 0;
+static volatile uint16_t BL_USB_Rx_Tail = 0;
+static volatile uint8_t BL_USB_Rx_Paused = 0;
+static volatile uint8_t BL_USB_Tx_Busy = 0;
+static volatile uint8_t BL_USB_Configured = 0;
+
+static PCD_HandleTypeDef *BL_USB_PCD = NULL;
+
+/* ------------------------------GLOBAL VAR DECLERATIONS END----------------------------*/
+
+/*------------------ Static Functions Declarations -----------------*/
+/**
+ * @brief Number of bytes the receive buffer can still take.
+ */
+static uint16_t BL_USB_Rx_Free(void);
+
+/**
+ * @brief Answers a control request with data, cut to what the host asked for.
+ */
+static void BL_USB_Ep0_Send(PCD_HandleTypeDef *hpcd, const uint8_t *pData, uint16_t Length, uint16_t Requested_Length);
+
+/**
+ * @brief Sends the next packet of a control read. After the last one the
+ *        zero-length OUT of the status stage is accepted.
+ */
+static void BL_USB_Ep0_Continue(PCD_HandleTypeDef *hpcd);
+
+/**
+ * @brief Ends a control request without data stage.
+ */
+static void BL_USB_Ep0_Status(PCD_HandleTypeDef *hpcd);
+
+/**
+ * @brief Refuses a control request.
+ */
+static void BL_USB_Ep0_Stall(PCD_HandleTypeDef *hpcd);
+
+/**
+ * @brief Builds a string descriptor from ASCII text.
+ *
+ * @return Length of the descriptor in BL_USB_String_Descriptor.
+ */
+static uint16_t BL_USB_Build_String(const char *pText);
+
+/**
+ * @brief Answers GET_DESCRIPTOR.
+ */
+static void BL_USB_Get_Descriptor(PCD_HandleTypeDef *hpcd, uint16_t wValue, uint16_t wLength);
+
+/**
+ * @brief Answers SET_CONFIGURATION: opens or closes the CDC endpoints.
+ */
+static void BL_USB_Set_Configuration(PCD_HandleTypeDef *hpcd, uint8_t Configuration);
+
+/*------------------ Static Functions Declarations END -----------------*/
+
+
+/*------------------ Functions Definitions -----------------*/
+void BL_USB_CDC_Open(PCD_HandleTypeDef *hpcd){
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	uint32_t Unique_ID[3] = {0};
+	uint8_t Digit_Index = 0;
+	uint8_t Nibble = 0;
+
+	Unique_ID[0] = *(volatile uint32_t *)(UID_BASE);
+	Unique_ID[1] = *(volatile uint32_t *)(UID_BASE + 4U);
+	Unique_ID[2] = *(volatile uint32_t *)(UID_BASE + 8U);
+	for(Digit_Index=0;Digit_Index<BL_USB_SERIAL_DIGITS;Digit_Index++){
+		Nibble = (uint8_t)((Unique_ID[Digit_Index / 8U] >> (28U - (4U * (Digit_Index % 8U)))) & 0x0FU);
+		BL_USB_Serial_Number[Digit_Index] = (char)((Nibble < 10U) ? ('0' + Nibble) : ('A' + Nibble - 10U));
+	}
+	BL_USB_Serial_Number[BL_USB_SERIAL_DIGITS] = '\0';
+
+	BL_USB_PCD = hpcd;
+	BL_USB_Rx_Head = 0;
+	BL_USB_Rx_Tail = 0;
+	BL_USB_Rx_Paused = 0;
+	BL_USB_Tx_Busy = 0;
+	BL_USB_Configured = 0;
+
+	/* D+ has a fixed pull-up on most boards: pull it low for a moment so the
+	   host sees a new device after a reset into the bootloader */
+	GPIO_InitStruct.Pin = GPIO_PIN_12;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+	HAL_GPIO_WritePin(GPIOA, GPIO_PIN_12, GPIO_PIN_RESET);
+	HAL_Delay(10);
+	HAL_GPIO_DeInit(GPIOA, GPIO_PIN_12);
+
+	HAL_PCDEx_PMAConfig(hpcd, 0x00U, PCD_SNG_BUF, BL_USB_PMA_EP0_OUT);
+	HAL_PCDEx_PMAConfig(hpcd, 0x80U, PCD_SNG_BUF, BL_USB_PMA_EP0_IN);
+	HAL_PCDEx_PMAConfig(hpcd, BL_USB_DATA_OUT_EP, PCD_SNG_BUF, BL_USB_PMA_DATA_OUT);
+	HAL_PCDEx_PMAConfig(hpcd, BL_USB_DATA_IN_EP, PCD_SNG_BUF, BL_USB_PMA_DATA_IN);
+	HAL_PCDEx_PMAConfig(hpcd, BL_USB_CMD_EP, PCD_SNG_BUF, BL_USB_PMA_CMD);
+	HAL_PCD_Start(hpcd);
+}
+
+HAL_StatusTypeDef BL_USB_CDC_Receive(uint8_t *pBuffer, uint16_t Length, uint32_t Timeout){
+	HAL_StatusTypeDef HAL_STATUS = HAL_OK;
+	uint32_t Tick_Start = HAL_GetTick();
+	while((Length > 0U) && (HAL_OK == HAL_STATUS)){
+		if(BL_USB_Rx_Tail != BL_USB_Rx_Head){
+			*pBuffer++ = BL_USB_Rx_Buffer[BL_USB_Rx_Tail];
+			BL_USB_Rx_Tail = (uint16_t)((BL_USB_Rx_Tail + 1U) % BL_USB_RX_BUFFER_SIZE);
+			Length--;
+			/* The interrupt only pauses the endpoint, so it is safe to look at the flag here first */
+			if((0U != BL_USB_Rx_Paused) && (BL_USB_Rx_Free() >= BL_USB_MAX_PACKET)){
+				BL_USB_Rx_Paused = 0;
+				HAL_PCD_EP_Receive(BL_USB_PCD, BL_USB_DATA_OUT_EP, BL_USB_Rx_Packet, BL_USB_MAX_PACKET);
+			}
+			else {/*Nothing to be done */}
+		}
+		else if((HAL_MAX_DELAY != Timeout) && ((HAL_GetTick() - Tick_Start) >= Timeout)){
+			HAL_STATUS = HAL_TIMEOUT;
+		}
+		else {/*Nothing to be done */}
+	}
+	return HAL_STATUS;
+}
+
+void BL_USB_CDC_Send(const uint8_t *pBuffer, uint16_t Length){
+	uint16_t Packet_Length = 0;
+	uint32_t Tick_Start = 0;
+	/* The host sees the end of a transfer in a short packet: one that fills its
+	   last packet is followed by a zero-length one */
+	uint8_t Send_ZLP = ((Length > 0U) && (0U == (Length % BL_USB_MAX_PACKET))) ? 1U : 0U;
+	while(((Length > 0U) || (0U != Send_ZLP)) && (0U != BL_USB_Configured)){
+		Tick_Start = HAL_GetTick();
+		while((0U != BL_USB_Tx_Busy) && ((HAL_GetTick() - Tick_Start) < BL_USB_SEND_TIMEOUT_MS)){}
+		if(0U != BL_USB_Tx_Busy){
+			/* The host stopped reading: it times out and sends the frame again */
+			break;
+		}
+		else {/*Nothing to be done */}
+		Packet_Length = (Length > BL_USB_MAX_PACKET) ? BL_USB_MAX_PACKET : Length;
+		if(0U == Packet_Length){
+			Send_ZLP = 0;
+		}
+		else {/*Nothing to be done */}
+		memcpy(BL_USB_Tx_Packet, pBuffer, Packet_Length);
+		BL_USB_Tx_Busy = 1;
+		HAL_PCD_EP_Transmit(BL_USB_PCD, BL_USB_DATA_IN_EP, BL_USB_Tx_Packet, Packet_Length);
+		pBuffer += Packet_Length;
+		Length -= Packet_Length;
+	}
+}
+
+/* PCD callbacks, called from the USB interrupt */
+void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd){
+	BL_USB_Configuration = 0;
+	BL_USB_Configured = 0;
+	BL_USB_Tx_Busy = 0;
+	BL_USB_Ep0_Data_Stage = 0;
+	HAL_PCD_EP_Open(hpcd, 0x00U, BL_USB_MAX_PACKET, EP_TYPE_CTRL);
+	HAL_PCD_EP_Open(hpcd, 0x80U, BL_USB_MAX_PACKET, EP_TYPE_CTRL);
+}
+
+void HAL_PCD_SetupStageCallback(PCD_HandleTypeDef *hpcd){
+	uint8_t *Setup = (uint8_t *)hpcd->Setup;
+	uint8_t bRequest = Setup[1];
+	uint16_t wValue = (uint16_t)Setup[2] | ((uint16_t)Setup[3] << 8);
+	uint16_t wLength = (uint16_t)Setup[6] | ((uint16_t)Setup[7] << 8);
+
+	if(BL_USB_REQ_TYPE_STANDARD == (Setup[0] & BL_USB_REQ_TYPE_MASK)){
+		switch(bRequest){
+			case BL_USB_REQ_GET_DESCRIPTOR:
+				BL_USB_Get_Descriptor(hpcd, wValue, wLength);
+				break;
+			case BL_USB_REQ_SET_ADDRESS:
+				/* The PCD driver takes the address once the status stage is through */
+				HAL_PCD_SetAddress(hpcd, (uint8_t)(wValue & 0x7FU));
+				BL_USB_Ep0_Status(hpcd);
+				break;
+			case BL_USB_REQ_SET_CONFIGURATION:
+				BL_USB_Set_Configuration(hpcd, (uint8_t)wValue);
+				break;
+			case BL_USB_REQ_GET_CONFIGURATION:
+				BL_USB_Ep0_Send(hpcd, &BL_USB_Configuration, 1, wLength);
+				break;
+			case BL_USB_REQ_GET_STATUS:
+				BL_USB_Ep0_Send(hpcd, BL_USB_Status_Reply, 2, wLength);
+				break;
+			case BL_USB_REQ_GET_INTERFACE:
+				BL_USB_Ep0_Send(hpcd, BL_USB_Status_Reply, 1, wLength);
+				break;
+			case BL_USB_REQ_CLEAR_FEATURE:
+			case BL_USB_REQ_SET_FEATURE:
+			case BL_USB_REQ_SET_INTERFACE:
+				BL_USB_Ep0_Status(hpcd);
+				break;
+			default:
+				BL_USB_Ep0_Stall(hpcd);
+				break;
+		}
+	}
+	else if(BL_USB_REQ_TYPE_CLASS == (Setup[0] & BL_USB_REQ_TYPE_MASK)){
+		switch(bRequest){
+			case BL_CDC_SET_LINE_CODING:
+				/* Data stage first, the status follows in HAL_PCD_DataOutStageCallback */
+				HAL_PCD_EP_Receive(hpcd, 0x00U, BL_USB_Line_Coding, sizeof(BL_USB_Line_Coding));
+				break;
+			case BL_CDC_GET_LINE_CODING:
+				BL_USB_Ep0_Send(hpcd, BL_USB_Line_Coding, sizeof(BL_USB_Line_Coding), wLength);
+				break;
+			case BL_CDC_SET_CONTROL_LINE_STATE:
+				BL_USB_Ep0_Status(hpcd);
+				break;
+			default:
+				BL_USB_Ep0_Stall(hpcd);
+				break;
+		}
+	}
+	else {
+		BL_USB_Ep0_Stall(hpcd);
+	}
+}
+
+void HAL_PCD_DataOutStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum){
+	uint16_t Count = 0;
+	uint16_t Byte_Index = 0;
+	if(0U == epnum){
+		/* Line coding received */
+		BL_USB_Ep0_Status(hpcd);
+	}
+	else if((BL_USB_DATA_OUT_EP & 0x7FU) == epnum){
+		Count = (uint16_t)HAL_PCD_EP_GetRxCount(hpcd, BL_USB_DATA_OUT_EP);
+		for(Byte_Index=0;Byte_Index<Count;Byte_Index++){
+			BL_USB_Rx_Buffer[BL_USB_Rx_Head] = BL_USB_Rx_Packet[Byte_Index];
+			BL_USB_Rx_Head = (uint16_t)((BL_USB_Rx_Head + 1U) % BL_USB_RX_BUFFER_SIZE);
+		}
+		if(BL_USB_Rx_Free() >= BL_USB_MAX_PACKET){
+			HAL_PCD_EP_Receive(hpcd, BL_USB_DATA_OUT_EP, BL_USB_Rx_Packet, BL_USB_MAX_PACKET);
+		}
+		else {
+			/* The endpoint NAKs until BL_USB_CDC_Receive has made room */
+			BL_USB_Rx_Paused = 1;
+		}
+	}
+	else {/*Nothing to be done */}
+}
+
+void HAL_PCD_DataInStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum){
+	if(0U == epnum){
+		/* Called per packet on endpoint 0, and once more after a status stage on IN */
+		if(0U != BL_USB_Ep0_Data_Stage){
+			BL_USB_Ep0_Continue(hpcd);
+		}
+		else {/*Nothing to be done */}
+	}
+	else if((BL_USB_DATA_IN_EP & 0x7FU) == epnum){
+		BL_USB_Tx_Busy = 0;
+	}
+	else {/*Nothing to be done */}
+}
+
+/*------------------ Functions Definitions END -----------------*/
+
+
+/*------------------ Static Functions Definitions -----------------*/
+static uint16_t BL_USB_Rx_Free(void){
+	return (uint16_t)((BL_USB_RX_BUFFER_SIZE - 1U) -
+	                  ((BL_USB_Rx_Head + BL_USB_RX_BUFFER_SIZE - BL_USB_Rx_Tail) % BL_USB_RX_BUFFER_SIZE));
+}
+
+static void BL_USB_Ep0_Send(PCD_HandleTypeDef *hpcd, const uint8_t *pData, uint16_t Length, uint16_t Requested_Length){
+	if(Length > Requested_Length){
+		Length = Requested_Length;
+	}
+	else {/*Nothing to be done */}
+	/* Shorter than asked for and a whole number of packets: a zero-length
+	   packet tells the host there is no more */
+	BL_USB_Ep0_ZLP = ((Length < Requested_Length) && (Length > 0U) && (0U == (Length % BL_USB_MAX_PACKET))) ? 1U : 0U;
+	BL_USB_Ep0_Data = pData;
+	BL_USB_Ep0_Remaining = Length;
+	BL_USB_Ep0_Data_Stage = 1;
+	if(0U == Length){
+		/* An empty answer is one zero-length packet */
+		HAL_PCD_EP_Transmit(hpcd, 0x80U, NULL, 0);
+	}
+	else {
+		BL_USB_Ep0_Continue(hpcd);
+	}
+}
+
+static void BL_USB_Ep0_Continue(PCD_HandleTypeDef *hpcd){
+	uint16_t Packet_Length = 0;
+	if(BL_USB_Ep0_Remaining > 0U){
+		Packet_Length = (BL_USB_Ep0_Remaining > BL_USB_MAX_PACKET) ? BL_USB_MAX_PACKET : BL_USB_Ep0_Remaining;
+		HAL_PCD_EP_Transmit(hpcd, 0x80U, (uint8_t *)BL_USB_Ep0_Data, Packet_Length);
+		BL_USB_Ep0_Data += Packet_Length;
+		BL_USB_Ep0_Remaining -= Packet_Length;
+	}
+	else if(0U != BL_USB_Ep0_ZLP){
+		BL_USB_Ep0_ZLP = 0;
+		HAL_PCD_EP_Transmit(hpcd, 0x80U, NULL, 0);
+	}
+	else {
+		/* Data stage done: after SETUP the driver leaves endpoint 0 OUT at NAK,
+		   the host's zero-length status packet needs it valid */
+		BL_USB_Ep0_Data_Stage = 0;
+		HAL_PCD_EP_Receive(hpcd, 0x00U, NULL, 0U);
+	}
+}
+
+static void BL_USB_Ep0_Status(PCD_HandleTypeDef *hpcd){
+	BL_USB_Ep0_Data_Stage = 0;
+	HAL_PCD_EP_Transmit(hpcd, 0x80U, NULL, 0);
+}
+
+static void BL_USB_Ep0_Stall(PCD_HandleTypeDef *hpcd){
+	BL_USB_Ep0_Data_Stage = 0;
+	HAL_PCD_EP_SetStall(hpcd, 0x80U);
+	HAL_PCD_EP_SetStall(hpcd, 0x00U);
+}
+
+static uint16_t BL_USB_Build_String(const char *pText){
+	uint16_t Length = 2;
+	while(('\0' != *pText) && (Length < sizeof(BL_USB_String_Descriptor))){
+		BL_USB_String_Descriptor[Length++] = (uint8_t)*pText++;
+		BL_USB_String_Descriptor[Length++] = 0x00;
+	}
+	BL_USB_String_Descriptor[0] = (uint8_t)Length;
+	BL_USB_String_Descriptor[1] = BL_USB_DESC_STRING;
+	return Length;
+}
+
+static void BL_USB_Get_Descriptor(PCD_HandleTypeDef *hpcd, uint16_t wValue, uint16_t wLength){
+	uint8_t Descriptor_Type = (uint8_t)(wValue >> 8);
+	uint8_t Descriptor_Index = (uint8_t)wValue;
+	if(BL_USB_DESC_DEVICE == Descriptor_Type){
+		BL_USB_Ep0_Send(hpcd, BL_USB_Device_Descriptor, sizeof(BL_USB_Device_Descriptor), wLength);
+	}
+	else if(BL_USB_DESC_CONFIGURATION == Descriptor_Type){
+		BL_USB_Ep0_Send(hpcd, BL_USB_Configuration_Descriptor, sizeof(BL_USB_Configuration_Descriptor), wLength);
+	}
+	else if((BL_USB_DESC_STRING == Descriptor_Type) && (0U == Descriptor_Index)){
+		BL_USB_Ep0_Send(hpcd, BL_USB_Language_String, sizeof(BL_USB_Language_String), wLength);
+	}
+	else if((BL_USB_DESC_STRING == Descriptor_Type) && (1U == Descriptor_Index)){
+		BL_USB_Ep0_Send(hpcd, BL_USB_String_Descriptor, BL_USB_Build_String(BL_USB_Manufacturer), wLength);
+	}
+	else if((BL_USB_DESC_STRING == Descriptor_Type) && (2U == Descriptor_Index)){
+		BL_USB_Ep0_Send(hpcd, BL_USB_String_Descriptor, BL_USB_Build_String(BL_USB_Product), wLength);
+	}
+	else if((BL_USB_DESC_STRING == Descriptor_Type) && (3U == Descriptor_Index)){
+		BL_USB_Ep0_Send(hpcd, BL_USB_String_Descriptor, BL_USB_Build_String(BL_USB_Serial_Number), wLength);
+	}
+	else {
+		/* Device qualifier and the rest: a full-speed only device stalls them */
+		BL_USB_Ep0_Stall(hpcd);
+	}
+}
+
+static void BL_USB_Set_Configuration(PCD_HandleTypeDef *hpcd, uint8_t Configuration){
+	if(Configuration > 1U){
+		BL_USB_Ep0_Stall(hpcd);
+	}
+	else {
+		if((0U != Configuration) && (0U == BL_USB_Configuration)){
+			HAL_PCD_EP_Open(hpcd, BL_USB_DATA_OUT_EP, BL_USB_MAX_PACKET, EP_TYPE_BULK);
+			HAL_PCD_EP_Open(hpcd, BL_USB_DATA_IN_EP, BL_USB_MAX_PACKET, EP_TYPE_BULK);
+			HAL_PCD_EP_Open(hpcd, BL_USB_CMD_EP, BL_USB_CMD_PACKET, EP_TYPE_INTR);
+			BL_USB_Rx_Paused = 0;
+			HAL_PCD_EP_Receive(hpcd, BL_USB_DATA_OUT_EP, BL_USB_Rx_Packet, BL_USB_MAX_PACKET);
+		}
+		else if((0U == Configuration) && (0U != BL_USB_Configuration)){
+			HAL_PCD_EP_Close(hpcd, BL_USB_DATA_OUT_EP);
+			HAL_PCD_EP_Close(hpcd, BL_USB_DATA_IN_EP);
+			HAL_PCD_EP_Close(hpcd, BL_USB_CMD_EP);
+		}
+		else {/*Nothing to be done */}
+		BL_USB_Configuration = Configuration;
+		BL_USB_Configured = Configuration;
+		BL_USB_Tx_Busy = 0;
+		BL_USB_Ep0_Status(hpcd);
+	}
+}
+
+/*------------------ Static Functions Definitions END -----------------*/
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ * @file           : bl_usb_cdc.h
+ * @author         : Romany Sobhy
+ ******************************************************************************
+ */
+
+#ifndef BL_USB_CDC_H
+#define BL_USB_CDC_H
+
+
+/*------------------ INCLUDES START -------------------------------------*/
+#include "main.h"
+#include <string.h>
+
+/*------------------ INCLUDES END --------------------------------------*/
+
+
+
+/*------------------ MACRO DECLARATION ----------------------*/
+/* A CDC-ACM virtual serial port on the full-speed USB device, written straight
+ * on the PCD driver: the host sees /dev/ttyACM* or a COM port and Host.py runs
+ * unchanged, the baud rate it sets is ignored. The ST VCP IDs are used so the
+ * stock drivers pick the device up, the serial number is the unique ID. */
+#define BL_USB_VID                   0x0483U
+#define BL_USB_PID                   0x5740U
+#define BL_USB_MAX_PACKET            64U
+
+#define BL_USB_DATA_OUT_EP           0x01U
+#define BL_USB_DATA_IN_EP            0x81U
+#define BL_USB_CMD_EP                0x82U
+#define BL_USB_CMD_PACKET            8U
+
+/* Packet memory: the buffer table takes the first 0x18 bytes for 3 endpoints */
+#define BL_USB_PMA_EP0_OUT           0x18U
+#define BL_USB_PMA_EP0_IN            0x58U
+#define BL_USB_PMA_DATA_OUT          0x98U
+#define BL_USB_PMA_DATA_IN           0xD8U
+#define BL_USB_PMA_CMD               0x118U
+
+/* Bytes received and not taken by the bootloader yet. The OUT endpoint NAKs
+ * while less than one packet is free, so nothing is ever lost. */
+#define BL_USB_RX_BUFFER_SIZE        512U
+#define BL_USB_SEND_TIMEOUT_MS       100U
+
+/*------------------ MACRO DECLARATION END ---------------------*/
+
+
+
+/*------------------ SW INTERFACES DECLARATIONS ---------------------*/
+#ifdef HAL_PCD_MODULE_ENABLED
+/**
+ * @brief Sets up the packet memory and connects to the bus. The PCD itself is
+ *        initialised by MX_USB_PCD_Init.
+ *
+ * @param hpcd The PCD handle generated by CubeMX.
+ */
+void BL_USB_CDC_Open(PCD_HandleTypeDef *hpcd);
+
+/**
+ * @brief Takes received bytes.
+ *
+ * @param pBuffer Where the bytes go.
+ * @param Length  Number of bytes.
+ * @param Timeout Longest wait in ms for the whole call, HAL_MAX_DELAY waits forever.
+ *
+ * @return HAL_OK, or HAL_TIMEOUT when the bytes did not come in time.
+ */
+HAL_StatusTypeDef BL_USB_CDC_Receive(uint8_t *pBuffer, uint16_t Length, uint32_t Timeout);
+
+/**
+ * @brief Sends bytes in packets of BL_USB_MAX_PACKET. Nothing is sent before
+ *        the host has configured the device.
+ */
+void BL_USB_CDC_Send(const uint8_t *pBuffer, uint16_t Length);
+#endif
+
+/*------------------ SW INTERFACES DECLARATIONS END -----------------*/
+
+
+#endif
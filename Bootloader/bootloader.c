@@ -8,13 +8,15 @@
 
 /*------------------ INCLUDES START -------------------------------------*/
 #include "bootloader.h"
+#include "bl_auth_key.h"
+#include "bl_aes_key.h"
 
 /*------------------ INCLUDES END --------------------------------------*/
 
 /* ------------------------------GLOBAL VAR DECLERATIONS----------------------------*/
 static uint8_t BL_HOST_BUFFER[BL_HOST_BUFFER_length];
 
-static uint8_t BL_Supported_CMDs[12] = {
+static uint8_t BL_Supported_CMDs[] = {
     CBL_GET_VER_CMD,
     CBL_GET_HELP_CMD,
     CBL_GET_CID_CMD,
@@ -26,9 +28,80 @@ static uint8_t BL_Supported_CMDs[12] = {
     CBL_MEM_READ_CMD,
     CBL_READ_SECTOR_STATUS_CMD,
     CBL_OTP_READ_CMD,
-    CBL_CHANGE_ROP_LEVEL_CMD
+    CBL_CHANGE_ROP_LEVEL_CMD,
+    CBL_MEM_WRITE_LZ_CMD,
+    CBL_MEM_WRITE_RLE_CMD,
+    CBL_VERIFY_SEGMENTS_CMD,
+    CBL_MEM_WRITE_SEQ_CMD,
+    CBL_NODE_SELECT_CMD,
+    CBL_BCAST_STATUS_CMD,
+#if (BL_AUTH == BL_AUTH_ENABLE)
+    CBL_AUTH_VERIFY_CMD,
+#endif
+#if (BL_AES == BL_AES_ENABLE)
+    CBL_MEM_WRITE_AES_CMD,
+#endif
+    CBL_BATCH_CMD,
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+    CBL_GET_SLOT_INFO_CMD,
+    CBL_SWITCH_SLOT_CMD
+#endif
 };
 
+/* Streaming decompressor state for CBL_MEM_WRITE_LZ_CMD */
+static uint8_t  BL_LZ_Window[BL_LZ_WINDOW_SIZE];
+static uint8_t  BL_LZ_Window_Pos;
+static uint16_t BL_LZ_History;
+static uint32_t BL_LZ_Next_Address;
+
+/* Write status of the last CBL_MEM_WRITE_SEQ_CMD frames, a ring indexed by BL_Seq_Next */
+static uint16_t BL_Seq_Numbers[BL_SEQ_HISTORY_SIZE];
+static uint8_t  BL_Seq_Status[BL_SEQ_HISTORY_SIZE];
+static uint8_t  BL_Seq_Count;
+static uint8_t  BL_Seq_Next;
+
+/* Role of this node on a shared bus and the broadcast frames it has written */
+static uint8_t  BL_Node_State = BL_NODE_STATE_ALL;
+static uint8_t  BL_Bcast_Map[BL_BCAST_MAP_SIZE];
+static uint16_t BL_Bcast_Received;
+
+#if (BL_AUTH == BL_AUTH_ENABLE)
+static const uint8_t BL_Auth_Public_Key[BL_ECDSA_P256_KEY_SIZE] = BL_AUTH_PUBLIC_KEY;
+/* Hash of the flash from BL_Auth_Stream_Start up to BL_Auth_Stream_End, fed by the writes */
+static BL_SHA256_Context_t BL_Auth_Stream;
+static uint32_t BL_Auth_Stream_Start;
+static uint32_t BL_Auth_Stream_End;
+static uint8_t  BL_Auth_Stream_State = BL_AUTH_STREAM_EMPTY;
+static uint32_t BL_Auth_Hash_Cycles;
+/* The image whose signature checked fine, the only code the bootloader starts */
+static uint8_t  BL_Auth_Status = BL_AUTH_FAILED;
+static uint32_t BL_Auth_Image_Address;
+static uint32_t BL_Auth_Image_Length;
+#endif
+
+#if (BL_AES == BL_AES_ENABLE)
+static const uint8_t BL_AES_Key[BL_AES128_KEY_SIZE] = BL_AES_KEY;
+/* Expanded on the first encrypted write */
+static BL_AES128_Context_t BL_AES_Context;
+static uint8_t BL_AES_Key_State = BL_AES_KEY_UNCHECKED;
+#endif
+
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+/* One bit per flash page: set once the page was erased during this session */
+static uint8_t BL_Erased_Pages_Map[(CBL_MAX_PAGE_NUMBER+7)/8];
+/* Update slot of this session, latched on first use: writing a vector table must not move it */
+static uint8_t BL_Update_Slot = BL_SLOT_NONE;
+#endif
+/* Slot whose OPEN record is known to be in the boot selector, saves a page scan per write */
+static uint8_t BL_Open_Slot = BL_SLOT_NONE;
+/* Set when the application asked for the bootloader through the mailbox */
+static uint8_t BL_Mailbox_Request_Taken = 0;
+
+#if (BL_IWDG == BL_IWDG_ENABLE)
+static IWDG_HandleTypeDef BL_IWDG_Handle;
+static uint8_t BL_IWDG_State = BL_IWDG_STOPPED;
+#endif
+
 /*------------------ MACRO DECLARATION ----------------------*/
 
 
@@ -62,6 +135,24 @@ static void handleCBL_GET_CID_CMD(uint8_t* BL_HOST_BUFFER);
  */
 static void handleCBL_GET_RDP_STATUS_CMD(uint8_t* BL_HOST_BUFFER);
 
+/**
+ * @brief Handles the CBL_BATCH_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_BATCH_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Builds the reply of a query without parameters, for its own handler
+ *        and for CBL_BATCH_CMD.
+ *
+ * @param Command The query.
+ * @param pReply  Where the reply goes, BL_QUERY_MAX_REPLY bytes.
+ *
+ * @return Length of the reply, 0 for a command that is not such a query.
+ */
+static uint8_t Bootloader_Query_Reply(uint8_t Command, uint8_t *pReply);
+
 /**
  * @brief Handles the CBL_GO_TO_ADDR_CMD command.
  *
@@ -117,6 +208,166 @@ static void handleCBL_OTP_READ_CMD(uint8_t* BL_HOST_BUFFER);
  * @param BL_HOST_BUFFER The buffer containing the command data.
  */
 
+/**
+ * @brief Handles the CBL_MEM_WRITE_LZ_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_MEM_WRITE_LZ_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Handles the CBL_MEM_WRITE_RLE_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_MEM_WRITE_RLE_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Handles the CBL_VERIFY_SEGMENTS_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_VERIFY_SEGMENTS_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Handles the CBL_MEM_WRITE_SEQ_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_MEM_WRITE_SEQ_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Handles the CBL_NODE_SELECT_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_NODE_SELECT_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Handles the CBL_BCAST_STATUS_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_BCAST_STATUS_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Marks a sequence number as written in the broadcast bitmap.
+ *
+ * @param Sequence_Number Sequence number of a frame written fine.
+ */
+static void Bootloader_Bcast_Record(uint16_t Sequence_Number);
+
+#if (BL_AUTH == BL_AUTH_ENABLE)
+/**
+ * @brief Handles the CBL_AUTH_VERIFY_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_AUTH_VERIFY_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Extends the streamed hash over the bytes a write just programmed.
+ *
+ * @param Address      Start of the write.
+ * @param Length       Bytes programmed.
+ * @param Write_Status FLASH_PAYLOAD_WRITE_PASSED or FLASH_PAYLOAD_WRITE_FAILED.
+ */
+static void Bootloader_Auth_Stream_Write(uint32_t Address, uint32_t Length, uint8_t Write_Status);
+
+/**
+ * @brief Takes back the permission to start an image and drops the streamed
+ *        hash when the erase hit bytes it covers.
+ *
+ * @param Address Start of the erased pages.
+ * @param Length  Bytes erased.
+ */
+static void Bootloader_Auth_Stream_Erase(uint32_t Address, uint32_t Length);
+
+/**
+ * @brief Hashes flash straight from the memory map and counts the cycles it took.
+ */
+static void Bootloader_Auth_Hash_Flash(BL_SHA256_Context_t *pContext, uint32_t Address, uint32_t Length);
+
+/**
+ * @brief Reads the DWT cycle counter, it is started on the first call.
+ */
+static uint32_t Bootloader_Cycle_Count(void);
+#endif
+
+#if (BL_AES == BL_AES_ENABLE)
+/**
+ * @brief Handles the CBL_MEM_WRITE_AES_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_MEM_WRITE_AES_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Expands the key on the first call.
+ *
+ * @return BL_AES_KEY_READY, or BL_AES_KEY_ZERO while bl_aes_key.h holds the placeholder.
+ */
+static uint8_t Bootloader_AES_Key_State(void);
+
+/**
+ * @brief Expands a key, the all-zero key is refused.
+ *
+ * @param pKey The 16 byte key.
+ */
+static void Bootloader_AES_Load_Key(const uint8_t *pKey);
+#endif
+
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+/**
+ * @brief Handles the CBL_GET_SLOT_INFO_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_GET_SLOT_INFO_CMD(uint8_t* BL_HOST_BUFFER);
+
+/**
+ * @brief Handles the CBL_SWITCH_SLOT_CMD command.
+ *
+ * @param BL_HOST_BUFFER The buffer containing the command data.
+ */
+static void handleCBL_SWITCH_SLOT_CMD(uint8_t* BL_HOST_BUFFER);
+#endif
+
+/**
+ * @brief Selects the slot to boot: the slot named by the newest SLOT record
+ *        (slot A without one) if it can boot, otherwise the other slot if that
+ *        one can. A slot can boot when it is not open and holds a plausible
+ *        vector table, with BL_AUTH it also needs its SLOT record.
+ *
+ * @return BL_SLOT_A, BL_SLOT_B or BL_SLOT_NONE.
+ */
+static uint8_t Bootloader_Get_Boot_Slot(void);
+
+/**
+ * @brief Marks a slot incomplete with its OPEN record before the first erase
+ *        or write of the session touches it.
+ *
+ * @param Slot BL_SLOT_A or BL_SLOT_B.
+ *
+ * @return HAL_OK, or the error of the record write: the slot must not be touched then.
+ */
+static HAL_StatusTypeDef Bootloader_Open_Slot(uint8_t Slot);
+
+#if (BL_DUAL_SLOT != BL_DUAL_SLOT_ENABLE)
+/**
+ * @brief Marks the application complete with its SLOT record, if this
+ *        session has opened it.
+ */
+static void Bootloader_Close_Slot(void);
+#endif
+
+#if (BL_IWDG == BL_IWDG_ENABLE)
+/**
+ * @brief Records progress: starts the watchdog on the first complete frame
+ *        and refreshes it on every later one.
+ */
+static void Bootloader_Watchdog_Refresh(void);
+#endif
 
 /**
  * @brief Verifies the CRC of the data received from the host.
@@ -144,11 +395,44 @@ static void BL_Send_ACK(uint8_t Replay_Length);
  */
 static void BL_Send_NACK();
 
+/**
+ * @brief Sends a NACK naming the sequence number of a CBL_MEM_WRITE_SEQ_CMD frame.
+ *
+ * @param Sequence_Number Sequence number taken from the rejected frame.
+ */
+static void BL_Send_Seq_NACK(uint16_t Sequence_Number);
+
+/**
+ * @brief Sends a CBL_SEND_LONG_ACK, the ACK of a reply longer than 255 bytes.
+ *
+ * @param Replay_Length Length of the reply message.
+ */
+static void BL_Send_Long_ACK(uint16_t Replay_Length);
+
+/**
+ * @brief Checks whether a flash page is erased, stops at the first programmed word.
+ *
+ * @param Page_Address Start address of the page.
+ *
+ * @return BL_PAGE_BLANK or BL_PAGE_PROGRAMMED.
+ */
+static uint8_t Bootloader_Page_Is_Blank(uint32_t Page_Address);
+
+/**
+ * @brief CRC of one flash page, fed a byte per word like the frame CRC.
+ *
+ * @param Page_Address Start address of the page.
+ *
+ * @return The CRC, the CRC unit is left reset.
+ */
+static uint32_t Bootloader_Page_CRC(uint32_t Page_Address);
+
 
 /**
- * @brief Jumps to the user application.
+ * @brief Jumps to the application in the boot slot with SysTick, the link and
+ *        all interrupts stopped, returns when no slot holds a complete image.
  *
- * @note This function assumes that the user application is properly flashed and located at the correct
+ * @note This function assumes that the user application is located at the correct
  *       address specified in the linker script.
  */
 static void bootloader_Jump_to_User_App(void);
@@ -166,6 +450,13 @@ static void bootloader_Jump_to_User_App(void);
 
 
 /*------------------ DATA TYPE DECLARATIONS --------------------------*/
+/* Byte sink in front of the half-word flash programming */
+typedef struct {
+	uint32_t          Address;   /* Address of the next byte */
+	uint16_t          HalfWord;  /* Half-word being assembled */
+	uint8_t           Pending;   /* Low byte of HalfWord waits for its partner */
+	HAL_StatusTypeDef Status;    /* First programming error, if any */
+} BL_Flash_Stream_t;
 
 
 /*------------------ DATA TYPE DECLARATIONS END ---------------------*/
@@ -179,7 +470,7 @@ static uint8_t Bootloader_CRC_verify(uint8_t *pData, uint32_t Data_Len, uint32_t
 		uint8_t  CRC_STATUS         = CRC_NOK;
 		uint32_t MCU_CRC_Calculated = 0;
 		uint32_t Data_Buffer        = 0;
-		uint8_t Data_Counter        = 0;
+		uint32_t Data_Counter       = 0;
 	/* Calculate CRC32 */
 	for(Data_Counter=0;Data_Counter<Data_Len;Data_Counter++) {
 		Data_Buffer = ((uint32_t)pData[Data_Counter]);
@@ -188,7 +479,7 @@ static uint8_t Bootloader_CRC_verify(uint8_t *pData, uint32_t Data_Len, uint32_t
 	
 	__HAL_CRC_DR_RESET(CRC_Engine_Obj);
 	
-	if(MCU_CRC_Calculated==CRC_STATUS) {
+	if(MCU_CRC_Calculated==Host_CRC) {
 			CRC_STATUS=CRC_OK;
 		}
 		
@@ -207,19 +498,36 @@ static void BL_Send_ACK(uint8_t Replay_Length){
 	uint8_t Ack_Value[2] = {0};
 	Ack_Value[0]=CBL_SEND_ACK;
 	Ack_Value[1]=Replay_Length;
-	HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)Ack_Value, 2, HAL_MAX_DELAY);
+	BL_Transport_Send((uint8_t *)Ack_Value, 2);
 }
 
 static void BL_Send_NACK(){
 		uint8_t Ack_Value = CBL_SEND_NACK;
-			HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, &Ack_Value, 1, HAL_MAX_DELAY);
+			BL_Transport_Send(&Ack_Value, 1);
+}
+
+static void BL_Send_Seq_NACK(uint16_t Sequence_Number){
+	uint8_t Nack_Value[3] = {0};
+	Nack_Value[0]=CBL_SEND_NACK;
+	Nack_Value[1]=(uint8_t)Sequence_Number;
+	Nack_Value[2]=(uint8_t)(Sequence_Number >> 8);
+	BL_Transport_Send(Nack_Value, 3);
+}
+
+static void BL_Send_Long_ACK(uint16_t Replay_Length){
+	uint8_t Ack_Value[3] = {0};
+	Ack_Value[0]=CBL_SEND_LONG_ACK;
+	Ack_Value[1]=(uint8_t)Replay_Length;
+	Ack_Value[2]=(uint8_t)(Replay_Length >> 8);
+	BL_Transport_Send(Ack_Value, 3);
 }
 
 
 
 static void handleCBL_GET_VER_CMD(uint8_t* BL_HOST_BUFFER) {
     // Implementation for CBL_GET_VER_CMD
-   uint8_t BL_VERSION[4]= {CBL_VERSION_ID	,CBL_SW_MAJOR_VERSION,CBL_SW_MINORR_VERSION, CBL_SW_PATCH_VERSION	};
+   uint8_t BL_VERSION[BL_QUERY_MAX_REPLY]= {0};
+   uint8_t Version_Len=0;
 		uint16_t Host_CMD_Packet_Len=0;
 	 uint32_t  Host_CRC32=0;
 
@@ -235,8 +543,9 @@ static void handleCBL_GET_VER_CMD(uint8_t* BL_HOST_BUFFER) {
 		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
 	 BL_Print_Message("CRC Verifcation Passsed \r\n");
 	 #endif
-		 BL_Send_ACK(4);
-			HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)BL_VERSION, 4, HAL_MAX_DELAY);
+		 Version_Len=Bootloader_Query_Reply(CBL_GET_VER_CMD, BL_VERSION);
+		 BL_Send_ACK(Version_Len);
+			BL_Transport_Send((uint8_t *)BL_VERSION, Version_Len);
 	}
 	else {
 		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
@@ -264,8 +573,8 @@ static void handleCBL_GET_HELP_CMD(uint8_t* BL_HOST_BUFFER) {
 		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
 	 BL_Print_Message("CRC Verifcation Passsed \r\n");
 	 #endif
-	 BL_Send_ACK(12);
-			HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)BL_Supported_CMDs, 12, HAL_MAX_DELAY);
+	 BL_Send_ACK(sizeof(BL_Supported_CMDs));
+			BL_Transport_Send((uint8_t *)BL_Supported_CMDs, sizeof(BL_Supported_CMDs));
 	 }	 
 			
 	
@@ -283,7 +592,8 @@ static void handleCBL_GET_CID_CMD(uint8_t* BL_HOST_BUFFER) {
 	// Implementation for CBL_GET_CID_CMD
      uint16_t Host_CMD_Packet_Len   =0;
 	   uint32_t  Host_CRC32           =0;
-	   uint16_t MCU_ID_NO             =0;
+	   uint8_t MCU_ID_NO[BL_QUERY_MAX_REPLY] = {0};
+	   uint8_t MCU_ID_Len             =0;
 	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
 		BL_Print_Message("CBL_GET_CID_CMD reached.\r\n");
 	 #endif
@@ -299,10 +609,11 @@ static void handleCBL_GET_CID_CMD(uint8_t* BL_HOST_BUFFER) {
 		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
 	BL_Print_Message("CRC Verifcation Passed\r\n");
 	 #endif
-		    MCU_ID_NO = (uint16_t)((DBGMCU->IDCODE)&0x00000FFF);
+		    MCU_ID_Len = Bootloader_Query_Reply(CBL_GET_CID_CMD, MCU_ID_NO);
 
 			/* Report chip ID Number */
-			HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)&MCU_ID_NO, 2, HAL_MAX_DELAY);
+			BL_Send_ACK(MCU_ID_Len);
+			BL_Transport_Send((uint8_t *)MCU_ID_NO, MCU_ID_Len);
 	 }
 	 else {
 	 	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
@@ -334,8 +645,31 @@ static uint8_t Recieved_Address_Verfication(uint32_t JUMP_ADDRESS) {
 
 
 static void handleCBL_GET_RDP_STATUS_CMD(uint8_t* BL_HOST_BUFFER) {
-    // Implementation for CBL_GET_RDP_STATUS_CMD
-    // Add your code here
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint8_t   RDP_Status[BL_QUERY_MAX_REPLY] ={0};
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_GET_RDP_STATUS_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		BL_Send_ACK(1);
+		(void)Bootloader_Query_Reply(CBL_GET_RDP_STATUS_CMD, RDP_Status);
+		BL_Transport_Send(RDP_Status, 1);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
 }
 
 static void handleCBL_GO_TO_ADDR_CMD(uint8_t* BL_HOST_BUFFER) {
@@ -364,11 +698,19 @@ static void handleCBL_GO_TO_ADDR_CMD(uint8_t* BL_HOST_BUFFER) {
 		 
 		 /**Address Verfication**/
 		 Addr_Verf=Recieved_Address_Verfication(HOST_JUMP_ADDRESS);
+#if (BL_AUTH == BL_AUTH_ENABLE)
+		 if((BL_AUTH_PASSED != BL_Auth_Status) || (HOST_JUMP_ADDRESS < BL_Auth_Image_Address) ||
+		    ((HOST_JUMP_ADDRESS - BL_Auth_Image_Address) >= BL_Auth_Image_Length)){
+			 /* Only code inside the image whose signature checked fine is started */
+			 Addr_Verf = ADDRESS_NOT_VALID;
+		 }
+		 else {/*Nothing to be done */}
+#endif
 				 if(ADDRESS_VALID==Addr_Verf){
 		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
 				BL_Print_Message("Address Verfication Succedded \r\n");
 	 #endif
-				HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)&Addr_Verf, 1, HAL_MAX_DELAY);
+				BL_Transport_Send((uint8_t *)&Addr_Verf, 1);
 			 Jump_Ptr	Jump_Address = (Jump_Ptr)(HOST_JUMP_ADDRESS+1);
 		  Jump_Address();
 			 /** it is must that LSB to be 1 **/
@@ -379,7 +721,7 @@ static void handleCBL_GO_TO_ADDR_CMD(uint8_t* BL_HOST_BUFFER) {
 				 
 				 }
 		 else {
-		 		 	HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)&Addr_Verf, 1, HAL_MAX_DELAY);
+		 		 	BL_Transport_Send((uint8_t *)&Addr_Verf, 1);
 		 
 		 }
 		  }
@@ -405,6 +747,252 @@ static void handleCBL_GO_TO_ADDR_CMD(uint8_t* BL_HOST_BUFFER) {
 
 }
 
+static uint32_t Bootloader_Get_Slot_Base_Address(uint8_t Slot){
+	uint32_t Slot_Base = BL_SLOT_A_BASE_ADDRESS;
+	if(BL_SLOT_B == Slot){
+		Slot_Base = BL_SLOT_B_BASE_ADDRESS;
+	}
+	else {/*Nothing to be done */}
+	return Slot_Base;
+}
+
+static uint8_t Bootloader_Slot_Is_Valid(uint8_t Slot){
+	uint8_t  Slot_Validity = ADDRESS_NOT_VALID;
+	uint32_t Slot_Base     = Bootloader_Get_Slot_Base_Address(Slot);
+	uint32_t MSP_Value     = *((volatile uint32_t *)(Slot_Base));
+	uint32_t Reset_Handler = *((volatile uint32_t *)(Slot_Base+4));
+
+	/* Initial MSP must point into SRAM and the reset handler must be a Thumb address inside the slot */
+	if((MSP_Value > STM32F103_SRAM_BASE) && (MSP_Value <= STM32F103_SRAM_END) &&
+	   (Reset_Handler & 0x01U) &&
+	   ((Reset_Handler & ~0x01U) >= Slot_Base) && ((Reset_Handler & ~0x01U) < (Slot_Base+BL_SLOT_SIZE))){
+		Slot_Validity = ADDRESS_VALID;
+	}
+	else {/*Nothing to be done */}
+	return Slot_Validity;
+}
+
+static uint8_t Bootloader_Scan_Boot_Records(uint8_t *pSlot_States){
+	uint8_t  Selected_Slot  = BL_SLOT_NONE;
+	uint32_t Record_Address = BL_BOOT_SELECTOR_ADDRESS;
+	uint16_t Record         = 0;
+
+	pSlot_States[BL_SLOT_A] = BL_SLOT_STATE_UNKNOWN;
+	pSlot_States[BL_SLOT_B] = BL_SLOT_STATE_UNKNOWN;
+	/* Records are appended, so the scan stops at the first erased half-word.
+	   A torn record (power loss mid-program) matches no record and is skipped */
+	for(Record_Address=BL_BOOT_SELECTOR_ADDRESS;Record_Address<(BL_BOOT_SELECTOR_ADDRESS+CBL_FLASH_PAGE_SIZE);Record_Address+=2){
+		Record = *((volatile uint16_t *)Record_Address);
+		if(BL_BOOT_SELECTOR_RECORD_ERASED == Record){
+			break;
+		}
+		else if(BL_BOOT_SELECTOR_RECORD_SLOT_A == Record){
+			Selected_Slot = BL_SLOT_A;
+			pSlot_States[BL_SLOT_A] = BL_SLOT_STATE_COMPLETE;
+		}
+		else if(BL_BOOT_SELECTOR_RECORD_SLOT_B == Record){
+			Selected_Slot = BL_SLOT_B;
+			pSlot_States[BL_SLOT_B] = BL_SLOT_STATE_COMPLETE;
+		}
+		else if(BL_BOOT_SELECTOR_RECORD_OPEN_A == Record){
+			pSlot_States[BL_SLOT_A] = BL_SLOT_STATE_OPEN;
+		}
+		else if(BL_BOOT_SELECTOR_RECORD_OPEN_B == Record){
+			pSlot_States[BL_SLOT_B] = BL_SLOT_STATE_OPEN;
+		}
+		else {/*Nothing to be done */}
+	}
+	return Selected_Slot;
+}
+
+static uint8_t Bootloader_Slot_Can_Boot(uint8_t Slot, const uint8_t *pSlot_States){
+	uint8_t Slot_Validity = ADDRESS_NOT_VALID;
+#if (BL_AUTH == BL_AUTH_ENABLE)
+	/* Only a SLOT record proves that the signature of the image checked fine */
+	if(BL_SLOT_STATE_COMPLETE == pSlot_States[Slot]){
+#else
+	if(BL_SLOT_STATE_OPEN != pSlot_States[Slot]){
+#endif
+		Slot_Validity = Bootloader_Slot_Is_Valid(Slot);
+	}
+	else {/*Nothing to be done */}
+	return Slot_Validity;
+}
+
+static uint8_t Bootloader_Get_Boot_Slot(void){
+	uint8_t Slot_States[BL_SLOT_COUNT];
+	uint8_t Boot_Slot = Bootloader_Scan_Boot_Records(Slot_States);
+
+	if(BL_SLOT_NONE == Boot_Slot){
+		Boot_Slot = BL_SLOT_A;
+	}
+	else {/*Nothing to be done */}
+
+	if(ADDRESS_VALID != Bootloader_Slot_Can_Boot(Boot_Slot, Slot_States)){
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+		Boot_Slot ^= 0x01U;
+		if(ADDRESS_VALID != Bootloader_Slot_Can_Boot(Boot_Slot, Slot_States)){
+			Boot_Slot = BL_SLOT_NONE;
+		}
+		else {/*Nothing to be done */}
+#else
+		Boot_Slot = BL_SLOT_NONE;
+#endif
+	}
+	else {/*Nothing to be done */}
+	return Boot_Slot;
+}
+
+static HAL_StatusTypeDef Bootloader_Write_Boot_Record(uint16_t Record){
+	HAL_StatusTypeDef      HAL_STATUS     = HAL_ERROR;
+	FLASH_EraseInitTypeDef Init;
+	uint32_t               Page_Error     = 0;
+	uint32_t               Record_Address = BL_BOOT_SELECTOR_ADDRESS;
+	uint8_t                Slot_States[BL_SLOT_COUNT];
+	uint8_t                Selected_Slot  = BL_SLOT_NONE;
+	uint8_t                Slot           = BL_SLOT_A;
+
+	while((Record_Address < (BL_BOOT_SELECTOR_ADDRESS+CBL_FLASH_PAGE_SIZE)) &&
+	      (BL_BOOT_SELECTOR_RECORD_ERASED != *((volatile uint16_t *)Record_Address))){
+		Record_Address += 2;
+	}
+
+	HAL_STATUS = HAL_FLASH_Unlock();
+	if((HAL_OK == HAL_STATUS) && (Record_Address >= (BL_BOOT_SELECTOR_ADDRESS+CBL_FLASH_PAGE_SIZE))){
+		/* Selector page is full: recycle it, this is the only non-atomic step.
+		   The open slots and the selected slot are carried over, a slot that is
+		   complete but not selected is then known by its vector table only */
+		Selected_Slot    = Bootloader_Scan_Boot_Records(Slot_States);
+		Init.TypeErase   = FLASH_TYPEERASE_PAGES;
+		Init.PageAddress = BL_BOOT_SELECTOR_ADDRESS;
+		Init.NbPages     = 1;
+		Init.Banks       = FLASH_BANK_1;
+		HAL_STATUS       = HAL_FLASHEx_Erase(&Init,&Page_Error);
+		Record_Address   = BL_BOOT_SELECTOR_ADDRESS;
+		for(Slot=BL_SLOT_A;(Slot<BL_SLOT_COUNT) && (HAL_OK==HAL_STATUS);Slot++){
+			if(BL_SLOT_STATE_OPEN == Slot_States[Slot]){
+				HAL_STATUS = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, Record_Address, BL_BOOT_SELECTOR_RECORD_OPEN_A + Slot);
+				Record_Address += 2;
+			}
+			else {/*Nothing to be done */}
+		}
+		if((HAL_OK == HAL_STATUS) && (BL_SLOT_NONE != Selected_Slot) && (BL_SLOT_STATE_COMPLETE == Slot_States[Selected_Slot])){
+			HAL_STATUS = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, Record_Address, BL_BOOT_SELECTOR_RECORD_SLOT_A + Selected_Slot);
+			Record_Address += 2;
+		}
+		else {/*Nothing to be done */}
+	}
+	else {/*Nothing to be done */}
+
+	if(HAL_OK == HAL_STATUS){
+		HAL_STATUS = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, Record_Address, Record);
+	}
+	else {/*Nothing to be done */}
+	HAL_FLASH_Lock();
+
+	if((HAL_OK == HAL_STATUS) && (Record != *((volatile uint16_t *)Record_Address))){
+		HAL_STATUS = HAL_ERROR;
+	}
+	else {/*Nothing to be done */}
+	return HAL_STATUS;
+}
+
+static HAL_StatusTypeDef Bootloader_Open_Slot(uint8_t Slot){
+	HAL_StatusTypeDef HAL_STATUS = HAL_OK;
+	uint8_t           Slot_States[BL_SLOT_COUNT];
+
+	if(Slot != BL_Open_Slot){
+		(void)Bootloader_Scan_Boot_Records(Slot_States);
+		if(BL_SLOT_STATE_OPEN != Slot_States[Slot]){
+			HAL_STATUS = Bootloader_Write_Boot_Record(BL_BOOT_SELECTOR_RECORD_OPEN_A + Slot);
+		}
+		else {/*Nothing to be done */}
+		if(HAL_OK == HAL_STATUS){
+			BL_Open_Slot = Slot;
+		}
+		else {/*Nothing to be done */}
+	}
+	else {/*Nothing to be done */}
+	return HAL_STATUS;
+}
+
+#if (BL_DUAL_SLOT != BL_DUAL_SLOT_ENABLE)
+static void Bootloader_Close_Slot(void){
+	uint8_t Slot_States[BL_SLOT_COUNT];
+
+	(void)Bootloader_Scan_Boot_Records(Slot_States);
+	if((BL_SLOT_STATE_OPEN == Slot_States[BL_SLOT_A]) &&
+	   (HAL_OK == Bootloader_Write_Boot_Record(BL_BOOT_SELECTOR_RECORD_SLOT_A))){
+		/* The next write opens it again */
+		BL_Open_Slot = BL_SLOT_NONE;
+	}
+	else {/*Nothing to be done */}
+}
+#endif
+
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+static uint8_t Bootloader_Get_Inactive_Slot(void){
+	if(BL_SLOT_NONE == BL_Update_Slot){
+		BL_Update_Slot = BL_SLOT_A;
+		if(BL_SLOT_A == Bootloader_Get_Boot_Slot()){
+			BL_Update_Slot = BL_SLOT_B;
+		}
+		else {/*Nothing to be done */}
+	}
+	else {/*Nothing to be done */}
+	return BL_Update_Slot;
+}
+
+static uint8_t Bootloader_Slot_Range_Verfication(uint32_t Address, uint32_t Length){
+	uint8_t  Addr_Verf = ADDRESS_NOT_VALID;
+	uint32_t Slot_Base = Bootloader_Get_Slot_Base_Address(Bootloader_Get_Inactive_Slot());
+
+	/* Only the inactive slot may be modified, the running image keeps its slot */
+	if((Address >= Slot_Base) && ((Address+Length) <= (Slot_Base+BL_SLOT_SIZE))){
+		Addr_Verf = ADDRESS_VALID;
+	}
+	else {/*Nothing to be done */}
+	return Addr_Verf;
+}
+
+static void Bootloader_Mark_Pages_Erased(uint32_t Page_Number, uint32_t Nb_Pages){
+	for(;Nb_Pages>0;Nb_Pages--,Page_Number++){
+		BL_Erased_Pages_Map[Page_Number/8] |= (uint8_t)(1U << (Page_Number%8));
+	}
+}
+
+static uint8_t Bootloader_Erase_Pages_On_Demand(uint32_t Address, uint32_t Length){
+	uint8_t                Erase_Status = SUCCESSFUL_ERASE;
+	FLASH_EraseInitTypeDef Init;
+	uint32_t               Page_Error   = 0;
+	uint32_t               Page_Number  = (Address-STM32F103_FLASH_BASE)/CBL_FLASH_PAGE_SIZE;
+	uint32_t               Last_Page    = ((Address+Length-1)-STM32F103_FLASH_BASE)/CBL_FLASH_PAGE_SIZE;
+
+	/* The first write into a page of the inactive slot erases just that page,
+	   so an update never needs a full erase pass up front */
+	for(;(Page_Number<=Last_Page) && (SUCCESSFUL_ERASE==Erase_Status);Page_Number++){
+		if(0U == (BL_Erased_Pages_Map[Page_Number/8] & (1U << (Page_Number%8)))){
+			Init.TypeErase   = FLASH_TYPEERASE_PAGES;
+			Init.PageAddress = STM32F103_FLASH_BASE+(Page_Number*CBL_FLASH_PAGE_SIZE);
+			Init.NbPages     = 1;
+			Init.Banks       = FLASH_BANK_1;
+			HAL_FLASH_Unlock();
+			HAL_FLASHEx_Erase(&Init,&Page_Error);
+			HAL_FLASH_Lock();
+#if (BL_AUTH == BL_AUTH_ENABLE)
+			Bootloader_Auth_Stream_Erase(Init.PageAddress,CBL_FLASH_PAGE_SIZE);
+#endif
+			if(HAL_SUCCESSFUL_ERASE==Page_Error){
+				Bootloader_Mark_Pages_Erased(Page_Number,1);
+			}
+			else {Erase_Status=UNSUCCESSFUL_ERASE;}
+		}
+		else {/*Nothing to be done */}
+	}
+	return Erase_Status;
+}
+#endif
+
 static uint8_t Perform_Flash_Erase(uint8_t PageAddr,uint8_t Nb_Pages){
 		uint8_t Sector_Validity_Status = INVALID_SECTOR_NUMBER;
 		uint8_t Remaining_Sectors;
@@ -418,33 +1006,63 @@ static uint8_t Perform_Flash_Erase(uint8_t PageAddr,uint8_t Nb_Pages){
 	
 	}
 	else {
-		if( (PageAddr <= (CBL_MAX_PAGE_NUMBER -1)) || (CBL_Mass_ERASE == PageAddr)	) {
+		if( ((PageAddr >= CBL_BOOTLOADER_PAGES) && (PageAddr <= (CBL_MAX_PAGE_NUMBER -1))) || (CBL_Mass_ERASE == PageAddr)	) {
 				if(CBL_Mass_ERASE == PageAddr){
-				Init.TypeErase=FLASH_TYPEERASE_MASSERASE;
+					/* A real mass erase would wipe the running bootloader: erase the application area instead */
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+					PageAddr = (uint8_t)((Bootloader_Get_Slot_Base_Address(Bootloader_Get_Inactive_Slot())-STM32F103_FLASH_BASE)/CBL_FLASH_PAGE_SIZE);
+					Nb_Pages = BL_SLOT_SIZE/CBL_FLASH_PAGE_SIZE;
+#else
+					PageAddr = CBL_BOOTLOADER_PAGES;
+					Nb_Pages = CBL_MAX_PAGE_NUMBER-CBL_BOOTLOADER_PAGES;
+#endif
 				}
 					else {
 						Remaining_Sectors=CBL_MAX_PAGE_NUMBER-PageAddr;
-						if(CBL_MAX_PAGE_NUMBER<Nb_Pages) {
+						if(Remaining_Sectors<Nb_Pages) {
 							Nb_Pages=Remaining_Sectors;
 						}
 						else {/*Nothing to be done */}
+					}
 							Init.TypeErase   = FLASH_TYPEERASE_PAGES;
-							Init.PageAddress = PageAddr;
+							Init.PageAddress = STM32F103_FLASH_BASE+((uint32_t)PageAddr*CBL_FLASH_PAGE_SIZE);
 							Init.NbPages     = Nb_Pages;
-					}
 							Init.Banks=FLASH_BANK_1;
-					
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+				if(ADDRESS_VALID != Bootloader_Slot_Range_Verfication(Init.PageAddress,Init.NbPages*CBL_FLASH_PAGE_SIZE)){
+					/* Never erase the slot holding the running image */
+					Sector_Validity_Status=INVALID_SECTOR_NUMBER;
+				}
+				else if(HAL_OK != Bootloader_Open_Slot(Bootloader_Get_Inactive_Slot())){
+					Sector_Validity_Status=UNSUCCESSFUL_ERASE;
+				}
+				else
+#else
+				if(HAL_OK != Bootloader_Open_Slot(BL_SLOT_A)){
+					/* Without its OPEN record a half erased image could still be started */
+					Sector_Validity_Status=UNSUCCESSFUL_ERASE;
+				}
+				else
+#endif
+				{
 					/*UNLOCK THE FLASH CONTROL REGISTER SECTORS */
 				HAL_STATUS=HAL_FLASH_Unlock();
 					HAL_STATUS	= HAL_FLASHEx_Erase(/*POINTER TO ERASING CONFIGURATION*/ &Init,&Sector_Error);
 						if(HAL_SUCCESSFUL_ERASE==Sector_Error){
 							Sector_Validity_Status=SUCCESSFUL_ERASE;
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+							Bootloader_Mark_Pages_Erased(PageAddr,Nb_Pages);
+#endif
 						}
 						else {Sector_Validity_Status=UNSUCCESSFUL_ERASE;}
 
 							/*LOCK THE FLASH CONTROL REGISTER SECTORS */
 							HAL_STATUS=HAL_FLASH_Lock();
-		
+#if (BL_AUTH == BL_AUTH_ENABLE)
+							Bootloader_Auth_Stream_Erase(Init.PageAddress,Init.NbPages*CBL_FLASH_PAGE_SIZE);
+#endif
+				}
+
 		}
 							
 					
@@ -484,17 +1102,21 @@ static void handleCBL_FLASH_ERASE_CMD(uint8_t* BL_HOST_BUFFER) {
 	 BL_Print_Message("CRC Verifcation Passsed \r\n");
 	 #endif
 	BL_Send_ACK(1);
+		 /* Sequence numbers restart with every transfer, which always erases first */
+		 BL_Seq_Count = 0;
+		 memset(BL_Bcast_Map, 0, BL_BCAST_MAP_SIZE);
+		 BL_Bcast_Received = 0;
 		 
 		 Erase_Status = Perform_Flash_Erase(BL_HOST_BUFFER[2],BL_HOST_BUFFER[3]);
 
 		 if(SUCCESSFUL_ERASE==Erase_Status) /*Success*/ {
-			 	HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)&Erase_Status, 1, HAL_MAX_DELAY);
+			 	BL_Transport_Send((uint8_t *)&Erase_Status, 1);
 		 #if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
 					BL_Print_Message("Erasing Done Successfully \r\n");
 			#endif
 		 }
 		 else /*Failure*/ {
-			  	HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)&Erase_Status, 1, HAL_MAX_DELAY);
+			  	BL_Transport_Send((uint8_t *)&Erase_Status, 1);
 		 
 		 }
 	 
@@ -510,10 +1132,161 @@ static void handleCBL_FLASH_ERASE_CMD(uint8_t* BL_HOST_BUFFER) {
 
 		
 
-static uint8_t FLASH_MEM_WRITE_PAYLOAD(uint8_t* HOST_PAYLOAD,uint32_t PAYLOAD_START_ADDR, uint16_t PAYLOAD_LENGTH) {
+static void FLASH_Stream_Put(BL_Flash_Stream_t *pStream, uint8_t Data_Byte) {
+	if(pStream->Address & 0x01U){
+		if(0U == pStream->Pending){
+			/* Low byte was skipped and stays erased */
+			pStream->HalfWord = 0x00FFU;
+		}
+		else {/*Nothing to be done */}
+		pStream->HalfWord |= (uint16_t)((uint16_t)Data_Byte << 8);
+		if(HAL_OK == pStream->Status){
+			pStream->Status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, pStream->Address-1, pStream->HalfWord);
+		}
+		else {/*Nothing to be done */}
+		pStream->Pending = 0;
+	}
+	else {
+		pStream->HalfWord = Data_Byte;
+		pStream->Pending  = 1;
+	}
+	pStream->Address++;
+}
+
+static void FLASH_Stream_Flush(BL_Flash_Stream_t *pStream) {
+	/* The F1 flash programs half-words only; a lone low byte is paired with the erased value */
+	if(0U != pStream->Pending){
+		pStream->HalfWord |= 0xFF00U;
+		if(HAL_OK == pStream->Status){
+			pStream->Status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, pStream->Address-1, pStream->HalfWord);
+		}
+		else {/*Nothing to be done */}
+		pStream->Pending = 0;
+	}
+	else {/*Nothing to be done */}
+}
+
+static void FLASH_Stream_Skip(BL_Flash_Stream_t *pStream, uint32_t Length) {
+	if((0U != pStream->Pending) && (0U != Length)){
+		/* Complete the pending half-word, it cannot be programmed a second time */
+		FLASH_Stream_Put(pStream, 0xFFU);
+		Length--;
+	}
+	else {/*Nothing to be done */}
+	/* Erased flash already reads 0xFF, nothing to program */
+	pStream->Address += Length;
+}
+
+static uint8_t Bootloader_RLE_Decoded_Length(uint8_t *pPayload, uint16_t Payload_Len, uint32_t *pDecoded_Len) {
+	uint8_t  Decode_Status = RLE_DECODE_PASSED;
+	uint16_t Payload_Index = 0;
+	uint8_t  Token         = 0;
+
+	*pDecoded_Len = 0;
+	while((Payload_Index < Payload_Len) && (RLE_DECODE_PASSED == Decode_Status)){
+		Token = pPayload[Payload_Index++];
+		if(RLE_TOKEN_LITERAL == (Token & RLE_TOKEN_TYPE_MASK_LITERAL)){
+			*pDecoded_Len += (uint32_t)Token + 1;
+			Payload_Index += (uint16_t)Token + 1;
+		}
+		else if(Payload_Index < Payload_Len){
+			*pDecoded_Len += ((((uint32_t)Token & RLE_TOKEN_RUN_MASK) << 8) | pPayload[Payload_Index]) + 1;
+			Payload_Index += (RLE_TOKEN_FILL == (Token & RLE_TOKEN_TYPE_MASK_RUN)) ? 2 : 1;
+		}
+		else {
+			Decode_Status = RLE_DECODE_FAILED;
+		}
+	}
+	if(Payload_Index != Payload_Len){
+		/* A token ran past the end of the frame */
+		Decode_Status = RLE_DECODE_FAILED;
+	}
+	else {/*Nothing to be done */}
+	return Decode_Status;
+}
+
+static void Bootloader_LZ_Put_Byte(BL_Flash_Stream_t *pStream, uint8_t Data_Byte) {
+	FLASH_Stream_Put(pStream, Data_Byte);
+	BL_LZ_Window[BL_LZ_Window_Pos] = Data_Byte;
+	BL_LZ_Window_Pos++; /* wraps at BL_LZ_WINDOW_SIZE */
+	if(BL_LZ_History < BL_LZ_WINDOW_SIZE){
+		BL_LZ_History++;
+	}
+	else {/*Nothing to be done */}
+}
+
+static uint8_t Bootloader_LZ_Decoded_Length(uint8_t *pInput, uint16_t Input_Len, uint16_t *pOutput_Len) {
+	uint8_t  Decode_Status = LZ_DECODE_PASSED;
+	uint16_t Input_Index   = 0;
+	uint16_t Run_Length    = 0;
+	uint16_t Distance      = 0;
+	uint8_t  Token         = 0;
+
+	*pOutput_Len = 0;
+	while((Input_Index < Input_Len) && (LZ_DECODE_PASSED == Decode_Status)){
+		Token = pInput[Input_Index++];
+		if(Token < LZ_TOKEN_MATCH_FLAG){
+			/* Literal run: (Token+1) bytes copied from the frame */
+			Run_Length = (uint16_t)Token + 1;
+			if((Input_Index+Run_Length) > Input_Len){
+				Decode_Status = LZ_DECODE_FAILED;
+			}
+			else {
+				Input_Index += Run_Length;
+			}
+		}
+		else if(Input_Index < Input_Len){
+			/* Match: the window holds the earlier frames of the stream and what this one decoded so far */
+			Run_Length = (uint16_t)(Token & ~LZ_TOKEN_MATCH_FLAG) + LZ_MIN_MATCH_LENGTH;
+			Distance = (uint16_t)pInput[Input_Index++] + 1;
+			if(Distance > (BL_LZ_History + *pOutput_Len)){
+				Decode_Status = LZ_DECODE_FAILED;
+			}
+			else {/*Nothing to be done */}
+		}
+		else {
+			Decode_Status = LZ_DECODE_FAILED;
+		}
+		*pOutput_Len += Run_Length;
+		if(*pOutput_Len > BL_LZ_MAX_FRAME_OUTPUT){
+			Decode_Status = LZ_DECODE_FAILED;
+		}
+		else {/*Nothing to be done */}
+	}
+	return Decode_Status;
+}
+
+static void Bootloader_LZ_Decode(BL_Flash_Stream_t *pStream, uint8_t *pInput, uint16_t Input_Len) {
+	uint16_t Input_Index   = 0;
+	uint16_t Run_Length    = 0;
+	uint8_t  Distance      = 0;
+	uint8_t  Token         = 0;
+
+	/* The frame was checked by Bootloader_LZ_Decoded_Length, each byte goes to the flash as it is decoded */
+	while((Input_Index < Input_Len) && (HAL_OK == pStream->Status)){
+		Token = pInput[Input_Index++];
+		if(Token < LZ_TOKEN_MATCH_FLAG){
+			for(Run_Length=(uint16_t)Token+1;Run_Length>0;Run_Length--){
+				Bootloader_LZ_Put_Byte(pStream, pInput[Input_Index++]);
+			}
+		}
+		else {
+			/* Overlapping copies allowed, a byte put is read back by the next ones */
+			Distance = (uint8_t)(pInput[Input_Index++] + 1U);
+			for(Run_Length=(uint16_t)(Token & ~LZ_TOKEN_MATCH_FLAG) + LZ_MIN_MATCH_LENGTH;Run_Length>0;Run_Length--){
+				Bootloader_LZ_Put_Byte(pStream, BL_LZ_Window[(uint8_t)(BL_LZ_Window_Pos-Distance)]);
+			}
+		}
+	}
+}
+
+static uint8_t FLASH_MEM_WRITE_PAYLOAD(uint8_t* HOST_PAYLOAD,uint32_t PAYLOAD_START_ADDR, uint16_t PAYLOAD_LENGTH, uint8_t PAYLOAD_ENCODING) {
 	
 	HAL_StatusTypeDef HAL_STATUS       = HAL_ERROR;
 	uint16_t  Payload_Counter    ;
+	uint32_t  Run_Length         ;
+	uint8_t   Token              ;
+	BL_Flash_Stream_t Flash_Stream;
 	uint8_t FLASH_PAYLOAD_WRITE_STATUS = FLASH_PAYLOAD_WRITE_FAILED;
 	/*UNLOCK FLASH MEMORY*/
 	HAL_STATUS=HAL_FLASH_Unlock();
@@ -522,37 +1295,107 @@ static uint8_t FLASH_MEM_WRITE_PAYLOAD(uint8_t* HOST_PAYLOAD,uint32_t PAYLOAD_ST
 			
 	}
 	else {
-	for(Payload_Counter=0;Payload_Counter<PAYLOAD_LENGTH;Payload_Counter++){
-	HAL_STATUS=HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, PAYLOAD_START_ADDR+Payload_Counter, HOST_PAYLOAD[Payload_Counter]);
+		Flash_Stream.Address  = PAYLOAD_START_ADDR;
+		Flash_Stream.HalfWord = 0;
+		Flash_Stream.Pending  = 0;
+		Flash_Stream.Status   = HAL_OK;
+		if(FLASH_PAYLOAD_ENCODING_RLE == PAYLOAD_ENCODING){
+			/* Run-length records are decoded inline; the frame was checked by Bootloader_RLE_Decoded_Length */
+			for(Payload_Counter=0;(Payload_Counter<PAYLOAD_LENGTH) && (HAL_OK==Flash_Stream.Status);){
+				Token = HOST_PAYLOAD[Payload_Counter++];
+				if(RLE_TOKEN_LITERAL == (Token & RLE_TOKEN_TYPE_MASK_LITERAL)){
+					for(Run_Length=(uint32_t)Token+1;Run_Length>0;Run_Length--){
+						FLASH_Stream_Put(&Flash_Stream, HOST_PAYLOAD[Payload_Counter++]);
+					}
+				}
+				else {
+					Run_Length = ((((uint32_t)Token & RLE_TOKEN_RUN_MASK) << 8) | HOST_PAYLOAD[Payload_Counter++]) + 1;
+					if(RLE_TOKEN_SKIP == (Token & RLE_TOKEN_TYPE_MASK_RUN)){
+						FLASH_Stream_Skip(&Flash_Stream, Run_Length);
+					}
+					else {
+						for(;Run_Length>0;Run_Length--){
+							FLASH_Stream_Put(&Flash_Stream, HOST_PAYLOAD[Payload_Counter]);
+						}
+						Payload_Counter++;
+					}
+				}
+			}
+		}
+		else if(FLASH_PAYLOAD_ENCODING_LZ == PAYLOAD_ENCODING){
+			Bootloader_LZ_Decode(&Flash_Stream, HOST_PAYLOAD, PAYLOAD_LENGTH);
+		}
+		else {
+			for(Payload_Counter=0;Payload_Counter<PAYLOAD_LENGTH;Payload_Counter++){
+				FLASH_Stream_Put(&Flash_Stream, HOST_PAYLOAD[Payload_Counter]);
+			}
+		}
+		FLASH_Stream_Flush(&Flash_Stream);
+		HAL_STATUS = Flash_Stream.Status;
 		if(HAL_STATUS != HAL_OK){
 				FLASH_PAYLOAD_WRITE_STATUS = FLASH_PAYLOAD_WRITE_FAILED;
-			break;
-	}
+		}
 		else{
 		FLASH_PAYLOAD_WRITE_STATUS=FLASH_PAYLOAD_WRITE_PASSED;
 		}
-}
-	
   
 }
-	if(FLASH_PAYLOAD_WRITE_PASSED==FLASH_PAYLOAD_WRITE_STATUS&&HAL_OK==HAL_STATUS)
-	{/*LOCK FLASH MEMORY*/
+	{/*LOCK FLASH MEMORY, also after a failed program */
 	HAL_STATUS=HAL_FLASH_Lock();
 		if(HAL_STATUS != HAL_OK){
 				FLASH_PAYLOAD_WRITE_STATUS = FLASH_PAYLOAD_WRITE_FAILED;
-			
+
 	}
-		else {FLASH_PAYLOAD_WRITE_STATUS=FLASH_PAYLOAD_WRITE_PASSED;}
+		else {/*Keep the programming status */}
 	}
 	return FLASH_PAYLOAD_WRITE_STATUS;
 }	
+
+static uint8_t Bootloader_Write_Host_Data(uint8_t* pData, uint16_t Payload_Len, uint32_t Host_Address, uint32_t Output_Len, uint8_t Payload_Encoding) {
+	uint8_t Addr_Verf                  = ADDRESS_NOT_VALID;
+	uint8_t FLASH_PAYLOAD_WRITE_STATUS = FLASH_PAYLOAD_WRITE_FAILED;
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+	Addr_Verf= Bootloader_Slot_Range_Verfication(Host_Address,Output_Len);
+	if((ADDRESS_VALID==Addr_Verf) &&
+	   ((HAL_OK!=Bootloader_Open_Slot(Bootloader_Get_Inactive_Slot())) ||
+	    (SUCCESSFUL_ERASE!=Bootloader_Erase_Pages_On_Demand(Host_Address,Output_Len)))){
+		Addr_Verf = ADDRESS_NOT_VALID;
+	}
+	else {/*Nothing to be done */}
+#else
+	Addr_Verf= Recieved_Address_Verfication(Host_Address);
+	if((ADDRESS_VALID==Addr_Verf) && (0U!=Output_Len)){
+		Addr_Verf= Recieved_Address_Verfication(Host_Address+Output_Len-1);
+	}
+	else {/*Nothing to be done */}
+	if((ADDRESS_VALID==Addr_Verf) && (Host_Address >= STM32F103_FLASH_BASE) && (Host_Address <= STM32F103_FLASH_END)){
+		if(Host_Address < APP_BASE_ADDREESS){
+			/* The bootloader and its boot selector page are not the host's to write */
+			Addr_Verf = ADDRESS_NOT_VALID;
+		}
+		else if(HAL_OK != Bootloader_Open_Slot(BL_SLOT_A)){
+			Addr_Verf = ADDRESS_NOT_VALID;
+		}
+		else {/*Nothing to be done */}
+	}
+	else {/*RAM is written as before */}
+#endif
+	if(ADDRESS_VALID==Addr_Verf){
+		FLASH_PAYLOAD_WRITE_STATUS= FLASH_MEM_WRITE_PAYLOAD(pData,Host_Address,Payload_Len,Payload_Encoding);
+#if (BL_AUTH == BL_AUTH_ENABLE)
+		Bootloader_Auth_Stream_Write(Host_Address,Output_Len,FLASH_PAYLOAD_WRITE_STATUS);
+#endif
+	}
+	else {/*ADDRESS_NOT_VALID and FLASH_PAYLOAD_WRITE_FAILED share the same value */}
+	return FLASH_PAYLOAD_WRITE_STATUS;
+}
+
 static void handleCBL_MEM_WRITE_CMD(uint8_t* BL_HOST_BUFFER) {
     // Implementation for CBL_MEM_WRITE_CMD
     uint16_t  Host_CMD_Packet_Len   =0;
 	  uint32_t  Host_CRC32            =0;
 		uint32_t  Host_Address          =0;
 		 uint8_t   Payload_Len           =0;
-		 uint8_t   Addr_Verf            =ADDRESS_NOT_VALID;
 		uint8_t FLASH_PAYLOAD_WRITE_STATUS = FLASH_PAYLOAD_WRITE_FAILED;
 	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
 		BL_Print_Message("CBL_FLASH_ERASE_CMD reached.\r\n");
@@ -571,20 +1414,8 @@ static void handleCBL_MEM_WRITE_CMD(uint8_t* BL_HOST_BUFFER) {
 	
 		 Host_Address = *((uint32_t*)(&BL_HOST_BUFFER[2])); /*count 4 byte from position 2 in array which is the address */
 		 Payload_Len  = BL_HOST_BUFFER[6];
- Addr_Verf= Recieved_Address_Verfication(Host_Address);
-		 if(ADDRESS_VALID==Addr_Verf){
-		 FLASH_PAYLOAD_WRITE_STATUS= FLASH_MEM_WRITE_PAYLOAD((uint8_t*)&BL_HOST_BUFFER[7],Host_Address,Payload_Len);
-		 if(FLASH_PAYLOAD_WRITE_FAILED==FLASH_PAYLOAD_WRITE_STATUS){
-		  HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)&FLASH_PAYLOAD_WRITE_STATUS, 1, HAL_MAX_DELAY);
-		 }
-			/*problem*/
-		 
-			 else/*passed*/{ 
-			 HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)&FLASH_PAYLOAD_WRITE_STATUS, 1, HAL_MAX_DELAY);}
-		 }
-		 else/*problem*/{
-		 HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)&Addr_Verf, 1, HAL_MAX_DELAY);
-		 }
+		 FLASH_PAYLOAD_WRITE_STATUS = Bootloader_Write_Host_Data((uint8_t*)&BL_HOST_BUFFER[7],Payload_Len,Host_Address,Payload_Len,FLASH_PAYLOAD_ENCODING_RAW);
+		 BL_Transport_Send((uint8_t *)&FLASH_PAYLOAD_WRITE_STATUS, 1);
 	 }
 	 
 	 else {
@@ -595,6 +1426,552 @@ static void handleCBL_MEM_WRITE_CMD(uint8_t* BL_HOST_BUFFER) {
 	 }
 		}
 	
+static void handleCBL_MEM_WRITE_LZ_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint32_t  Host_Address          =0;
+	uint8_t   Payload_Len           =0;
+	uint16_t  Output_Len            =0;
+	uint8_t   FLASH_PAYLOAD_WRITE_STATUS = FLASH_PAYLOAD_WRITE_FAILED;
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_MEM_WRITE_LZ_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		BL_Send_ACK(1);
+		Host_Address = *((uint32_t*)(&BL_HOST_BUFFER[2]));
+		Payload_Len  = BL_HOST_BUFFER[6];
+		/* A frame continuing the previous output keeps the window, any other address starts a new stream */
+		if(Host_Address != BL_LZ_Next_Address){
+			BL_LZ_History = 0;
+		}
+		else {/*Nothing to be done */}
+		if(LZ_DECODE_PASSED == Bootloader_LZ_Decoded_Length(&BL_HOST_BUFFER[7], Payload_Len, &Output_Len)){
+			FLASH_PAYLOAD_WRITE_STATUS = Bootloader_Write_Host_Data(&BL_HOST_BUFFER[7], Payload_Len, Host_Address, Output_Len, FLASH_PAYLOAD_ENCODING_LZ);
+		}
+		else {/*Nothing to be done */}
+		if(FLASH_PAYLOAD_WRITE_PASSED == FLASH_PAYLOAD_WRITE_STATUS){
+			BL_LZ_Next_Address = Host_Address + Output_Len;
+		}
+		else {
+			/* The window no longer matches flash: the host has to restart the stream */
+			BL_LZ_Next_Address = 0;
+		}
+		BL_Transport_Send(&FLASH_PAYLOAD_WRITE_STATUS, 1);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
+
+static void handleCBL_MEM_WRITE_RLE_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint32_t  Host_Address          =0;
+	uint8_t   Payload_Len           =0;
+	uint32_t  Output_Len            =0;
+	uint8_t   FLASH_PAYLOAD_WRITE_STATUS = FLASH_PAYLOAD_WRITE_FAILED;
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_MEM_WRITE_RLE_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		BL_Send_ACK(1);
+		Host_Address = *((uint32_t*)(&BL_HOST_BUFFER[2]));
+		Payload_Len  = BL_HOST_BUFFER[6];
+		/* The decoded span is range checked (and erased in dual-slot mode) before anything is programmed */
+		if(RLE_DECODE_PASSED == Bootloader_RLE_Decoded_Length(&BL_HOST_BUFFER[7], Payload_Len, &Output_Len)){
+			FLASH_PAYLOAD_WRITE_STATUS = Bootloader_Write_Host_Data(&BL_HOST_BUFFER[7], Payload_Len, Host_Address, Output_Len, FLASH_PAYLOAD_ENCODING_RLE);
+		}
+		else {/*Nothing to be done */}
+		BL_Transport_Send(&FLASH_PAYLOAD_WRITE_STATUS, 1);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
+
+static uint8_t Bootloader_Seq_Lookup(uint16_t Sequence_Number, uint8_t *pStatus) {
+	uint8_t Seq_Found = BL_SEQ_NOT_FOUND;
+	uint8_t Seq_Index = 0;
+	for(Seq_Index=0;(Seq_Index<BL_Seq_Count) && (BL_SEQ_NOT_FOUND==Seq_Found);Seq_Index++){
+		if(BL_Seq_Numbers[Seq_Index] == Sequence_Number){
+			*pStatus  = BL_Seq_Status[Seq_Index];
+			Seq_Found = BL_SEQ_FOUND;
+		}
+		else {/*Nothing to be done */}
+	}
+	return Seq_Found;
+}
+
+static void Bootloader_Seq_Record(uint16_t Sequence_Number, uint8_t Status) {
+	if(0U == BL_Seq_Count){
+		BL_Seq_Next = 0;
+	}
+	else {/*Nothing to be done */}
+	BL_Seq_Numbers[BL_Seq_Next] = Sequence_Number;
+	BL_Seq_Status[BL_Seq_Next]  = Status;
+	BL_Seq_Next = (uint8_t)((BL_Seq_Next + 1U) % BL_SEQ_HISTORY_SIZE);
+	if(BL_Seq_Count < BL_SEQ_HISTORY_SIZE){
+		BL_Seq_Count++;
+	}
+	else {/*Nothing to be done */}
+}
+
+static void handleCBL_MEM_WRITE_SEQ_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint32_t  Host_Address          =0;
+	uint8_t   Payload_Len           =0;
+	uint16_t  Sequence_Number       =0;
+	uint8_t   Seq_Reply[BL_SEQ_REPLY_SIZE] = {FLASH_PAYLOAD_WRITE_FAILED};
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_MEM_WRITE_SEQ_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+	/* Taken before the CRC check: a NACK names the frame even when the number itself is damaged, the host ignores unknown ones */
+	Sequence_Number = (uint16_t)BL_HOST_BUFFER[2] | ((uint16_t)BL_HOST_BUFFER[3] << 8);
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		BL_Send_ACK(BL_SEQ_REPLY_SIZE);
+		if(BL_SEQ_NOT_FOUND == Bootloader_Seq_Lookup(Sequence_Number, &Seq_Reply[0])){
+			Host_Address = *((uint32_t*)(&BL_HOST_BUFFER[4]));
+			Payload_Len  = BL_HOST_BUFFER[8];
+			if((BL_SEQ_HEADER_SIZE + Payload_Len + CRC_TYPE_SIZE) == Host_CMD_Packet_Len){
+				Seq_Reply[0] = Bootloader_Write_Host_Data(&BL_HOST_BUFFER[BL_SEQ_HEADER_SIZE],Payload_Len,Host_Address,Payload_Len,FLASH_PAYLOAD_ENCODING_RAW);
+			}
+			else {/*Nothing to be done */}
+			Bootloader_Seq_Record(Sequence_Number, Seq_Reply[0]);
+			if(FLASH_PAYLOAD_WRITE_PASSED == Seq_Reply[0]){
+				Bootloader_Bcast_Record(Sequence_Number);
+			}
+			else {/*Nothing to be done */}
+		}
+		else {
+			#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+			BL_Print_Message("Frame sent again, not programmed \r\n");
+			#endif
+		}
+		Seq_Reply[1] = (uint8_t)Sequence_Number;
+		Seq_Reply[2] = (uint8_t)(Sequence_Number >> 8);
+		BL_Transport_Send(Seq_Reply, BL_SEQ_REPLY_SIZE);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_Seq_NACK(Sequence_Number);
+	}
+}
+
+static void Bootloader_Bcast_Record(uint16_t Sequence_Number) {
+	uint8_t Bit_Mask = (uint8_t)(1U << (Sequence_Number % 8U));
+	if((Sequence_Number < BL_BCAST_MAX_FRAMES) && (0U == (BL_Bcast_Map[Sequence_Number / 8U] & Bit_Mask))){
+		BL_Bcast_Map[Sequence_Number / 8U] |= Bit_Mask;
+		BL_Bcast_Received++;
+	}
+	else {/*Nothing to be done */}
+}
+
+uint16_t BL_Get_Node_Address(void) {
+	uint32_t Unique_ID = *((volatile uint32_t *)(UID_BASE)) ^ *((volatile uint32_t *)(UID_BASE + 4U)) ^
+	                     *((volatile uint32_t *)(UID_BASE + 8U));
+	uint16_t Node_Address = (uint16_t)(Unique_ID ^ (Unique_ID >> 16));
+	if((BL_NODE_ANY == Node_Address) || (BL_NODE_BROADCAST == Node_Address)){
+		Node_Address = 0x0001U;
+	}
+	else {/*Nothing to be done */}
+	return Node_Address;
+}
+
+static void handleCBL_NODE_SELECT_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint16_t  Host_Node_Address     =0;
+	uint16_t  Node_Address          =BL_Get_Node_Address();
+	uint8_t   Node_Reply[BL_NODE_REPLY_SIZE] = {BL_NODE_SELECTED};
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_NODE_SELECT_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		Host_Node_Address = (uint16_t)BL_HOST_BUFFER[2] | ((uint16_t)BL_HOST_BUFFER[3] << 8);
+		if(BL_NODE_ANY == Host_Node_Address){
+			/* Only a node that talks anyway answers, the state stays */
+		}
+		else if(BL_NODE_BROADCAST == Host_Node_Address){
+			BL_Node_State = BL_NODE_STATE_BROADCAST;
+		}
+		else if(Node_Address == Host_Node_Address){
+			BL_Node_State = BL_NODE_STATE_SELECTED;
+		}
+		else {
+			BL_Node_State = BL_NODE_STATE_UNSELECTED;
+		}
+		if((BL_NODE_STATE_ALL == BL_Node_State) || (BL_NODE_STATE_SELECTED == BL_Node_State)){
+			BL_Transport_Set_Quiet(BL_TRANSPORT_TALK);
+		}
+		else {
+			BL_Transport_Set_Quiet(BL_TRANSPORT_QUIET);
+		}
+		BL_Send_ACK(BL_NODE_REPLY_SIZE);
+		Node_Reply[1] = (uint8_t)Node_Address;
+		Node_Reply[2] = (uint8_t)(Node_Address >> 8);
+		BL_Transport_Send(Node_Reply, BL_NODE_REPLY_SIZE);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
+
+static void handleCBL_BCAST_STATUS_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint8_t   Received_Count[2]     ={0};
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_BCAST_STATUS_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		BL_Send_ACK(BL_BCAST_STATUS_SIZE);
+		Received_Count[0] = (uint8_t)BL_Bcast_Received;
+		Received_Count[1] = (uint8_t)(BL_Bcast_Received >> 8);
+		BL_Transport_Send(Received_Count, 2);
+		BL_Transport_Send(BL_Bcast_Map, BL_BCAST_MAP_SIZE);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
+
+static uint8_t Bootloader_Segment_Range_Verfication(uint32_t Segment_Address, uint32_t Segment_Length) {
+	uint8_t Addr_Verf = ADDRESS_NOT_VALID;
+	if((Segment_Address >= STM32F103_FLASH_BASE) && (Segment_Address < STM32F103_FLASH_END) &&
+	   (Segment_Length <= (STM32F103_FLASH_END - Segment_Address))){
+		Addr_Verf = ADDRESS_VALID;
+	}
+	else {
+		Addr_Verf = ADDRESS_NOT_VALID;
+	}
+	return Addr_Verf;
+}
+
+static void handleCBL_VERIFY_SEGMENTS_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint8_t   Segment_Count         =0;
+	uint8_t   Segment_Index         =0;
+	uint8_t  *pSegment              =NULL;
+	uint32_t  Segment_Address       =0;
+	uint32_t  Segment_Length        =0;
+	uint32_t  Session_CRC32         =0xFFFFFFFFU; /* CRC unit reset value */
+	uint32_t  Data_Buffer           =0;
+	uint8_t   Verify_Reply[5]       ={SEGMENT_CRC_FAILED};
+#if ((BL_DUAL_SLOT != BL_DUAL_SLOT_ENABLE) && (BL_AUTH != BL_AUTH_ENABLE))
+	uint8_t   Covers_Vector_Table   =0;
+#endif
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_VERIFY_SEGMENTS_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		BL_Send_ACK(5);
+		Segment_Count = BL_HOST_BUFFER[2];
+		if((0U != Segment_Count) && (Segment_Count <= BL_MAX_SEGMENTS) &&
+		   (Host_CMD_Packet_Len == (3 + (Segment_Count*BL_SEGMENT_DESCRIPTOR_SIZE) + CRC_TYPE_SIZE + CRC_TYPE_SIZE))){
+			Verify_Reply[0] = SEGMENT_CRC_PASSED;
+			/* The CRC unit was left reset by the frame check above */
+			for(Segment_Index=0;(Segment_Index<Segment_Count) && (SEGMENT_CRC_PASSED==Verify_Reply[0]);Segment_Index++){
+				pSegment        = &BL_HOST_BUFFER[3 + (Segment_Index*BL_SEGMENT_DESCRIPTOR_SIZE)];
+				Segment_Address = *((uint32_t*)&pSegment[0]);
+				Segment_Length  = *((uint32_t*)&pSegment[4]);
+#if ((BL_DUAL_SLOT != BL_DUAL_SLOT_ENABLE) && (BL_AUTH != BL_AUTH_ENABLE))
+				if((BL_SLOT_A_BASE_ADDRESS == Segment_Address) && (0U != Segment_Length)){
+					Covers_Vector_Table = 1;
+				}
+				else {/*Nothing to be done */}
+#endif
+				if(ADDRESS_VALID == Bootloader_Segment_Range_Verfication(Segment_Address, Segment_Length)){
+					/* Same byte per word feeding as the frame CRC, so the host reuses Calculate_CRC32 */
+					for(;Segment_Length>0;Segment_Length--){
+						Data_Buffer   = *((volatile uint8_t*)Segment_Address++);
+						Session_CRC32 = HAL_CRC_Accumulate(CRC_Engine_Obj, &Data_Buffer, 1);
+					}
+				}
+				else {
+					Verify_Reply[0] = SEGMENT_CRC_FAILED;
+				}
+			}
+			__HAL_CRC_DR_RESET(CRC_Engine_Obj);
+			if((SEGMENT_CRC_PASSED == Verify_Reply[0]) &&
+			   (Session_CRC32 != *((uint32_t*)&BL_HOST_BUFFER[3 + (Segment_Count*BL_SEGMENT_DESCRIPTOR_SIZE)]))){
+				Verify_Reply[0] = SEGMENT_CRC_FAILED;
+			}
+			else {/*Nothing to be done */}
+#if ((BL_DUAL_SLOT != BL_DUAL_SLOT_ENABLE) && (BL_AUTH != BL_AUTH_ENABLE))
+			if((SEGMENT_CRC_PASSED == Verify_Reply[0]) && (0U != Covers_Vector_Table)){
+				/* The host read back the whole image it wrote: from now on it may be started */
+				Bootloader_Close_Slot();
+			}
+			else {/*Nothing to be done */}
+#endif
+		}
+		else {/*Nothing to be done */}
+		Verify_Reply[1] = (uint8_t)(Session_CRC32);
+		Verify_Reply[2] = (uint8_t)(Session_CRC32 >> 8);
+		Verify_Reply[3] = (uint8_t)(Session_CRC32 >> 16);
+		Verify_Reply[4] = (uint8_t)(Session_CRC32 >> 24);
+		BL_Transport_Send(Verify_Reply, 5);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
+
+#if (BL_AUTH == BL_AUTH_ENABLE)
+static uint32_t Bootloader_Cycle_Count(void) {
+	if(0U == (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)){
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CYCCNT = 0;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+	else {/*Nothing to be done */}
+	return DWT->CYCCNT;
+}
+
+static void Bootloader_Auth_Hash_Flash(BL_SHA256_Context_t *pContext, uint32_t Address, uint32_t Length) {
+	uint32_t Start_Cycles = Bootloader_Cycle_Count();
+	BL_SHA256_Update(pContext, (const uint8_t *)Address, Length);
+	BL_Auth_Hash_Cycles += Bootloader_Cycle_Count() - Start_Cycles;
+}
+
+static void Bootloader_Auth_Stream_Write(uint32_t Address, uint32_t Length, uint8_t Write_Status) {
+	if((Address < STM32F103_FLASH_BASE) || (Address >= STM32F103_FLASH_END) || (0U == Length)){
+		/* RAM holds nothing a signature covers */
+	}
+	else if(FLASH_PAYLOAD_WRITE_PASSED != Write_Status){
+		BL_Auth_Status = BL_AUTH_FAILED;
+		BL_Auth_Stream_State = BL_AUTH_STREAM_BROKEN;
+	}
+	else {
+		BL_Auth_Status = BL_AUTH_FAILED;
+		if(BL_AUTH_STREAM_EMPTY == BL_Auth_Stream_State){
+			BL_SHA256_Init(&BL_Auth_Stream);
+			BL_Auth_Stream_Start = Address;
+			BL_Auth_Stream_End = Address;
+			BL_Auth_Hash_Cycles = 0;
+			BL_Auth_Stream_State = BL_AUTH_STREAM_VALID;
+		}
+		else {/*Nothing to be done */}
+		if((BL_AUTH_STREAM_VALID == BL_Auth_Stream_State) && (Address >= BL_Auth_Stream_End)){
+			/* The flash is read back, so a page left out in between is hashed as it is */
+			Bootloader_Auth_Hash_Flash(&BL_Auth_Stream, BL_Auth_Stream_End, (Address + Length) - BL_Auth_Stream_End);
+			BL_Auth_Stream_End = Address + Length;
+		}
+		else {
+			/* Bytes below the hashed ones changed, the check reads the image again */
+			BL_Auth_Stream_State = BL_AUTH_STREAM_BROKEN;
+		}
+	}
+}
+
+static void Bootloader_Auth_Stream_Erase(uint32_t Address, uint32_t Length) {
+	BL_Auth_Status = BL_AUTH_FAILED;
+	if((BL_AUTH_STREAM_EMPTY != BL_Auth_Stream_State) &&
+	   (Address < BL_Auth_Stream_End) && ((Address + Length) > BL_Auth_Stream_Start)){
+		/* An erase from the first hashed byte on starts a new image, one further up leaves a hole */
+		BL_Auth_Stream_State = (Address <= BL_Auth_Stream_Start) ? BL_AUTH_STREAM_EMPTY : BL_AUTH_STREAM_BROKEN;
+	}
+	else {/*Nothing to be done */}
+}
+
+static void handleCBL_AUTH_VERIFY_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint32_t  Image_Address         =0;
+	uint32_t  Image_Length          =0;
+	uint32_t  Streamed_Bytes        =0;
+	uint32_t  Verify_Cycles         =0;
+	uint8_t   Digest[BL_SHA256_DIGEST_SIZE];
+	uint8_t   Auth_Reply[BL_AUTH_REPLY_SIZE] ={BL_AUTH_FAILED, BL_AUTH_PATH_FULL};
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_AUTH_VERIFY_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		BL_Send_ACK(BL_AUTH_REPLY_SIZE);
+		Image_Address = *((uint32_t*)&BL_HOST_BUFFER[2]);
+		Image_Length  = *((uint32_t*)&BL_HOST_BUFFER[6]);
+		BL_Auth_Status = BL_AUTH_FAILED;
+		if((Host_CMD_Packet_Len == (BL_AUTH_HEADER_SIZE + BL_ECDSA_P256_SIGNATURE_SIZE + CRC_TYPE_SIZE)) && (0U != Image_Length) &&
+		   (ADDRESS_VALID == Bootloader_Segment_Range_Verfication(Image_Address, Image_Length))){
+			if((BL_AUTH_STREAM_VALID == BL_Auth_Stream_State) && (Image_Address == BL_Auth_Stream_Start) &&
+			   (BL_Auth_Stream_End <= (Image_Address + Image_Length))){
+				/* The writes hashed all but the tail */
+				Auth_Reply[1] = BL_AUTH_PATH_STREAMED;
+				Streamed_Bytes = BL_Auth_Stream_End - Image_Address;
+				Bootloader_Auth_Hash_Flash(&BL_Auth_Stream, BL_Auth_Stream_End, Image_Length - Streamed_Bytes);
+			}
+			else {
+				BL_SHA256_Init(&BL_Auth_Stream);
+				BL_Auth_Hash_Cycles = 0;
+				Bootloader_Auth_Hash_Flash(&BL_Auth_Stream, Image_Address, Image_Length);
+			}
+			BL_SHA256_Final(&BL_Auth_Stream, Digest);
+			BL_Auth_Stream_State = BL_AUTH_STREAM_EMPTY;
+
+			Verify_Cycles = Bootloader_Cycle_Count();
+			if(BL_ECDSA_P256_VALID == BL_ECDSA_P256_Verify(BL_Auth_Public_Key, Digest, &BL_HOST_BUFFER[BL_AUTH_HEADER_SIZE])){
+				BL_Auth_Status = BL_AUTH_PASSED;
+				BL_Auth_Image_Address = Image_Address;
+				BL_Auth_Image_Length = Image_Length;
+				Auth_Reply[0] = BL_AUTH_PASSED;
+#if (BL_DUAL_SLOT != BL_DUAL_SLOT_ENABLE)
+				if(BL_SLOT_A_BASE_ADDRESS == Image_Address){
+					/* A signed application may be started from now on, CBL_SWITCH_SLOT_CMD does this with two slots */
+					Bootloader_Close_Slot();
+				}
+				else {/*Nothing to be done */}
+#endif
+			}
+			else {/*Nothing to be done */}
+			Verify_Cycles = Bootloader_Cycle_Count() - Verify_Cycles;
+		}
+		else {/*Nothing to be done */}
+		memcpy(&Auth_Reply[2], &Streamed_Bytes, 4);
+		memcpy(&Auth_Reply[6], &BL_Auth_Hash_Cycles, 4);
+		memcpy(&Auth_Reply[10], &Verify_Cycles, 4);
+		BL_Transport_Send(Auth_Reply, BL_AUTH_REPLY_SIZE);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
+#endif
+
+#if (BL_AES == BL_AES_ENABLE)
+static uint8_t Bootloader_AES_Key_State(void) {
+	if(BL_AES_KEY_UNCHECKED == BL_AES_Key_State){
+		Bootloader_AES_Load_Key(BL_AES_Key);
+	}
+	else {/*Nothing to be done */}
+	return BL_AES_Key_State;
+}
+
+static void Bootloader_AES_Load_Key(const uint8_t *pKey) {
+	uint8_t Key_Bits = 0;
+	uint8_t Key_Index = 0;
+	for(Key_Index = 0; Key_Index < BL_AES128_KEY_SIZE; Key_Index++){
+		Key_Bits |= pKey[Key_Index];
+	}
+	if(0U != Key_Bits){
+		BL_AES128_Init(&BL_AES_Context, pKey);
+		BL_AES_Key_State = BL_AES_KEY_READY;
+	}
+	else {
+		BL_AES_Key_State = BL_AES_KEY_ZERO;
+	}
+}
+
+static void handleCBL_MEM_WRITE_AES_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint32_t  Host_Address          =0;
+	uint8_t   Payload_Len           =0;
+	uint8_t   FLASH_PAYLOAD_WRITE_STATUS = FLASH_PAYLOAD_WRITE_FAILED;
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_MEM_WRITE_AES_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		BL_Send_ACK(1);
+		Host_Address = *((uint32_t*)(&BL_HOST_BUFFER[2]));
+		Payload_Len  = BL_HOST_BUFFER[6];
+		if(((BL_AES_HEADER_SIZE + Payload_Len + CRC_TYPE_SIZE) == Host_CMD_Packet_Len) &&
+		   (BL_AES_KEY_READY == Bootloader_AES_Key_State())){
+			/* The cipher text is not needed any more, the plain text takes its place */
+			BL_AES128_CTR_Xor(&BL_AES_Context, &BL_HOST_BUFFER[7], &BL_HOST_BUFFER[BL_AES_HEADER_SIZE], Payload_Len);
+			FLASH_PAYLOAD_WRITE_STATUS = Bootloader_Write_Host_Data(&BL_HOST_BUFFER[BL_AES_HEADER_SIZE],Payload_Len,Host_Address,Payload_Len,FLASH_PAYLOAD_ENCODING_RAW);
+		}
+		else {/*Nothing to be done */}
+		BL_Transport_Send(&FLASH_PAYLOAD_WRITE_STATUS, 1);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
+#endif
+
 	 static uint8_t CBL_STM32401_Get_RDP_level(uint8_t *RDP_Level) {
 	 HAL_StatusTypeDef HAL_SATUS =HAL_ERROR;
 	uint8_t RDP_LEVEL_ERROR_STATUS= RDP_LEVEL_READ_INVALID;
@@ -626,7 +2003,7 @@ static void handleCBL_EN_R_W_PROTECT_CMD(uint8_t* BL_HOST_BUFFER) {
 	/* Read Protection Level */	 
 RDP_Level=CBL_STM32401_Get_RDP_level(&RDP_Level);
 	/*Report Protection Level*/
- HAL_UART_Transmit(BL_HOST_COMMUNICATION_UART, (uint8_t *)&RDP_Level, 1, HAL_MAX_DELAY);
+ BL_Transport_Send((uint8_t *)&RDP_Level, 1);
 }
 	 else {
 	 /* Report*/ 
@@ -645,9 +2022,92 @@ static void handleCBL_MEM_READ_CMD(uint8_t* BL_HOST_BUFFER) {
     // Add your code here
 }
 
+static uint8_t Bootloader_Page_Is_Blank(uint32_t Page_Address) {
+	const volatile uint32_t *pWord = (const volatile uint32_t *)Page_Address;
+	uint32_t Word_Index = 0;
+	for(Word_Index=0;(Word_Index<(CBL_FLASH_PAGE_SIZE/4U)) && (0xFFFFFFFFU==pWord[Word_Index]);Word_Index++){
+	}
+	return (Word_Index == (CBL_FLASH_PAGE_SIZE/4U)) ? BL_PAGE_BLANK : BL_PAGE_PROGRAMMED;
+}
+
+static uint32_t Bootloader_Page_CRC(uint32_t Page_Address) {
+	const volatile uint8_t *pByte = (const volatile uint8_t *)Page_Address;
+	uint32_t Byte_Index = 0;
+	uint32_t Page_CRC32 = 0;
+	/* Straight to the data register, a HAL_CRC_Accumulate call per byte costs
+	 * several times the write itself and the whole flash goes through here */
+	__HAL_CRC_DR_RESET(CRC_Engine_Obj);
+	for(Byte_Index=0;Byte_Index<CBL_FLASH_PAGE_SIZE;Byte_Index++){
+		(CRC_Engine_Obj)->Instance->DR = pByte[Byte_Index];
+	}
+	Page_CRC32 = (CRC_Engine_Obj)->Instance->DR;
+	__HAL_CRC_DR_RESET(CRC_Engine_Obj);
+	return Page_CRC32;
+}
+
 static void handleCBL_READ_SECTOR_STATUS_CMD(uint8_t* BL_HOST_BUFFER) {
-    // Implementation for CBL_READ_SECTOR_STATUS_CMD
-    // Add your code here
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint32_t  Page_Index            =0;
+	uint32_t  Erased_Page_CRC32     =0;
+	uint8_t   Erased_Page_CRC_Known =0;
+	uint8_t   Status_Header[BL_SECTOR_STATUS_HEADER_SIZE] ={0};
+	uint8_t   Blank_Map[BL_SECTOR_STATUS_MAP_SIZE]        ={0};
+	uint32_t  Page_CRC32[BL_SECTOR_STATUS_CRC_CHUNK]      ={0};
+	FLASH_OBProgramInitTypeDef FLASH_OBProgram;
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_READ_SECTOR_STATUS_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		BL_Send_Long_ACK(BL_SECTOR_STATUS_REPLY_SIZE);
+		HAL_FLASHEx_OBGetConfig(&FLASH_OBProgram);
+		Status_Header[0] = (uint8_t)CBL_MAX_PAGE_NUMBER;
+		Status_Header[1] = (uint8_t)(FLASH_OBProgram.WRPPage);
+		Status_Header[2] = (uint8_t)(FLASH_OBProgram.WRPPage >> 8);
+		Status_Header[3] = (uint8_t)(FLASH_OBProgram.WRPPage >> 16);
+		Status_Header[4] = (uint8_t)(FLASH_OBProgram.WRPPage >> 24);
+		BL_Transport_Send(Status_Header, BL_SECTOR_STATUS_HEADER_SIZE);
+		/* The blank scan stops at the first programmed word, it is quick next to the CRCs */
+		for(Page_Index=0;Page_Index<CBL_MAX_PAGE_NUMBER;Page_Index++){
+			if(BL_PAGE_BLANK == Bootloader_Page_Is_Blank(STM32F103_FLASH_BASE + (Page_Index*CBL_FLASH_PAGE_SIZE))){
+				Blank_Map[Page_Index/8U] |= (uint8_t)(1U << (Page_Index%8U));
+			}
+			else {/*Nothing to be done */}
+		}
+		BL_Transport_Send(Blank_Map, BL_SECTOR_STATUS_MAP_SIZE);
+		for(Page_Index=0;Page_Index<CBL_MAX_PAGE_NUMBER;Page_Index++){
+			if(0U == (Blank_Map[Page_Index/8U] & (1U << (Page_Index%8U)))){
+				Page_CRC32[Page_Index%BL_SECTOR_STATUS_CRC_CHUNK] = Bootloader_Page_CRC(STM32F103_FLASH_BASE + (Page_Index*CBL_FLASH_PAGE_SIZE));
+			}
+			else {
+				/* Every blank page has the same CRC, it is computed once */
+				if(0U == Erased_Page_CRC_Known){
+					Erased_Page_CRC32     = Bootloader_Page_CRC(STM32F103_FLASH_BASE + (Page_Index*CBL_FLASH_PAGE_SIZE));
+					Erased_Page_CRC_Known = 1U;
+				}
+				else {/*Nothing to be done */}
+				Page_CRC32[Page_Index%BL_SECTOR_STATUS_CRC_CHUNK] = Erased_Page_CRC32;
+			}
+			if((BL_SECTOR_STATUS_CRC_CHUNK-1U) == (Page_Index%BL_SECTOR_STATUS_CRC_CHUNK)){
+				BL_Transport_Send((uint8_t *)Page_CRC32, BL_SECTOR_STATUS_CRC_CHUNK*CRC_TYPE_SIZE);
+			}
+			else {/*Nothing to be done */}
+		}
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
 }
 
 static void handleCBL_OTP_READ_CMD(uint8_t* BL_HOST_BUFFER) {
@@ -678,26 +2138,243 @@ static void handleCBL_CHANGE_ROP_LEVEL_CMD(uint8_t* BL_HOST_BUFFER) {
 }
 	 }
 
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+static void handleCBL_GET_SLOT_INFO_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint32_t  Slot_Base             =0;
+	uint32_t  Slot_Size             =BL_SLOT_SIZE;
+	uint8_t   Slot_Info[10]         ={0};
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_GET_SLOT_INFO_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		/* Boot slot | Update (inactive) slot | Update slot base address | Slot size */
+		Slot_Info[0] = Bootloader_Get_Boot_Slot();
+		Slot_Info[1] = Bootloader_Get_Inactive_Slot();
+		Slot_Base    = Bootloader_Get_Slot_Base_Address(Slot_Info[1]);
+		memcpy(&Slot_Info[2], &Slot_Base, 4);
+		memcpy(&Slot_Info[6], &Slot_Size, 4);
+		BL_Send_ACK(sizeof(Slot_Info));
+		BL_Transport_Send(Slot_Info, sizeof(Slot_Info));
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
+
+static void handleCBL_SWITCH_SLOT_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint8_t   Update_Slot           =BL_SLOT_NONE;
+	uint8_t   Switch_Status         =BL_SLOT_SWITCH_FAILED;
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_SWITCH_SLOT_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
+
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		BL_Send_ACK(1);
+		/* Refuse to point the selector at a slot that does not hold a bootable image */
+		Update_Slot = Bootloader_Get_Inactive_Slot();
+#if (BL_AUTH == BL_AUTH_ENABLE)
+		if((BL_AUTH_PASSED != BL_Auth_Status) || (Bootloader_Get_Slot_Base_Address(Update_Slot) != BL_Auth_Image_Address)){
+			/* The slot must hold the image whose signature checked fine */
+			Update_Slot = BL_SLOT_NONE;
+		}
+		else {/*Nothing to be done */}
+#endif
+		if((BL_SLOT_NONE != Update_Slot) && (ADDRESS_VALID == Bootloader_Slot_Is_Valid(Update_Slot)) &&
+		   (HAL_OK == Bootloader_Write_Boot_Record(BL_BOOT_SELECTOR_RECORD_SLOT_A + Update_Slot))){
+			Switch_Status = BL_SLOT_SWITCH_PASSED;
+		}
+		else {/*Nothing to be done */}
+		if(BL_SLOT_SWITCH_PASSED == Switch_Status){
+			/* The old boot slot takes the next update, its first write opens it */
+			BL_Update_Slot = BL_SLOT_NONE;
+			BL_Open_Slot = BL_SLOT_NONE;
+		}
+		else {/*Nothing to be done */}
+		BL_Transport_Send(&Switch_Status, 1);
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
+#endif
+
+static uint8_t Bootloader_Query_Reply(uint8_t Command, uint8_t *pReply) {
+	uint8_t  Reply_Len = 0;
+	uint16_t MCU_ID_NO = 0;
+	uint8_t  RDP_Level = 0;
+	#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+	uint32_t Slot_Base = 0;
+	uint32_t Slot_Size = BL_SLOT_SIZE;
+	#endif
+	switch(Command){
+	case CBL_GET_VER_CMD:
+		pReply[0] = CBL_VERSION_ID;
+		pReply[1] = CBL_SW_MAJOR_VERSION;
+		pReply[2] = CBL_SW_MINORR_VERSION;
+		pReply[3] = CBL_SW_PATCH_VERSION;
+		Reply_Len = 4;
+		break;
+	case CBL_GET_HELP_CMD:
+		memcpy(pReply, BL_Supported_CMDs, sizeof(BL_Supported_CMDs));
+		Reply_Len = sizeof(BL_Supported_CMDs);
+		break;
+	case CBL_GET_CID_CMD:
+		MCU_ID_NO = (uint16_t)((DBGMCU->IDCODE)&0x00000FFF);
+		memcpy(pReply, &MCU_ID_NO, 2);
+		Reply_Len = 2;
+		break;
+	case CBL_GET_RDP_STATUS_CMD:
+		pReply[0] = (OB_RDP_LEVEL_0 == CBL_STM32401_Get_RDP_level(&RDP_Level)) ? RDP_STATUS_LEVEL_0 : RDP_STATUS_LEVEL_1;
+		Reply_Len = 1;
+		break;
+	case CBL_EN_R_W_PROTECT_CMD:
+		pReply[0] = CBL_STM32401_Get_RDP_level(&RDP_Level);
+		Reply_Len = 1;
+		break;
+	#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+	case CBL_GET_SLOT_INFO_CMD:
+		/* Boot slot | Update (inactive) slot | Update slot base address | Slot size */
+		pReply[0] = Bootloader_Get_Boot_Slot();
+		pReply[1] = Bootloader_Get_Inactive_Slot();
+		Slot_Base = Bootloader_Get_Slot_Base_Address(pReply[1]);
+		memcpy(&pReply[2], &Slot_Base, 4);
+		memcpy(&pReply[6], &Slot_Size, 4);
+		Reply_Len = 10;
+		break;
+	#endif
+	default:
+		Reply_Len = 0;
+		break;
+	}
+	return Reply_Len;
+}
+
+static void handleCBL_BATCH_CMD(uint8_t* BL_HOST_BUFFER) {
+	uint16_t  Host_CMD_Packet_Len   =0;
+	uint32_t  Host_CRC32            =0;
+	uint8_t   Command_Count         =0;
+	uint8_t   Command_Index         =0;
+	uint8_t   Batch_Commands[BL_BATCH_MAX_COMMANDS] ={0};
+	uint8_t   Query_Reply[BL_QUERY_MAX_REPLY]       ={0};
+	uint8_t   Query_Len             =0;
+	uint8_t   Reply_Len             =0;
+	#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+	BL_Print_Message("CBL_BATCH_CMD reached.\r\n");
+	#endif
+	/*Extract the CRC32 and pkt length sent by Host*/
+	Host_CMD_Packet_Len=BL_HOST_BUFFER[0] + 1;
+	Host_CRC32=*((uint32_t*)((BL_HOST_BUFFER+Host_CMD_Packet_Len)-CRC_TYPE_SIZE));
 
+	/*CRC Verification*/
+	if(CRC_OK == Bootloader_CRC_verify( (uint8_t*)&BL_HOST_BUFFER[0],Host_CMD_Packet_Len-CRC_TYPE_SIZE , Host_CRC32)) {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation Passsed \r\n");
+		#endif
+		/* An empty batch gets an empty reply, the count must not wrap */
+		if(Host_CMD_Packet_Len >= (2 + CRC_TYPE_SIZE)){
+			Command_Count = (uint8_t)(Host_CMD_Packet_Len - 2 - CRC_TYPE_SIZE);
+		}
+		else {
+			Command_Count = 0;
+		}
+		if(Command_Count > BL_BATCH_MAX_COMMANDS){
+			/* Answering only the first ones would look like a complete reply to the host */
+			#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+			BL_Print_Message("Too many commands in the batch \r\n");
+			#endif
+			BL_Send_NACK();
+		}
+		else {
+			/* The frame is not needed any more, the reply is built in its place */
+			memcpy(Batch_Commands, &BL_HOST_BUFFER[2], Command_Count);
+			for(Command_Index=0;Command_Index<Command_Count;Command_Index++){
+				Query_Len = Bootloader_Query_Reply(Batch_Commands[Command_Index], Query_Reply);
+				if((Reply_Len + BL_BATCH_ENTRY_HEADER_SIZE + Query_Len) > BL_HOST_BUFFER_length){
+					Query_Len = 0;
+				}
+				else {/*Nothing to be done */}
+				if((Reply_Len + BL_BATCH_ENTRY_HEADER_SIZE) <= BL_HOST_BUFFER_length){
+					BL_HOST_BUFFER[Reply_Len]     = Batch_Commands[Command_Index];
+					BL_HOST_BUFFER[Reply_Len + 1] = Query_Len;
+					memcpy(&BL_HOST_BUFFER[Reply_Len + BL_BATCH_ENTRY_HEADER_SIZE], Query_Reply, Query_Len);
+					Reply_Len += BL_BATCH_ENTRY_HEADER_SIZE + Query_Len;
+				}
+				else {/*Nothing to be done */}
+			}
+			BL_Send_ACK(Reply_Len);
+			BL_Transport_Send(BL_HOST_BUFFER, Reply_Len);
+		}
+	}
+	else {
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("CRC Verifcation failed\r\n");
+		#endif
+		BL_Send_NACK();
+	}
+}
 
 
 BL_status BL_UART_FETCH_HOST_COMMAND(void){
 	
 	BL_status status=BL_NACK;
 	HAL_StatusTypeDef HAL_STATUS=HAL_ERROR;
-	uint8_t Data_length =0;
 	memset(BL_HOST_BUFFER,0,BL_HOST_BUFFER_length);
-	HAL_STATUS=HAL_UART_Receive(BL_HOST_COMMUNICATION_UART,BL_HOST_BUFFER,1,HAL_MAX_DELAY);
-
-	if(HAL_STATUS != HAL_OK) {
+	HAL_STATUS=BL_Transport_Receive_Frame(BL_HOST_BUFFER,BL_HOST_BUFFER_length);
+#if (BL_IWDG == BL_IWDG_ENABLE)
+	if(HAL_OK == HAL_STATUS){
+		/* Progress is a whole frame, not a turn of the main loop */
+		Bootloader_Watchdog_Refresh();
+	}
+	else {/*Nothing to be done */}
+#endif
+
+			if(HAL_STATUS == HAL_TIMEOUT) {
+			/* A byte got lost or the frame is too short for its CRC: drop the rest of the frame instead of taking bytes of the next one,
+			   a write frame is named by its sequence number when that much arrived */
+			if(CBL_MEM_WRITE_SEQ_CMD == BL_HOST_BUFFER[1]) {
+				BL_Send_Seq_NACK((uint16_t)BL_HOST_BUFFER[2] | ((uint16_t)BL_HOST_BUFFER[3] << 8));
+			}
+			else {
+				BL_Send_NACK();
+			}
 			status =BL_NACK;
-	
 	}
-	else {
-				Data_length=BL_HOST_BUFFER[0];
-			HAL_STATUS=HAL_UART_Receive(BL_HOST_COMMUNICATION_UART,&BL_HOST_BUFFER[1],Data_length,HAL_MAX_DELAY);
-			if(HAL_STATUS != HAL_OK) {
+			else if(HAL_STATUS != HAL_OK) {
 			status =BL_NACK;
+	}
+			else if((BL_NODE_STATE_UNSELECTED == BL_Node_State) && (CBL_NODE_SELECT_CMD != BL_HOST_BUFFER[1])) {
+			/* Meant for another node on the bus */
+			status =BL_OK;
+	}
+			else if((BL_NODE_STATE_BROADCAST == BL_Node_State) && (CBL_NODE_SELECT_CMD != BL_HOST_BUFFER[1]) &&
+			        (CBL_FLASH_ERASE_CMD != BL_HOST_BUFFER[1]) && (CBL_MEM_WRITE_SEQ_CMD != BL_HOST_BUFFER[1])) {
+			/* A broadcast only streams an image */
+			status =BL_OK;
 	}
 		else {
 switch (BL_HOST_BUFFER[1]) {
@@ -773,6 +2450,56 @@ switch (BL_HOST_BUFFER[1]) {
         handleCBL_CHANGE_ROP_LEVEL_CMD(BL_HOST_BUFFER);
         status = BL_OK;
         break;
+    case CBL_MEM_WRITE_LZ_CMD:
+        handleCBL_MEM_WRITE_LZ_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+    case CBL_MEM_WRITE_RLE_CMD:
+        handleCBL_MEM_WRITE_RLE_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+    case CBL_VERIFY_SEGMENTS_CMD:
+        handleCBL_VERIFY_SEGMENTS_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+    case CBL_MEM_WRITE_SEQ_CMD:
+        handleCBL_MEM_WRITE_SEQ_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+    case CBL_NODE_SELECT_CMD:
+        handleCBL_NODE_SELECT_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+    case CBL_BCAST_STATUS_CMD:
+        handleCBL_BCAST_STATUS_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+#if (BL_AUTH == BL_AUTH_ENABLE)
+    case CBL_AUTH_VERIFY_CMD:
+        handleCBL_AUTH_VERIFY_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+#endif
+#if (BL_AES == BL_AES_ENABLE)
+    case CBL_MEM_WRITE_AES_CMD:
+        handleCBL_MEM_WRITE_AES_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+#endif
+    case CBL_BATCH_CMD:
+        handleCBL_BATCH_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+    case CBL_GET_SLOT_INFO_CMD:
+        handleCBL_GET_SLOT_INFO_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+    case CBL_SWITCH_SLOT_CMD:
+        handleCBL_SWITCH_SLOT_CMD(BL_HOST_BUFFER);
+        status = BL_OK;
+        break;
+#endif
     default:
         // Code to handle unknown command
         BL_Print_Message("Unknown command reached !!\r\n");
@@ -786,41 +2513,164 @@ switch (BL_HOST_BUFFER[1]) {
 		
 		}	
 	
-}
 	return status;
 
 };
 
 static void bootloader_Jump_to_User_App(void){
-			
+	uint8_t  Boot_Slot   = Bootloader_Get_Boot_Slot();
+	uint32_t App_Address = Bootloader_Get_Slot_Base_Address(Boot_Slot);
+	uint8_t  IRQ_Index   = 0;
+	if(BL_SLOT_NONE == Boot_Slot){
+		/* No complete image: stay in the bootloader */
+		return;
+	}
+	else {/*Nothing to be done */}
+
 	/* Value of the main stack pointer of main application */
-	uint32_t MSP_Value=*((volatile uint32_t *)(FLASH_SECTOR2_BASE_ADDRESS));
+	uint32_t MSP_Value=*((volatile uint32_t *)(App_Address));
 	
 	/* Reset Handler defination functionof main application */
-	uint32_t MainAppAddr=*((volatile uint32_t *)(FLASH_SECTOR2_BASE_ADDRESS+4));
+	uint32_t MainAppAddr=*((volatile uint32_t *)(App_Address+4));
 
 	/*Fetch the reset Handler address of user application*/
 	/**x**/ /* void(*pMainApp)(void)=(void*)MainAppAddr;*/
 	pMainApp ResetHandler_Address =(pMainApp) MainAppAddr;
 
-	/** Set Main Stack Pointer **/ 
-	__set_MSP(MSP_Value);
-	
 	/** Deintia;ize of modules **/
-	HAL_RCC_DeInit();  /* Resets the RCC clock configuration to the default reset state */
+	BL_Transport_Close();
+	HAL_RCC_DeInit();  /* Resets the RCC clock configuration to the default reset state, it starts SysTick again */
+
+	/* Nothing of the bootloader may fire once the vector table is the application's */
+	__disable_irq();
+	SysTick->CTRL = 0;
+	SysTick->LOAD = 0;
+	SysTick->VAL  = 0;
+	SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+	for(IRQ_Index=0;IRQ_Index<(sizeof(NVIC->ICER)/sizeof(NVIC->ICER[0]));IRQ_Index++){
+		NVIC->ICER[IRQ_Index] = 0xFFFFFFFFU;
+		NVIC->ICPR[IRQ_Index] = 0xFFFFFFFFU;
+	}
+
+	/** Vector table of the selected image **/
+	SCB->VTOR = App_Address;
+	__DSB();
+	__ISB();
+	/** Set Main Stack Pointer, the last use of this stack **/ 
+	__set_MSP(MSP_Value);
+	/* The application starts as after a reset, with PRIMASK clear */
+	__enable_irq();
  /** Jump to Application Reset Handler **/
   ResetHandler_Address();
 }
 
 
+void BL_Check_Watchdog_Reset(void){
+#if (BL_IWDG == BL_IWDG_ENABLE)
+	uint8_t Watchdog_Reset = (0U != __HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST)) ? 1U : 0U;
+	__HAL_RCC_CLEAR_RESET_FLAGS();
+	if((1U == Watchdog_Reset) && (0U == BL_Mailbox_Is_Pending())){
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("Watchdog reset, starting the application\r\n");
+		#endif
+		/* Returns when the update the watchdog cut short left the image open */
+		bootloader_Jump_to_User_App();
+		#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+		BL_Print_Message("No complete application, waiting for the host\r\n");
+		#endif
+	}
+	else {/*Nothing to be done */}
+#endif
+}
+
+void BL_Start_Application(void){
+	if((0U == BL_Mailbox_Request_Taken) && (BL_SLOT_NONE != Bootloader_Get_Boot_Slot())){
+		if(HAL_TIMEOUT == BL_Transport_Wait(BL_BOOT_WINDOW_MS)){
+			#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+			BL_Print_Message("No host, starting the application\r\n");
+			#endif
+			bootloader_Jump_to_User_App();
+		}
+		else {/*The host is there: its byte starts the first frame */}
+	}
+	else {/*Nothing to be done */}
+}
+
+void BL_Take_Mailbox_Request(void){
+	uint8_t Byte_Index = 0;
+#if (BL_AES == BL_AES_ENABLE)
+	uint8_t Session_Key[BL_MAILBOX_KEY_SIZE];
+#endif
+	if(1U == BL_Mailbox_Is_Pending()){
+		BL_Mailbox_Request_Taken = 1;
+		if((BL_MAILBOX_TRANSPORT_ANY != BL_MAILBOX->Transport) && (BL_TRANSPORT != BL_MAILBOX->Transport)){
+			/* The host waits on another link, nothing of the request fits this one */
+			#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+			BL_Print_Message("Mailbox asks for transport %d, request dropped\r\n", BL_MAILBOX->Transport);
+			#endif
+		}
+		else {
+			if(0U != BL_MAILBOX->Baud_Rate){
+				if(HAL_OK != BL_Transport_Set_Speed(BL_MAILBOX->Baud_Rate)){
+					#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+					BL_Print_Message("Mailbox speed %lu refused\r\n", (unsigned long)BL_MAILBOX->Baud_Rate);
+					#endif
+				}
+				else {/*Nothing to be done */}
+			}
+			else {/*Nothing to be done */}
+#if (BL_AES == BL_AES_ENABLE)
+			if(0U != (BL_MAILBOX->Flags & BL_MAILBOX_FLAG_SESSION_KEY)){
+				for(Byte_Index = 0; Byte_Index < BL_MAILBOX_KEY_SIZE; Byte_Index++){
+					Session_Key[Byte_Index] = BL_MAILBOX->Session_Key[Byte_Index];
+				}
+				Bootloader_AES_Load_Key(Session_Key);
+				memset(Session_Key, 0, sizeof(Session_Key));
+			}
+			else {/*Nothing to be done */}
+#endif
+			#if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
+			BL_Print_Message("Update requested by the application\r\n");
+			#endif
+		}
+		/* Taken once, the next reset boots without it. The key does not stay in RAM either */
+		for(Byte_Index = 0; Byte_Index < BL_MAILBOX_KEY_SIZE; Byte_Index++){
+			BL_MAILBOX->Session_Key[Byte_Index] = 0;
+		}
+		BL_MAILBOX->Magic = 0;
+		BL_MAILBOX->Check = 0;
+	}
+	else {/*Nothing to be done */}
+}
+
+#if (BL_IWDG == BL_IWDG_ENABLE)
+static void Bootloader_Watchdog_Refresh(void){
+	if(BL_IWDG_STOPPED == BL_IWDG_State){
+		/* HAL_IWDG_Init starts the counter and waits for the registers to take the values */
+		BL_IWDG_Handle.Instance = IWDG;
+		BL_IWDG_Handle.Init.Prescaler = IWDG_PRESCALER_256;
+		BL_IWDG_Handle.Init.Reload = BL_IWDG_RELOAD;
+		if(HAL_OK == HAL_IWDG_Init(&BL_IWDG_Handle)){
+			BL_IWDG_State = BL_IWDG_RUNNING;
+		}
+		else {/*Nothing to be done */}
+	}
+	else {
+		HAL_IWDG_Refresh(&BL_IWDG_Handle);
+	}
+}
+#endif
+
 
 void BL_Print_Message(char *format, ...){
 	char Message[100] ={0};
 	va_list args;
 	va_start(args,format);
-	vsprintf(Message, format, args);
+	vsnprintf(Message, sizeof(Message), format, args);
+	va_end(args);
 	#if (DEBUG_METHOD_UART==DEBUG_METHOD)
-	HAL_UART_Transmit(&huart2, (uint8_t*)Message, sizeof(Message),HAL_MAX_DELAY);
+	/* Only the text, not the zeros behind it */
+	HAL_UART_Transmit(BL_DEBUG_UART, (uint8_t*)Message, (uint16_t)strlen(Message),HAL_MAX_DELAY);
 	#elif (DEBUG_METHOD_SPI==DEBUG_METHOD)
 	/**PERFORMS BL DEBUGGING USING SPI**/
 	#elif (DEBUG_METHOD_CAN==DEBUG_METHOD)
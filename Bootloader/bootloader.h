@@ -15,14 +15,20 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include "crc.h"
+#include "bl_transport.h"
+#include "bl_sha256.h"
+#include "bl_ecdsa_p256.h"
+#include "bl_aes128.h"
+#include "bl_mailbox.h"
 
 /*------------------ INCLUDES END --------------------------------------*/
 
 
 
 /*------------------ MACRO DECLARATION ----------------------*/
-#define BL_DEBUG_UART                &huart2
-#define BL_HOST_COMMUNICATION_UART   &huart2 
+/* USART1 (PA9/PA10), the host link is on USART2: text between the ACKs would
+ * look like a NACK to the host */
+#define BL_DEBUG_UART                &huart1
 
 #define CRC_Engine_Obj               &hcrc
 
@@ -52,6 +58,17 @@
 #define CBL_READ_SECTOR_STATUS_CMD						0x19
 #define CBL_OTP_READ_CMD											0x20
 #define CBL_CHANGE_ROP_LEVEL_CMD							0x21
+#define CBL_GET_SLOT_INFO_CMD								0x22
+#define CBL_SWITCH_SLOT_CMD									0x23
+#define CBL_MEM_WRITE_LZ_CMD								0x24
+#define CBL_MEM_WRITE_RLE_CMD								0x25
+#define CBL_VERIFY_SEGMENTS_CMD							0x26
+#define CBL_MEM_WRITE_SEQ_CMD								0x27
+#define CBL_NODE_SELECT_CMD									0x28
+#define CBL_BCAST_STATUS_CMD								0x29
+#define CBL_AUTH_VERIFY_CMD									0x2A
+#define CBL_MEM_WRITE_AES_CMD								0x2B
+#define CBL_BATCH_CMD										0x2C
 
 
 /**************************** BL Version**************************/
@@ -73,6 +90,8 @@
 
 #define CBL_SEND_ACK                          0xAB
 #define CBL_SEND_NACK                         0xCD
+/* ACK with a 16 bit little endian length, for the replies longer than 255 bytes */
+#define CBL_SEND_LONG_ACK                     0xAC
 
 
 /* Start address of sector 2 */
@@ -85,10 +104,64 @@
 
 #define STM32F103_SRAM_BASE						       (0x20000000)
 #define STM32F103_SRAM_END									 (STM32F103_SRAM_BASE+(20*1024))
+/**************************** A/B Dual Slot Layout **************************/
+/* Optional dual-slot layout for the 128 KB STM32F103 variant. New images are
+ * streamed into the inactive slot while the running application keeps its own
+ * slot; a single half-word record appended to the boot selector page switches
+ * the boot slot atomically (a half-word program cannot be torn on this flash). */
+#define BL_DUAL_SLOT_DISABLE                  0x00
+#define BL_DUAL_SLOT_ENABLE                   0x01
+#define BL_DUAL_SLOT                          BL_DUAL_SLOT_DISABLE
+
 #define STM32F103_FLASH_BASE								 (0x08000000)
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+#define STM32F103_FLASH_END									 (STM32F103_FLASH_BASE+(128*1024))
+#else
 #define STM32F103_FLASH_END									 (STM32F103_FLASH_BASE+(64*1024))
+#endif
 #define APP_BASE_ADDREESS										  0x08008000
 
+#define CBL_FLASH_PAGE_SIZE                   0x400U
+#define CBL_BOOTLOADER_PAGES                  ((APP_BASE_ADDREESS-STM32F103_FLASH_BASE)/CBL_FLASH_PAGE_SIZE)
+
+/* 32 KB BL | 47 KB slot A | 47 KB slot B | 1 KB reserved | 1 KB boot selector.
+ * Without the dual-slot layout the application area is the one slot A and the
+ * boot selector takes the last page of the bootloader area. */
+#define BL_SLOT_A                             0x00
+#define BL_SLOT_B                             0x01
+#define BL_SLOT_NONE                          0xFF
+#define BL_SLOT_COUNT                         2U
+#define BL_SLOT_A_BASE_ADDRESS                APP_BASE_ADDREESS
+#if (BL_DUAL_SLOT == BL_DUAL_SLOT_ENABLE)
+#define BL_SLOT_SIZE                          (47*CBL_FLASH_PAGE_SIZE)
+#define BL_BOOT_SELECTOR_ADDRESS              (STM32F103_FLASH_END-CBL_FLASH_PAGE_SIZE)
+#else
+#define BL_SLOT_SIZE                          (STM32F103_FLASH_END-APP_BASE_ADDREESS)
+#define BL_BOOT_SELECTOR_ADDRESS              (APP_BASE_ADDREESS-CBL_FLASH_PAGE_SIZE)
+#endif
+#define BL_SLOT_B_BASE_ADDRESS                (BL_SLOT_A_BASE_ADDRESS+BL_SLOT_SIZE)
+
+/* Boot selector records, appended and read in order. OPEN_x goes in before the
+ * first erase or write of slot x in a session and marks its image incomplete.
+ * SLOT_x closes slot x and selects it: the last SLOT record wins. It is written
+ * by CBL_SWITCH_SLOT_CMD, without the dual-slot layout once the session CRC
+ * (CBL_VERIFY_SEGMENTS_CMD) or with BL_AUTH the signature (CBL_AUTH_VERIFY_CMD)
+ * of the image at the slot base checked fine. An open slot is never started. */
+#define BL_BOOT_SELECTOR_RECORD_ERASED        0xFFFFU
+#define BL_BOOT_SELECTOR_RECORD_SLOT_A        0xA50AU
+#define BL_BOOT_SELECTOR_RECORD_SLOT_B        0xA50BU
+#define BL_BOOT_SELECTOR_RECORD_OPEN_A        0x5A0AU
+#define BL_BOOT_SELECTOR_RECORD_OPEN_B        0x5A0BU
+
+/* What the records say about a slot. A slot without records holds an image put
+ * there by other means (a debugger), it only boots without BL_AUTH. */
+#define BL_SLOT_STATE_UNKNOWN                 0x00
+#define BL_SLOT_STATE_OPEN                    0x01
+#define BL_SLOT_STATE_COMPLETE                0x02
+
+#define BL_SLOT_SWITCH_FAILED                 0x00
+#define BL_SLOT_SWITCH_PASSED                 0x01
+
 
 
 /**Erase Function**/
@@ -98,13 +171,16 @@
 #define UNSUCCESSFUL_ERASE                    0X02
 #define SUCCESSFUL_ERASE                      0X03
 #define HAL_SUCCESSFUL_ERASE                  0xFFFFFFFFU
-/*ASSUME (low-density devices) */
-#define CBL_MAX_PAGE_NUMBER								    32
+/* Pages 0..(CBL_BOOTLOADER_PAGES-1) hold the bootloader itself */
+#define CBL_MAX_PAGE_NUMBER								    ((STM32F103_FLASH_END-STM32F103_FLASH_BASE)/CBL_FLASH_PAGE_SIZE)
 #define CBL_Mass_ERASE						      		  0xFF
 
 /* CBL_GET_RDP_STATUS_CMD	*/
 #define RDP_LEVEL_READ_INVALID                0x00
 #define RDP_LEVEL_READ_VALID                  0x01
+/* The reply, the F1 has no level 2 */
+#define RDP_STATUS_LEVEL_0                    0xAA
+#define RDP_STATUS_LEVEL_1                    0x55
 
 /**************************** CBL_MEM_WRITE_CMD**************************/
 
@@ -113,6 +189,211 @@
 
 #define FLASH_LOCK_FAILED           0X00
 #define FLASH_LOCK_PASSED           0X01
+
+#define FLASH_PAYLOAD_ENCODING_RAW           0X00
+#define FLASH_PAYLOAD_ENCODING_RLE           0X01
+#define FLASH_PAYLOAD_ENCODING_LZ            0X02
+
+/**************************** CBL_MEM_WRITE_LZ_CMD**************************/
+/* Byte-aligned LZ77 stream, one token never straddles two frames:
+ *   0x00..0x7F  literal run of (token+1) bytes copied from the frame
+ *   0x80..0xFF  match of ((token&0x7F)+3) bytes, next byte = distance-1
+ * Matches reach back across frames as long as each frame continues at the
+ * address where the previous one ended. The tokens are decoded straight into
+ * the flash programming, only the window is kept in RAM. */
+#define BL_LZ_WINDOW_SIZE                    256  /* indexed with a uint8_t, keep at 256 */
+#define BL_LZ_MAX_FRAME_OUTPUT               512
+#define LZ_TOKEN_MATCH_FLAG                  0x80U
+#define LZ_MIN_MATCH_LENGTH                  3
+
+#define LZ_DECODE_FAILED                     0X00
+#define LZ_DECODE_PASSED                     0X01
+
+/**************************** CBL_MEM_WRITE_RLE_CMD**************************/
+/* Run-length records, decoded straight into the flash programming:
+ *   0b0nnnnnnn            literal run of (n+1) bytes copied from the frame
+ *   0b10nnnnnn nnnnnnnn   skip (n+1) bytes of 0xFF, erased flash is left untouched
+ *   0b11nnnnnn nnnnnnnn v fill (n+1) bytes with the value v */
+#define RLE_TOKEN_TYPE_MASK_LITERAL          0x80U
+#define RLE_TOKEN_TYPE_MASK_RUN              0xC0U
+#define RLE_TOKEN_LITERAL                    0x00U
+#define RLE_TOKEN_SKIP                       0x80U
+#define RLE_TOKEN_FILL                       0xC0U
+#define RLE_TOKEN_RUN_MASK                   0x3FU
+
+#define RLE_DECODE_FAILED                    0X00
+#define RLE_DECODE_PASSED                    0X01
+
+/**************************** CBL_VERIFY_SEGMENTS_CMD**************************/
+/* [count][count x (address, length)][session CRC32], all words little endian.
+ * The session CRC runs over the segments back to back. The F1 CRC unit cannot
+ * be seeded, so the whole list has to fit in one frame. */
+#define BL_SEGMENT_DESCRIPTOR_SIZE           8
+#define BL_MAX_SEGMENTS                      ((BL_HOST_BUFFER_length-(4+CRC_TYPE_SIZE+CRC_TYPE_SIZE))/BL_SEGMENT_DESCRIPTOR_SIZE)
+
+#define SEGMENT_CRC_FAILED                   0X00
+#define SEGMENT_CRC_PASSED                   0X01
+
+/**************************** CBL_MEM_WRITE_SEQ_CMD**************************/
+/* CBL_MEM_WRITE_CMD with a sequence number, so the host can keep several
+ * frames in flight and resend only the ones that got lost:
+ *   [len][0x27][seq u16][address u32][payload len][payload][CRC32]
+ * The reply is [status][seq u16]; a frame failing its CRC gets
+ * [CBL_SEND_NACK][seq u16] instead of the plain NACK. The status of the last
+ * BL_SEQ_HISTORY_SIZE frames is kept, a frame sent again after its reply was
+ * lost is answered from there and not programmed twice. CBL_FLASH_ERASE_CMD
+ * clears the history. */
+#define BL_SEQ_HEADER_SIZE                   9
+#define BL_SEQ_REPLY_SIZE                    3
+#define BL_SEQ_HISTORY_SIZE                  32
+
+#define BL_SEQ_NOT_FOUND                     0X00
+#define BL_SEQ_FOUND                         0X01
+
+/**************************** Shared bus nodes**************************/
+/* Several boards on one RS-485 or CAN bus see the same frames. Each node has a
+ * 16 bit address folded from its unique ID and starts in BL_NODE_STATE_ALL,
+ * where it answers everything like on a point-to-point link.
+ *   CBL_NODE_SELECT_CMD  [len][0x28][address u16][CRC32]
+ * The node with that address answers [BL_NODE_SELECTED][address u16], all the
+ * others fall silent and only listen for the next select. BL_NODE_BROADCAST
+ * selects every node without an answer: they take CBL_FLASH_ERASE_CMD and
+ * CBL_MEM_WRITE_SEQ_CMD only and every sequence number written fine is marked
+ * in a bitmap, the erase clears it. BL_NODE_ANY is answered by a node that is
+ * not silent and changes nothing, it reads the address of a single board.
+ *   CBL_BCAST_STATUS_CMD [len][0x29][CRC32]
+ * answers [frames written u16][bitmap], sequence number n is bit n%8 of byte n/8. */
+#define BL_NODE_BROADCAST                    0xFFFFU
+#define BL_NODE_ANY                          0x0000U
+#define BL_NODE_SELECTED                     0X01
+#define BL_NODE_REPLY_SIZE                   3
+
+#define BL_NODE_STATE_ALL                    0x00
+#define BL_NODE_STATE_SELECTED               0x01
+#define BL_NODE_STATE_UNSELECTED             0x02
+#define BL_NODE_STATE_BROADCAST              0x03
+
+#define BL_BCAST_MAX_FRAMES                  512
+#define BL_BCAST_MAP_SIZE                    (BL_BCAST_MAX_FRAMES/8)
+#define BL_BCAST_STATUS_SIZE                 (2+BL_BCAST_MAP_SIZE)
+
+/**************************** CBL_READ_SECTOR_STATUS_CMD**************************/
+/* The state of the whole flash in one answer, so the host can plan an update
+ * without probing page by page:
+ *   [len][0x19][CRC32]
+ * answers, behind CBL_SEND_LONG_ACK,
+ *   [page count][WRPR u32][blank bitmap][page count x CRC32]
+ * WRPR is the write protection option byte register: bit n covers pages
+ * 4n..4n+3, a cleared bit protects them. Page n is blank when bit n%8 of
+ * bitmap byte n/8 is set. The page CRC is the one CBL_VERIFY_SEGMENTS_CMD
+ * computes over that single page. */
+#define BL_SECTOR_STATUS_HEADER_SIZE         5
+#define BL_SECTOR_STATUS_MAP_SIZE            (CBL_MAX_PAGE_NUMBER/8)
+#define BL_SECTOR_STATUS_REPLY_SIZE          (BL_SECTOR_STATUS_HEADER_SIZE+BL_SECTOR_STATUS_MAP_SIZE+(CBL_MAX_PAGE_NUMBER*CRC_TYPE_SIZE))
+/* Page CRCs sent with one BL_Transport_Send */
+#define BL_SECTOR_STATUS_CRC_CHUNK           8
+
+#define BL_PAGE_PROGRAMMED                   0x00
+#define BL_PAGE_BLANK                        0x01
+
+/**************************** CBL_BATCH_CMD**************************/
+/* Several queries in one round trip:
+ *   [len][0x2C][command]...[CRC32]
+ * The commands run in order and the reply holds [command][length][reply] for
+ * each of them. Only the queries without parameters can be batched:
+ * CBL_GET_VER_CMD, CBL_GET_HELP_CMD, CBL_GET_CID_CMD, CBL_GET_RDP_STATUS_CMD,
+ * CBL_EN_R_W_PROTECT_CMD and CBL_GET_SLOT_INFO_CMD. Any other command, and one
+ * whose reply does not fit behind the ones before, gets length 0. A frame with
+ * more than BL_BATCH_MAX_COMMANDS commands is NACKed and none of them runs. */
+#define BL_BATCH_MAX_COMMANDS                16
+#define BL_BATCH_ENTRY_HEADER_SIZE           2
+/* The longest query reply, the CBL_GET_HELP_CMD list */
+#define BL_QUERY_MAX_REPLY                   32
+
+/**************************** Signed images**************************/
+/* With BL_AUTH enabled the bootloader jumps into an image, or switches the boot
+ * slot to it, only after an ECDSA P-256 signature over the SHA-256 of its bytes
+ * checked fine against the key in bl_auth_key.h.
+ *   CBL_AUTH_VERIFY_CMD [len][0x2A][address u32][length u32][r 32][s 32][CRC32]
+ * answers [status][path][streamed bytes u32][hash cycles u32][verify cycles u32].
+ * The hash runs along with the writes: a write above the last hashed byte
+ * hashes the flash up to its end, a page left out in between included, so on
+ * BL_AUTH_PATH_STREAMED the command only hashes the bytes after the last
+ * write. A write below, an erase of hashed bytes or a reset make it read the
+ * whole image again, BL_AUTH_PATH_FULL. The cycles come from the DWT cycle
+ * counter, the hash cycles include the ones spent during the writes. Any write
+ * to flash or erase after the check takes the permission back. */
+#define BL_AUTH_DISABLE                      0x00
+#define BL_AUTH_ENABLE                       0x01
+#define BL_AUTH                              BL_AUTH_DISABLE
+
+#define BL_AUTH_HEADER_SIZE                  10
+#define BL_AUTH_REPLY_SIZE                   14
+
+#define BL_AUTH_FAILED                       0X00
+#define BL_AUTH_PASSED                       0X01
+
+#define BL_AUTH_PATH_FULL                    0x00
+#define BL_AUTH_PATH_STREAMED                0x01
+
+#define BL_AUTH_STREAM_EMPTY                 0x00
+#define BL_AUTH_STREAM_VALID                 0x01
+#define BL_AUTH_STREAM_BROKEN                0x02
+
+/**************************** Encrypted writes**************************/
+/* With BL_AES enabled images can travel AES-128-CTR encrypted with the key in
+ * bl_aes_key.h. CBL_MEM_WRITE_AES_CMD is CBL_MEM_WRITE_CMD with a nonce in
+ * front of the payload:
+ *   [len][0x2B][address u32][payload len][nonce 8][payload][CRC32]
+ * and the same one byte reply. Every frame carries its own nonce and starts at
+ * block counter 0, so frames decrypt in any order, alone or sent again. The
+ * payload is decrypted in place in BL_HOST_BUFFER and programmed like a plain
+ * write. CTR keeps the image secret but does not protect it, use BL_AUTH for
+ * that. The all-zero key is refused, every encrypted write then fails. */
+#define BL_AES_DISABLE                       0x00
+#define BL_AES_ENABLE                        0x01
+#define BL_AES                               BL_AES_DISABLE
+
+#define BL_AES_HEADER_SIZE                   (7 + BL_AES128_NONCE_SIZE)
+
+#define BL_AES_KEY_UNCHECKED                 0x00
+#define BL_AES_KEY_READY                     0x01
+#define BL_AES_KEY_ZERO                      0x02
+
+/**************************** Startup **************************/
+/* After a reset the bootloader listens this long for a host byte. When none
+ * comes it starts the image in the boot slot, see BL_Start_Application. */
+#define BL_BOOT_WINDOW_MS                    1000U
+
+/**************************** Watchdog**************************/
+/* With BL_IWDG enabled the independent watchdog supervises update sessions.
+ * The first complete frame starts it and every later complete frame refreshes
+ * it, so a bootloader no host talks to still sleeps without it. A host that
+ * stops in the middle of a session, or a frame that never ends, lets it run
+ * out. After that reset the bootloader starts the application at once when
+ * the boot selector marks it complete and stays otherwise, so an interrupted
+ * update is not started, see BL_Check_Watchdog_Reset. The timeout has to cover the longest command,
+ * an erase of every page at the datasheet worst case of 40 ms per page, and it
+ * is computed for the fastest LSI (60 kHz), at the typical 40 kHz it is half
+ * as long again. A signature check (BL_AUTH) takes about 2 s, an AES frame a
+ * few ms. The watchdog cannot be stopped: an application started with
+ * CBL_GO_TO_ADDR_CMD has to refresh it, otherwise it comes back through a
+ * watchdog reset, this time without it. */
+#define BL_IWDG_DISABLE                      0x00
+#define BL_IWDG_ENABLE                       0x01
+#define BL_IWDG                              BL_IWDG_DISABLE
+
+#define BL_IWDG_PAGE_ERASE_MAX_MS            40U
+#define BL_IWDG_TIMEOUT_MS                   ((CBL_MAX_PAGE_NUMBER*BL_IWDG_PAGE_ERASE_MAX_MS)+2000U)
+#define BL_IWDG_LSI_MAX_HZ                   60000U
+#define BL_IWDG_PRESCALER_DIV                256U
+#define BL_IWDG_RELOAD                       ((BL_IWDG_TIMEOUT_MS*(BL_IWDG_LSI_MAX_HZ/1000U))/BL_IWDG_PRESCALER_DIV)
+#if (BL_IWDG_RELOAD > 0xFFFU)
+#error "BL_IWDG_TIMEOUT_MS does not fit the 12 bit reload value"
+#endif
+
+#define BL_IWDG_STOPPED                      0x00
+#define BL_IWDG_RUNNING                      0x01
 /*------------------ MACRO FUNCTIONS END ---------------------*/
 
 void BL_Print_Message(char *format, ...);
@@ -146,12 +427,45 @@ typedef  void  (*Jump_Ptr)(void);
 void BL_Print_Message(char *format, ...);
 
 /**
- * @brief Fetches a command from the host via UART.
+ * @brief Fetches a command from the host over BL_TRANSPORT.
  *
  * @return The status of the command fetch operation.
  */
 BL_status BL_UART_FETCH_HOST_COMMAND(void);
 
+/**
+ * @brief With BL_IWDG enabled: starts the application at once when the
+ *        last reset came from the watchdog, that is when an update session
+ *        hung, and clears the reset flags. An image the update left open
+ *        is not started, the bootloader waits for the host then. A request in the mailbox wins, the
+ *        application asked for the bootloader. Call it before
+ *        BL_Transport_Open, nothing runs on interrupts yet.
+ */
+void BL_Check_Watchdog_Reset(void);
+
+/**
+ * @brief Decides at startup whether the bootloader stays: it starts the
+ *        application in the boot slot unless the mailbox held a request, no
+ *        slot holds a complete image, or a host byte comes within
+ *        BL_BOOT_WINDOW_MS. That byte starts the first frame. Call it after
+ *        BL_Take_Mailbox_Request.
+ */
+void BL_Start_Application(void);
+
+/**
+ * @brief Takes an update request the application left in the mailbox, see
+ *        bl_mailbox.h: sets the link speed, loads the session key and clears
+ *        the mailbox. Call it after BL_Transport_Open.
+ */
+void BL_Take_Mailbox_Request(void);
+
+/**
+ * @brief Address of this node on a shared bus, the unique ID folded to 16 bits.
+ *
+ * @return The address, never BL_NODE_ANY or BL_NODE_BROADCAST.
+ */
+uint16_t BL_Get_Node_Address(void);
+
 
 
 
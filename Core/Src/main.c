@@ -56,8 +56,7 @@ void SystemClock_Config(void);
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
-char message_1[]= "I am Romany Sobhy%d\r\n";
-char message_2[]= "I am Fine%d\r\n";
+
 /* USER CODE END 0 */
 
 /**
@@ -67,7 +66,7 @@ char message_2[]= "I am Fine%d\r\n";
 int main(void)
 {
   /* USER CODE BEGIN 1 */
-uint32_t number=0;
+
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -93,10 +92,15 @@ uint32_t number=0;
   MX_CRC_Init();
   /* USER CODE BEGIN 2 */
 BL_status status=BL_NACK;
+	BL_Check_Watchdog_Reset();
+	BL_Transport_Open();
+	BL_Take_Mailbox_Request();
+	BL_Start_Application();
   /* USER CODE END 2 */
 	
 	 #if (BL_DEBUG_ENABLE == DEBUG_INFO_ENABLE)
 	BL_Print_Message("Bootloader started...\r\n");
+	BL_Print_Message("Node address 0x%04X\r\n", BL_Get_Node_Address());
 	 #endif
 
   /* Infinite loop */
@@ -106,11 +110,7 @@ BL_status status=BL_NACK;
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
-  BL_Print_Message(message_1,number);
-	HAL_Delay(500);
-	BL_Print_Message(message_2,number);
-	HAL_Delay(500);
-		number++;
+	/* Sleeps in the transport until the next frame is there */
 	status=BL_UART_FETCH_HOST_COMMAND();
 	}
 	
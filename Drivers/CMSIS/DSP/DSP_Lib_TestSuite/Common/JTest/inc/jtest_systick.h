@@ -40,6 +40,8 @@
   #include "ARMv8MML_DP.h"
 #elif defined ARMv8MML_DSP_DP
   #include "ARMv8MML_DSP_DP.h"
+#elif defined JTEST_HOST
+  #include "jtest_host.h"
 
 #else
   #warning "no appropriate header file found!"
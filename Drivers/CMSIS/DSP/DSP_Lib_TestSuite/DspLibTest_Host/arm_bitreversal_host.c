@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------
+ * Title:        arm_bitreversal_host.c
+ * Description:  C version of arm_bitreversal2.S for the host build.
+ *               The table holds pairs of byte offsets into the buffer as
+ *               if every complex element took 8 bytes; each pair names two
+ *               complex elements that swap places.
+ * -------------------------------------------------------------------- */
+
+#include "arm_math.h"
+
+void arm_bitreversal_32(
+        uint32_t *pSrc,
+  const uint16_t bitRevLen,
+  const uint16_t *pBitRevTable)
+{
+  uint32_t a, b, i, tmp;
+
+  for (i = 0; i < bitRevLen; i += 2)
+  {
+    a = pBitRevTable[i    ] >> 2;
+    b = pBitRevTable[i + 1] >> 2;
+
+    /* real */
+    tmp = pSrc[a];
+    pSrc[a] = pSrc[b];
+    pSrc[b] = tmp;
+
+    /* imaginary */
+    tmp = pSrc[a + 1];
+    pSrc[a + 1] = pSrc[b + 1];
+    pSrc[b + 1] = tmp;
+  }
+}
+
+void arm_bitreversal_16(
+        uint16_t *pSrc,
+  const uint16_t bitRevLen,
+  const uint16_t *pBitRevTable)
+{
+  uint32_t a, b, i;
+  uint16_t tmp;
+
+  for (i = 0; i < bitRevLen; i += 2)
+  {
+    /* q15 elements take 4 bytes, the offsets are halved */
+    a = pBitRevTable[i    ] >> 2;
+    b = pBitRevTable[i + 1] >> 2;
+
+    /* real */
+    tmp = pSrc[a];
+    pSrc[a] = pSrc[b];
+    pSrc[b] = tmp;
+
+    /* imaginary */
+    tmp = pSrc[a + 1];
+    pSrc[a + 1] = pSrc[b + 1];
+    pSrc[b + 1] = tmp;
+  }
+}
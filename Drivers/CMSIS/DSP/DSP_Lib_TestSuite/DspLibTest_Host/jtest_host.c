@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "jtest.h"
+#include "all_tests.h"
+#include "jtest_host.h"
+
+/*--------------------------------------------------------------------------------*/
+/* Module Variables */
+/*--------------------------------------------------------------------------------*/
+
+static JTEST_HOST_SysTick_t jtest_host_systick_regs = {0};
+static uint64_t jtest_host_systick_start_ns = 0;
+
+/*--------------------------------------------------------------------------------*/
+/* Host SysTick */
+/*--------------------------------------------------------------------------------*/
+
+static uint64_t jtest_host_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * UINT64_C(1000000000)) + (uint64_t) now.tv_nsec;
+}
+
+JTEST_HOST_SysTick_t * jtest_host_systick(void)
+{
+    uint64_t elapsed_ns;
+
+    if ((jtest_host_systick_regs.CTRL & SysTick_CTRL_ENABLE_Msk) == 0)
+    {
+        /* Stopped: the access may be the one that starts it. */
+        jtest_host_systick_start_ns = jtest_host_now_ns();
+    }
+    else
+    {
+        elapsed_ns = jtest_host_now_ns() - jtest_host_systick_start_ns;
+        jtest_host_systick_regs.VAL =
+            (elapsed_ns < jtest_host_systick_regs.LOAD) ?
+            (uint32_t) (jtest_host_systick_regs.LOAD - elapsed_ns) : 0;
+    }
+
+    return &jtest_host_systick_regs;
+}
+
+/*--------------------------------------------------------------------------------*/
+/* Debugger Actions */
+/*--------------------------------------------------------------------------------*/
+
+/*
+  On the target the Keil debugger sets breakpoints on these functions and reads
+  JTEST_FW. On the host they print the output and end the run.
+*/
+
+void test_start    (void) {
+  JTEST_FW.test_start++;
+}
+
+void test_end      (void) {
+  JTEST_FW.test_end++;
+}
+
+void group_start   (void) {
+  JTEST_FW.group_start++;
+}
+
+void group_end     (void) {
+  JTEST_FW.group_end++;
+}
+
+void dump_str      (void) {
+  JTEST_FW.dump_str++;
+  printf("%.*s", JTEST_STR_MAX_OUTPUT_SIZE, (const char *) JTEST_FW.str_buffer);
+}
+
+void dump_data     (void) {
+  JTEST_FW.dump_data++;
+}
+
+void exit_fw       (void) {
+  JTEST_FW.exit_fw++;
+  printf("\nTests passed: %u, failed: %u\n",
+         (unsigned) JTEST_FW.passed, (unsigned) JTEST_FW.failed);
+  fflush(stdout);
+  exit((JTEST_FW.failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*--------------------------------------------------------------------------------*/
+/* Main */
+/*--------------------------------------------------------------------------------*/
+
+int main(void)
+{
+    JTEST_INIT();               /* Initialize test framework. */
+
+    JTEST_GROUP_CALL(all_tests); /* Run all tests. */
+
+    JTEST_ACT_EXIT_FW();        /* Exit test framework.  */
+    return EXIT_FAILURE;        /* exit_fw() does not return. */
+}
@@ -0,0 +1,40 @@
+#ifndef _JTEST_HOST_H_
+#define _JTEST_HOST_H_
+
+/*--------------------------------------------------------------------------------*/
+/* Includes */
+/*--------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*--------------------------------------------------------------------------------*/
+/* Host SysTick */
+/*--------------------------------------------------------------------------------*/
+
+/**
+ *  Stand-in for the SysTick registers used by JTEST_COUNT_CYCLES().
+ *
+ *  Every access goes through jtest_host_systick(), which counts VAL down in
+ *  nanoseconds of host time while CTRL is enabled. The "Cycles:" lines of a
+ *  host run therefore hold nanoseconds, and saturate at 0 after
+ *  JTEST_SYSTICK_INITIAL_VALUE (about 16.7 ms).
+ */
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t LOAD;
+    volatile uint32_t VAL;
+} JTEST_HOST_SysTick_t;
+
+#define SysTick_CTRL_ENABLE_Msk     (1UL << 0)
+#define SysTick_CTRL_CLKSOURCE_Msk  (1UL << 2)
+
+#define SysTick (jtest_host_systick())
+
+/*--------------------------------------------------------------------------------*/
+/* Function Prototypes */
+/*--------------------------------------------------------------------------------*/
+
+JTEST_HOST_SysTick_t * jtest_host_systick(void);
+
+#endif /* _JTEST_HOST_H_ */
@@ -16,6 +16,7 @@ void ref_sin_cos_q31(
   q31_t * pCosVal)
 {
 	//theta is given in the range [-1,1) to represent [-pi,pi)
-	*pSinVal = (q31_t)(sinf((float32_t)theta * 3.14159265358979f / 2147483648.0f) * 2147483648.0f);
-	*pCosVal = (q31_t)(cosf((float32_t)theta * 3.14159265358979f / 2147483648.0f) * 2147483648.0f);
+	//1.0 itself does not fit, saturate it like the Arm float to integer conversion does
+	*pSinVal = ref_sat_q31((q63_t)(sinf((float32_t)theta * 3.14159265358979f / 2147483648.0f) * 2147483648.0f));
+	*pCosVal = ref_sat_q31((q63_t)(cosf((float32_t)theta * 3.14159265358979f / 2147483648.0f) * 2147483648.0f));
 }
@@ -0,0 +1,1131 @@
+import os
+import sys
+import tty
+import struct
+import argparse
+import time
+import random
+import select
+import hashlib
+
+''' Simulated STM32F103 bootloader behind a pseudo-terminal, for Host.py regression and speed tests.
+    The frame format, the replies and the flash rules follow Bootloader/bootloader.c. '''
+
+''' Bootloader Commands '''
+CBL_GET_VER_CMD              = 0x10
+CBL_GET_HELP_CMD             = 0x11
+CBL_GET_CID_CMD              = 0x12
+CBL_GET_RDP_STATUS_CMD       = 0x13
+CBL_GO_TO_ADDR_CMD           = 0x14
+CBL_FLASH_ERASE_CMD          = 0x15
+CBL_MEM_WRITE_CMD            = 0x16
+CBL_EN_R_W_PROTECT_CMD       = 0x17
+CBL_MEM_READ_CMD             = 0x18
+CBL_READ_SECTOR_STATUS_CMD   = 0x19
+CBL_OTP_READ_CMD             = 0x20
+CBL_CHANGE_ROP_LEVEL_CMD     = 0x21
+CBL_GET_SLOT_INFO_CMD        = 0x22
+CBL_SWITCH_SLOT_CMD          = 0x23
+CBL_MEM_WRITE_LZ_CMD         = 0x24
+CBL_MEM_WRITE_RLE_CMD        = 0x25
+CBL_VERIFY_SEGMENTS_CMD      = 0x26
+CBL_MEM_WRITE_SEQ_CMD        = 0x27
+CBL_NODE_SELECT_CMD          = 0x28
+CBL_BCAST_STATUS_CMD         = 0x29
+CBL_AUTH_VERIFY_CMD          = 0x2A
+CBL_MEM_WRITE_AES_CMD        = 0x2B
+CBL_BATCH_CMD                = 0x2C
+
+CBL_VERSION                  = bytes([100, 1, 0, 0])
+CBL_SEND_ACK                 = 0xAB
+CBL_SEND_NACK                = 0xCD
+CBL_SEND_LONG_ACK            = 0xAC
+CRC_TYPE_SIZE                = 4
+
+''' DBGMCU->IDCODE device ID of the medium density STM32F103 '''
+STM32F103_DEVICE_ID          = 0x410
+
+''' Memory map, must match bootloader.h '''
+STM32F103_FLASH_BASE         = 0x08000000
+STM32F103_SRAM_BASE          = 0x20000000
+STM32F103_SRAM_SIZE          = 20 * 1024
+APP_BASE_ADDRESS             = 0x08008000
+FLASH_PAGE_SIZE              = 0x400
+CBL_BOOTLOADER_PAGES         = (APP_BASE_ADDRESS - STM32F103_FLASH_BASE) // FLASH_PAGE_SIZE
+CBL_MASS_ERASE               = 0xFF
+
+BL_SLOT_A                    = 0x00
+BL_SLOT_B                    = 0x01
+BL_SLOT_NONE                 = 0xFF
+BL_SLOT_SIZE                 = 47 * FLASH_PAGE_SIZE
+BL_BOOT_SELECTOR_RECORDS     = {0xA50A : BL_SLOT_A, 0xA50B : BL_SLOT_B}
+BL_BOOT_SELECTOR_OPEN_RECORDS = {0x5A0A : BL_SLOT_A, 0x5A0B : BL_SLOT_B}
+BL_SLOT_STATE_UNKNOWN        = 0x00
+BL_SLOT_STATE_OPEN           = 0x01
+BL_SLOT_STATE_COMPLETE       = 0x02
+
+ADDRESS_VALID                = 0x01
+ADDRESS_NOT_VALID            = 0x00
+UNSUCCESSFUL_ERASE           = 0x02
+SUCCESSFUL_ERASE             = 0x03
+FLASH_PAYLOAD_WRITE_FAILED   = 0x00
+FLASH_PAYLOAD_WRITE_PASSED   = 0x01
+SEGMENT_CRC_FAILED           = 0x00
+SEGMENT_CRC_PASSED           = 0x01
+BL_SLOT_SWITCH_FAILED        = 0x00
+BL_SLOT_SWITCH_PASSED        = 0x01
+ROP_LEVEL_CHANGE_FAILED      = 0x00
+ROP_LEVEL_CHANGE_PASSED      = 0x01
+
+''' Read protection as reported by CBL_GET_RDP_STATUS_CMD and CBL_EN_R_W_PROTECT_CMD '''
+RDP_STATUS_CODES             = {0 : 0xAA, 1 : 0x55}
+OB_RDP_LEVEL_0               = 0xA5
+OB_RDP_LEVEL_1               = 0x00
+
+BL_HOST_BUFFER_LENGTH        = 200
+BL_BATCH_MAX_COMMANDS        = 16
+BL_BATCH_ENTRY_HEADER_SIZE   = 2
+''' BL_INTER_BYTE_TIMEOUT_MS, real time like the host timeouts it plays against '''
+BL_INTER_BYTE_TIMEOUT        = 0.010
+BL_SEGMENT_DESCRIPTOR_SIZE   = 8
+BL_MAX_SEGMENTS              = (BL_HOST_BUFFER_LENGTH - (4 + CRC_TYPE_SIZE + CRC_TYPE_SIZE)) // BL_SEGMENT_DESCRIPTOR_SIZE
+
+BL_LZ_WINDOW_SIZE            = 256
+BL_LZ_MAX_FRAME_OUTPUT       = 512
+LZ_TOKEN_MATCH_FLAG          = 0x80
+LZ_MIN_MATCH_LENGTH          = 3
+
+BL_SEQ_HEADER_SIZE           = 9
+BL_SEQ_HISTORY_SIZE          = 32
+
+''' Shared bus nodes, must match bootloader.h '''
+BL_NODE_BROADCAST            = 0xFFFF
+BL_NODE_ANY                  = 0x0000
+BL_NODE_SELECTED             = 0x01
+BL_NODE_STATE_ALL            = 0x00
+BL_NODE_STATE_SELECTED       = 0x01
+BL_NODE_STATE_UNSELECTED     = 0x02
+BL_NODE_STATE_BROADCAST      = 0x03
+BL_BCAST_MAX_FRAMES          = 512
+''' Commands a node takes while a broadcast selects it '''
+BL_BCAST_COMMANDS            = (CBL_NODE_SELECT_CMD, CBL_FLASH_ERASE_CMD, CBL_MEM_WRITE_SEQ_CMD)
+''' Signed images, must match bootloader.h '''
+BL_AUTH_HEADER_SIZE          = 10
+BL_AUTH_FAILED               = 0x00
+BL_AUTH_PASSED               = 0x01
+BL_AUTH_PATH_FULL            = 0x00
+BL_AUTH_PATH_STREAMED        = 0x01
+BL_AUTH_STREAM_EMPTY         = 0x00
+BL_AUTH_STREAM_VALID         = 0x01
+BL_AUTH_STREAM_BROKEN        = 0x02
+P256_P                       = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF
+P256_N                       = 0xFFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551
+P256_B                       = 0x5AC635D8AA3A93E7B3EBBD55769886BC651D06B0CC53B0F63BCE3C3E27D2604B
+P256_G                       = (0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296,
+                                0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5)
+''' Encrypted writes, must match bootloader.h '''
+BL_AES_NONCE_SIZE            = 8
+BL_AES_HEADER_SIZE           = 7 + BL_AES_NONCE_SIZE
+''' UID_BASE of the single simulated device, every bus node gets its own '''
+BL_DEFAULT_UNIQUE_ID         = bytes.fromhex('30ff450031354e3342578243')
+
+RLE_TOKEN_TYPE_MASK_LITERAL  = 0x80
+RLE_TOKEN_TYPE_MASK_RUN      = 0xC0
+RLE_TOKEN_LITERAL            = 0x00
+RLE_TOKEN_SKIP               = 0x80
+RLE_TOKEN_FILL               = 0xC0
+RLE_TOKEN_RUN_MASK           = 0x3F
+
+''' F1 datasheet typical timing, tERASE and tPROG '''
+FLASH_PAGE_ERASE_TIME        = 0.020
+FLASH_HALFWORD_PROGRAM_TIME  = 0.0000525
+FLASH_CRC_BYTE_TIME          = 0.000001
+UART_BITS_PER_BYTE           = 10
+
+''' Cycle model of bl_sha256.c and bl_ecdsa_p256.c on the 8 MHz core, the reply reports these in place of DWT counts '''
+BL_CORE_CLOCK                = 8000000
+SHA256_CYCLES_PER_BYTE       = 45
+ECDSA_P256_VERIFY_CYCLES     = 8000000
+AES128_CYCLES_PER_BYTE       = 50
+
+''' Start-up of main() after an injected reset, clocks and HAL init, before the UART listens again '''
+BL_BOOT_TIME                 = 0.010
+
+CRC32_POLYNOMIAL             = 0x04C11DB7
+
+def Build_CRC32_Table(Byte_Position):
+    ''' The CRC unit shifts a whole 32-bit word per byte, so every byte of the register needs its own table '''
+    Table = []
+    for Value in range(256):
+        CRC = Value << (8 * Byte_Position)
+        for Bit in range(32):
+            if(CRC & 0x80000000):
+                CRC = ((CRC << 1) ^ CRC32_POLYNOMIAL) & 0xFFFFFFFF
+            else:
+                CRC = (CRC << 1) & 0xFFFFFFFF
+        Table.append(CRC)
+    return Table
+
+CRC32_TABLES = [Build_CRC32_Table(Byte_Position) for Byte_Position in range(4)]
+
+def Calculate_CRC32(Buffer, CRC = 0xFFFFFFFF):
+    ''' Same result as HAL_CRC_Accumulate fed with one byte per 32-bit word '''
+    Table_0, Table_1, Table_2, Table_3 = CRC32_TABLES
+    for Data_Byte in Buffer:
+        CRC = CRC ^ Data_Byte
+        CRC = Table_0[CRC & 0xFF] ^ Table_1[(CRC >> 8) & 0xFF] ^ Table_2[(CRC >> 16) & 0xFF] ^ Table_3[CRC >> 24]
+    return CRC
+
+def P256_Add(Point_1, Point_2):
+    ''' Affine point addition on P-256, None is the point at infinity '''
+    if(Point_1 is None):
+        return Point_2
+    if(Point_2 is None):
+        return Point_1
+    if(Point_1[0] == Point_2[0]):
+        if((Point_1[1] + Point_2[1]) % P256_P == 0):
+            return None
+        Slope = (3 * Point_1[0] * Point_1[0] - 3) * pow(2 * Point_1[1], -1, P256_P) % P256_P
+    else:
+        Slope = (Point_2[1] - Point_1[1]) * pow(Point_2[0] - Point_1[0], -1, P256_P) % P256_P
+    X = (Slope * Slope - Point_1[0] - Point_2[0]) % P256_P
+    return (X, (Slope * (Point_1[0] - X) - Point_1[1]) % P256_P)
+
+def P256_Multiply(Scalar, Point):
+    Result = None
+    for Bit in bin(Scalar)[2:]:
+        Result = P256_Add(Result, Result)
+        if(Bit == '1'):
+            Result = P256_Add(Result, Point)
+    return Result
+
+def ECDSA_P256_Verify(Public_Key, Digest, Signature):
+    ''' BL_ECDSA_P256_Verify: Public_Key is X || Y, Signature is r || s, all big endian '''
+    X, Y = int.from_bytes(Public_Key[:32], 'big'), int.from_bytes(Public_Key[32:], 'big')
+    R, S = int.from_bytes(Signature[:32], 'big'), int.from_bytes(Signature[32:], 'big')
+    if(not (X < P256_P and Y < P256_P and (Y * Y - X * X * X + 3 * X - P256_B) % P256_P == 0)):
+        return False
+    if(not (1 <= R < P256_N and 1 <= S < P256_N)):
+        return False
+    W = pow(S, -1, P256_N)
+    Point = P256_Add(P256_Multiply(int.from_bytes(Digest, 'big') * W % P256_N, P256_G), P256_Multiply(R * W % P256_N, (X, Y)))
+    return Point is not None and Point[0] % P256_N == R
+
+def Build_AES_Tables():
+    ''' S-box from the inverse in GF(2^8) walked with the generator 3, and the T-table of bl_aes128.c '''
+    Sbox = [0x63] * 256
+    P = Q = 1
+    while True:
+        P = P ^ ((P << 1) & 0xFF) ^ (0x1B if P & 0x80 else 0)
+        Q = Q ^ (Q << 1)
+        Q = Q ^ (Q << 2)
+        Q = (Q ^ (Q << 4)) & 0xFF
+        if(Q & 0x80):
+            Q = Q ^ 0x09
+        Affine = Q
+        for Shift in range(1, 5):
+            Affine = Affine ^ (((Q << Shift) | (Q >> (8 - Shift))) & 0xFF)
+        Sbox[P] = Affine ^ 0x63
+        if(P == 1):
+            break
+    Double = [((Value << 1) ^ (0x1B if Value & 0x80 else 0)) & 0xFF for Value in Sbox]
+    Te0 = [(Double[Index] << 24) | (Sbox[Index] << 16) | (Sbox[Index] << 8) | (Double[Index] ^ Sbox[Index]) for Index in range(256)]
+    return Sbox, Te0
+
+AES_SBOX, AES_TE0 = Build_AES_Tables()
+
+def AES128_Expand_Key(Key):
+    Round_Key = list(struct.unpack('>4I', Key))
+    Rcon = 1
+    for Round in range(10):
+        Word = Round_Key[-1]
+        Word = ((AES_SBOX[(Word >> 16) & 0xFF] << 24) | (AES_SBOX[(Word >> 8) & 0xFF] << 16) |
+                (AES_SBOX[Word & 0xFF] << 8) | AES_SBOX[Word >> 24]) ^ (Rcon << 24)
+        Round_Key.append(Round_Key[-4] ^ Word)
+        for Index in range(3):
+            Round_Key.append(Round_Key[-4] ^ Round_Key[-1])
+        Rcon = ((Rcon << 1) ^ (0x1B if Rcon & 0x80 else 0)) & 0xFF
+    return Round_Key
+
+def AES128_Encrypt_Block(Round_Key, Block):
+    def Rotate(Value, Shift):
+        return ((Value >> Shift) | (Value << (32 - Shift))) & 0xFFFFFFFF
+    State = [Word ^ Round_Key[Index] for Index, Word in enumerate(struct.unpack('>4I', Block))]
+    for Round in range(1, 10):
+        State = [AES_TE0[State[Index] >> 24] ^ Rotate(AES_TE0[(State[(Index + 1) % 4] >> 16) & 0xFF], 8) ^
+                 Rotate(AES_TE0[(State[(Index + 2) % 4] >> 8) & 0xFF], 16) ^ Rotate(AES_TE0[State[(Index + 3) % 4] & 0xFF], 24) ^
+                 Round_Key[4 * Round + Index] for Index in range(4)]
+    return struct.pack('>4I', *[(AES_SBOX[State[Index] >> 24] << 24) ^ (AES_SBOX[(State[(Index + 1) % 4] >> 16) & 0xFF] << 16) ^
+                                (AES_SBOX[(State[(Index + 2) % 4] >> 8) & 0xFF] << 8) ^ AES_SBOX[State[(Index + 3) % 4] & 0xFF] ^
+                                Round_Key[40 + Index] for Index in range(4)])
+
+def AES128_CTR_Xor(Round_Key, Nonce, Data):
+    ''' BL_AES128_CTR_Xor '''
+    Key_Stream = b''.join(AES128_Encrypt_Block(Round_Key, Nonce + struct.pack('>Q', Counter))
+                          for Counter in range((len(Data) + 15) // 16))
+    return bytes(Value ^ Key_Stream[Index] for Index, Value in enumerate(Data))
+
+def Node_Address_Of(Unique_ID):
+    ''' BL_Get_Node_Address: the three ID words folded to 16 bits '''
+    Words = struct.unpack('<III', Unique_ID)
+    Folded = Words[0] ^ Words[1] ^ Words[2]
+    Address = (Folded ^ (Folded >> 16)) & 0xFFFF
+    return 0x0001 if Address in (BL_NODE_ANY, BL_NODE_BROADCAST) else Address
+
+def Command_Name(Frame):
+    ''' The command code for the log, a frame cut right after its length byte has none '''
+    return "0x{:02x}".format(Frame[1]) if len(Frame) > 1 else "----"
+
+class BL_Flash_Model:
+    ''' F1 flash: page erase to 0xFF, half-word programming only, and a half-word that is not erased
+        can only be programmed to 0x0000 (PGERR otherwise). Busy_Time collects the time the work takes.
+        WRP is the option byte register, pages whose bit is cleared are neither erased nor programmed (WRPRTERR). '''
+    def __init__(self, Size, WRP = 0xFFFFFFFF):
+        self.Size = Size
+        self.Memory = bytearray(b'\xff' * Size)
+        self.WRP = WRP
+        self.Busy_Time = 0
+        ''' Half-words left before an injected reset stops programming, None when no reset is pending '''
+        self.Program_Budget = None
+
+    def Contains(self, Address, Length = 1):
+        return STM32F103_FLASH_BASE <= Address and Address + Length <= STM32F103_FLASH_BASE + self.Size
+
+    def Read(self, Address, Length):
+        Offset = Address - STM32F103_FLASH_BASE
+        return bytes(self.Memory[Offset : Offset + Length])
+
+    def Is_Protected(self, Page_Index):
+        ''' WRPR bit n covers pages 4n..4n+3, the last bit all pages above '''
+        return not (self.WRP >> min(Page_Index // 4, 31)) & 1
+
+    def Erase_Pages(self, First_Page, Page_Count):
+        for Page_Index in range(First_Page, First_Page + Page_Count):
+            if(not self.Is_Protected(Page_Index)):
+                Offset = Page_Index * FLASH_PAGE_SIZE
+                self.Memory[Offset : Offset + FLASH_PAGE_SIZE] = b'\xff' * FLASH_PAGE_SIZE
+        self.Busy_Time = self.Busy_Time + Page_Count * FLASH_PAGE_ERASE_TIME
+
+    def Program_Halfword(self, Address, Value):
+        Offset = Address - STM32F103_FLASH_BASE
+        if(self.Is_Protected(Offset // FLASH_PAGE_SIZE)):
+            return False
+        Current = struct.unpack_from('<H', self.Memory, Offset)[0]
+        if(self.Program_Budget is not None):
+            if(self.Program_Budget == 0):
+                return False
+            self.Program_Budget = self.Program_Budget - 1
+        self.Busy_Time = self.Busy_Time + FLASH_HALFWORD_PROGRAM_TIME
+        if(Current != 0xFFFF and Value != 0x0000):
+            return False
+        struct.pack_into('<H', self.Memory, Offset, Value)
+        return True
+
+class BL_Simulated_Device:
+    ''' Command engine of the bootloader. Handle_Frame returns the ACK (or NACK) and the reply separately,
+        the flash work sits between them exactly like in the firmware handlers. '''
+    def __init__(self, Dual_Slot = False, Verbose = False, Unique_ID = BL_DEFAULT_UNIQUE_ID, Auth_Key = None, AES_Key = None, WRP = 0xFFFFFFFF):
+        self.Dual_Slot = Dual_Slot
+        ''' Key of a BL_AES build, the all-zero placeholder fails every encrypted write like the firmware '''
+        self.AES_Round_Key = AES128_Expand_Key(AES_Key) if AES_Key is not None and any(AES_Key) else None
+        ''' Public key of a BL_AUTH build, None for a build without signed images '''
+        self.Auth_Key = Auth_Key
+        self.Auth_Status = BL_AUTH_FAILED
+        self.Auth_Image = (0, 0)
+        self.Auth_Stream = None
+        self.Auth_Stream_State = BL_AUTH_STREAM_EMPTY
+        self.Auth_Stream_Start = 0
+        self.Auth_Stream_End = 0
+        self.Auth_Hash_Cycles = 0
+        self.Verbose = Verbose
+        self.Node_Address = Node_Address_Of(Unique_ID)
+        self.Node_State = BL_NODE_STATE_ALL
+        ''' Sequence numbers written fine since the last erase, the bitmap of CBL_BCAST_STATUS_CMD '''
+        self.Bcast_Received = set()
+        self.Log_Prefix = ""
+        self.Flash = BL_Flash_Model((128 if Dual_Slot else 64) * 1024, WRP)
+        self.SRAM = bytearray(STM32F103_SRAM_SIZE)
+        self.RDP_Level = 0
+        self.Erased_Pages = set()
+        self.Update_Slot = BL_SLOT_NONE
+        self.Opened_Slot = BL_SLOT_NONE
+        self.LZ_Window = bytearray(BL_LZ_WINDOW_SIZE)
+        self.LZ_Window_Pos = 0
+        self.LZ_History = 0
+        self.LZ_Next_Address = 0
+        self.Seq_History = []
+        self.Handlers = {
+            CBL_GET_VER_CMD            : self.Handle_GET_VER,
+            CBL_GET_HELP_CMD           : self.Handle_GET_HELP,
+            CBL_GET_CID_CMD            : self.Handle_GET_CID,
+            CBL_GET_RDP_STATUS_CMD     : self.Handle_GET_RDP_STATUS,
+            CBL_GO_TO_ADDR_CMD         : self.Handle_GO_TO_ADDR,
+            CBL_FLASH_ERASE_CMD        : self.Handle_FLASH_ERASE,
+            CBL_MEM_WRITE_CMD          : self.Handle_MEM_WRITE,
+            CBL_EN_R_W_PROTECT_CMD     : self.Handle_EN_R_W_PROTECT,
+            CBL_CHANGE_ROP_LEVEL_CMD   : self.Handle_CHANGE_ROP_LEVEL,
+            CBL_MEM_WRITE_LZ_CMD       : self.Handle_MEM_WRITE_LZ,
+            CBL_MEM_WRITE_RLE_CMD      : self.Handle_MEM_WRITE_RLE,
+            CBL_VERIFY_SEGMENTS_CMD    : self.Handle_VERIFY_SEGMENTS,
+            CBL_MEM_WRITE_SEQ_CMD      : self.Handle_MEM_WRITE_SEQ,
+            CBL_NODE_SELECT_CMD        : self.Handle_NODE_SELECT,
+            CBL_BCAST_STATUS_CMD       : self.Handle_BCAST_STATUS,
+            CBL_READ_SECTOR_STATUS_CMD : self.Handle_READ_SECTOR_STATUS,
+            CBL_BATCH_CMD              : self.Handle_BATCH,
+        }
+        ''' Bootloader_Query_Reply, the queries CBL_BATCH_CMD runs '''
+        self.Query_Commands = {CBL_GET_VER_CMD, CBL_GET_HELP_CMD, CBL_GET_CID_CMD, CBL_GET_RDP_STATUS_CMD, CBL_EN_R_W_PROTECT_CMD}
+        if(Dual_Slot):
+            self.Handlers[CBL_GET_SLOT_INFO_CMD] = self.Handle_GET_SLOT_INFO
+            self.Handlers[CBL_SWITCH_SLOT_CMD] = self.Handle_SWITCH_SLOT
+            self.Query_Commands.add(CBL_GET_SLOT_INFO_CMD)
+        if(Auth_Key is not None):
+            self.Handlers[CBL_AUTH_VERIFY_CMD] = self.Handle_AUTH_VERIFY
+        if(AES_Key is not None):
+            self.Handlers[CBL_MEM_WRITE_AES_CMD] = self.Handle_MEM_WRITE_AES
+        ''' CBL_MEM_READ_CMD and CBL_OTP_READ_CMD are still empty in the firmware,
+            they are listed by CBL_GET_HELP_CMD but never answer '''
+        self.Supported_CMDs = bytes([CBL_GET_VER_CMD, CBL_GET_HELP_CMD, CBL_GET_CID_CMD, CBL_GET_RDP_STATUS_CMD,
+                                     CBL_GO_TO_ADDR_CMD, CBL_FLASH_ERASE_CMD, CBL_MEM_WRITE_CMD, CBL_EN_R_W_PROTECT_CMD,
+                                     CBL_MEM_READ_CMD, CBL_READ_SECTOR_STATUS_CMD, CBL_OTP_READ_CMD, CBL_CHANGE_ROP_LEVEL_CMD,
+                                     CBL_MEM_WRITE_LZ_CMD, CBL_MEM_WRITE_RLE_CMD, CBL_VERIFY_SEGMENTS_CMD, CBL_MEM_WRITE_SEQ_CMD,
+                                     CBL_NODE_SELECT_CMD, CBL_BCAST_STATUS_CMD] +
+                                    ([CBL_AUTH_VERIFY_CMD] if Auth_Key is not None else []) +
+                                    ([CBL_MEM_WRITE_AES_CMD] if AES_Key is not None else []) + [CBL_BATCH_CMD] +
+                                    ([CBL_GET_SLOT_INFO_CMD, CBL_SWITCH_SLOT_CMD] if Dual_Slot else []))
+
+    def Log(self, Message):
+        if(self.Verbose):
+            sys.stderr.write(self.Log_Prefix + Message + "\n")
+
+    def Reset(self):
+        ''' Everything the bootloader keeps in RAM starts over, flash and the option bytes stay '''
+        self.Erased_Pages = set()
+        self.Update_Slot = BL_SLOT_NONE
+        self.Opened_Slot = BL_SLOT_NONE
+        self.LZ_History = 0
+        self.LZ_Next_Address = 0
+        self.Seq_History = []
+        self.Flash.Program_Budget = None
+        self.Node_State = BL_NODE_STATE_ALL
+        self.Bcast_Received = set()
+        self.Auth_Status = BL_AUTH_FAILED
+        self.Auth_Stream_State = BL_AUTH_STREAM_EMPTY
+
+    def Quiet(self):
+        ''' BL_Transport_Set_Quiet: a node that is not addressed sends nothing, not even a NACK '''
+        return self.Node_State in (BL_NODE_STATE_UNSELECTED, BL_NODE_STATE_BROADCAST)
+
+    def Handle_Frame(self, Frame):
+        ''' Returns (ACK bytes, reply bytes, flash busy time) '''
+        self.Flash.Busy_Time = 0
+        if((self.Node_State == BL_NODE_STATE_UNSELECTED and Frame[1] != CBL_NODE_SELECT_CMD) or
+           (self.Node_State == BL_NODE_STATE_BROADCAST and Frame[1] not in BL_BCAST_COMMANDS)):
+            self.Log("0x{:02x} : for another node".format(Frame[1]))
+            return b'', b'', 0
+        Handler = self.Handlers.get(Frame[1])
+        if(Handler is None):
+            self.Log("0x{:02x} : no answer".format(Frame[1]))
+            return b'', b'', 0
+        if(len(Frame) < 2 + CRC_TYPE_SIZE or
+           Calculate_CRC32(Frame[:-CRC_TYPE_SIZE]) != struct.unpack_from('<I', Frame, len(Frame) - CRC_TYPE_SIZE)[0]):
+            self.Log("0x{:02x} : CRC failed, NACK".format(Frame[1]))
+            return self.NACK(Frame), b'', 0
+        if(Frame[1] == CBL_BATCH_CMD and len(Frame) - 2 - CRC_TYPE_SIZE > BL_BATCH_MAX_COMMANDS):
+            self.Log("0x{:02x} : more than {} commands, NACK".format(Frame[1], BL_BATCH_MAX_COMMANDS))
+            return self.NACK(Frame), b'', 0
+        Reply = Handler(Frame)
+        self.Log("0x{:02x} : {} byte frame, reply {}".format(Frame[1], len(Frame), Reply.hex()))
+        if(self.Quiet()):
+            return b'', b'', self.Flash.Busy_Time
+        if(Frame[1] == CBL_READ_SECTOR_STATUS_CMD):
+            return bytes([CBL_SEND_LONG_ACK]) + struct.pack('<H', len(Reply)), Reply, self.Flash.Busy_Time
+        return bytes([CBL_SEND_ACK, len(Reply)]), Reply, self.Flash.Busy_Time
+
+    def NACK(self, Frame):
+        ''' BL_Send_NACK, or BL_Send_Seq_NACK for a sequence numbered write. The buffer is zeroed before every frame. '''
+        if(self.Quiet()):
+            return b''
+        if(len(Frame) > 1 and Frame[1] == CBL_MEM_WRITE_SEQ_CMD):
+            return bytes([CBL_SEND_NACK]) + (bytes(Frame[2:4]) + b'\x00\x00')[:2]
+        return bytes([CBL_SEND_NACK])
+
+    def Handle_GET_VER(self, Frame):
+        return CBL_VERSION
+
+    def Handle_GET_HELP(self, Frame):
+        return self.Supported_CMDs
+
+    def Handle_GET_CID(self, Frame):
+        return struct.pack('<H', STM32F103_DEVICE_ID)
+
+    def Handle_GET_RDP_STATUS(self, Frame):
+        return bytes([RDP_STATUS_CODES[self.RDP_Level]])
+
+    def Handle_EN_R_W_PROTECT(self, Frame):
+        return bytes([OB_RDP_LEVEL_1 if self.RDP_Level else OB_RDP_LEVEL_0])
+
+    def Handle_BATCH(self, Frame):
+        ''' The queries run in order, an entry that no longer fits the frame buffer gets length 0 '''
+        Reply = bytearray()
+        for Command in Frame[2 : len(Frame) - CRC_TYPE_SIZE]:
+            Query_Reply = self.Handlers[Command](Frame) if Command in self.Query_Commands else b''
+            if(len(Reply) + BL_BATCH_ENTRY_HEADER_SIZE + len(Query_Reply) > BL_HOST_BUFFER_LENGTH):
+                Query_Reply = b''
+            if(len(Reply) + BL_BATCH_ENTRY_HEADER_SIZE <= BL_HOST_BUFFER_LENGTH):
+                Reply = Reply + bytes([Command, len(Query_Reply)]) + Query_Reply
+        return bytes(Reply)
+
+    def Handle_CHANGE_ROP_LEVEL(self, Frame):
+        ''' Level 2 is permanent on real parts and never accepted '''
+        if(Frame[2] in RDP_STATUS_CODES):
+            self.RDP_Level = Frame[2]
+            self.Flash.Busy_Time = 2 * FLASH_PAGE_ERASE_TIME
+            return bytes([ROP_LEVEL_CHANGE_PASSED])
+        return bytes([ROP_LEVEL_CHANGE_FAILED])
+
+    def Address_Is_Valid(self, Address):
+        ''' Recieved_Address_Verfication, both end points inclusive '''
+        return ((STM32F103_SRAM_BASE <= Address <= STM32F103_SRAM_BASE + STM32F103_SRAM_SIZE) or
+                (STM32F103_FLASH_BASE <= Address <= STM32F103_FLASH_BASE + self.Flash.Size))
+
+    def Handle_GO_TO_ADDR(self, Frame):
+        ''' The simulated device re-enters the bootloader right after the jump, so one simulator serves many runs '''
+        Address = struct.unpack_from('<I', Frame, 2)[0]
+        if(self.Auth_Key is not None and (self.Auth_Status != BL_AUTH_PASSED or
+                                          not (0 <= Address - self.Auth_Image[0] < self.Auth_Image[1]))):
+            self.Log("jump to 0x{:08X} refused, no signed image there".format(Address))
+            return bytes([ADDRESS_NOT_VALID])
+        if(self.Address_Is_Valid(Address)):
+            self.Log("jump to 0x{:08X}".format(Address))
+            return bytes([ADDRESS_VALID])
+        return bytes([ADDRESS_NOT_VALID])
+
+    ''' Slots and the boot selector, see the slot part of bootloader.c. Without the dual slot layout
+        the application area is slot A and the selector is the last bootloader page '''
+    def Slot_Base_Address(self, Slot):
+        return APP_BASE_ADDRESS + (BL_SLOT_SIZE if Slot == BL_SLOT_B else 0)
+
+    def Slot_Size(self):
+        return BL_SLOT_SIZE if self.Dual_Slot else self.Flash.Size - (APP_BASE_ADDRESS - STM32F103_FLASH_BASE)
+
+    def Slot_Is_Valid(self, Slot):
+        Slot_Base = self.Slot_Base_Address(Slot)
+        MSP_Value, Reset_Handler = struct.unpack('<II', self.Flash.Read(Slot_Base, 8))
+        return (STM32F103_SRAM_BASE < MSP_Value <= STM32F103_SRAM_BASE + STM32F103_SRAM_SIZE and (Reset_Handler & 1) and
+                Slot_Base <= (Reset_Handler & ~1) < Slot_Base + self.Slot_Size())
+
+    def Boot_Selector_Address(self):
+        if(self.Dual_Slot):
+            return STM32F103_FLASH_BASE + self.Flash.Size - FLASH_PAGE_SIZE
+        return APP_BASE_ADDRESS - FLASH_PAGE_SIZE
+
+    def Scan_Boot_Records(self):
+        ''' Returns the slot of the last SLOT record or BL_SLOT_NONE, and the state of both slots '''
+        Selected_Slot = BL_SLOT_NONE
+        Slot_States = [BL_SLOT_STATE_UNKNOWN, BL_SLOT_STATE_UNKNOWN]
+        for Offset in range(0, FLASH_PAGE_SIZE, 2):
+            Record = struct.unpack('<H', self.Flash.Read(self.Boot_Selector_Address() + Offset, 2))[0]
+            if(Record == 0xFFFF):
+                break
+            if(Record in BL_BOOT_SELECTOR_RECORDS):
+                Selected_Slot = BL_BOOT_SELECTOR_RECORDS[Record]
+                Slot_States[Selected_Slot] = BL_SLOT_STATE_COMPLETE
+            elif(Record in BL_BOOT_SELECTOR_OPEN_RECORDS):
+                Slot_States[BL_BOOT_SELECTOR_OPEN_RECORDS[Record]] = BL_SLOT_STATE_OPEN
+        return Selected_Slot, Slot_States
+
+    def Slot_Can_Boot(self, Slot, Slot_States):
+        ''' A BL_AUTH build starts only a slot its SLOT record closed, the others any slot that is not open '''
+        if(self.Auth_Key is not None and Slot_States[Slot] != BL_SLOT_STATE_COMPLETE):
+            return False
+        return Slot_States[Slot] != BL_SLOT_STATE_OPEN and self.Slot_Is_Valid(Slot)
+
+    def Boot_Slot(self):
+        Boot_Slot, Slot_States = self.Scan_Boot_Records()
+        if(Boot_Slot == BL_SLOT_NONE):
+            Boot_Slot = BL_SLOT_A
+        if(not self.Slot_Can_Boot(Boot_Slot, Slot_States)):
+            Boot_Slot = Boot_Slot ^ 1 if self.Dual_Slot else BL_SLOT_NONE
+            if(Boot_Slot != BL_SLOT_NONE and not self.Slot_Can_Boot(Boot_Slot, Slot_States)):
+                Boot_Slot = BL_SLOT_NONE
+        return Boot_Slot
+
+    def Write_Boot_Record(self, Record):
+        ''' Bootloader_Write_Boot_Record: a full page is recycled with the open slots and the selected slot carried over '''
+        Record_Address = self.Boot_Selector_Address()
+        while(Record_Address < self.Boot_Selector_Address() + FLASH_PAGE_SIZE and self.Flash.Read(Record_Address, 2) != b'\xff\xff'):
+            Record_Address = Record_Address + 2
+        if(Record_Address >= self.Boot_Selector_Address() + FLASH_PAGE_SIZE):
+            Selected_Slot, Slot_States = self.Scan_Boot_Records()
+            self.Flash.Erase_Pages((self.Boot_Selector_Address() - STM32F103_FLASH_BASE) // FLASH_PAGE_SIZE, 1)
+            Carried = [0x5A0A + Slot for Slot in (BL_SLOT_A, BL_SLOT_B) if Slot_States[Slot] == BL_SLOT_STATE_OPEN]
+            if(Selected_Slot != BL_SLOT_NONE and Slot_States[Selected_Slot] == BL_SLOT_STATE_COMPLETE):
+                Carried.append(0xA50A + Selected_Slot)
+            Record_Address = self.Boot_Selector_Address()
+            for Carried_Record in Carried:
+                if(not self.Flash.Program_Halfword(Record_Address, Carried_Record)):
+                    return False
+                Record_Address = Record_Address + 2
+        return self.Flash.Program_Halfword(Record_Address, Record)
+
+    def Open_Slot(self, Slot):
+        ''' Bootloader_Open_Slot, False when the OPEN record could not be written '''
+        if(Slot != self.Opened_Slot):
+            if(self.Scan_Boot_Records()[1][Slot] != BL_SLOT_STATE_OPEN and not self.Write_Boot_Record(0x5A0A + Slot)):
+                return False
+            self.Opened_Slot = Slot
+        return True
+
+    def Close_Slot(self):
+        ''' Bootloader_Close_Slot, only without the dual slot layout '''
+        if(self.Scan_Boot_Records()[1][BL_SLOT_A] == BL_SLOT_STATE_OPEN and self.Write_Boot_Record(0xA50A)):
+            self.Log("application marked complete")
+            self.Opened_Slot = BL_SLOT_NONE
+
+    def Inactive_Slot(self):
+        ''' Latched on first use, writing a vector table must not move it '''
+        if(self.Update_Slot == BL_SLOT_NONE):
+            self.Update_Slot = BL_SLOT_B if self.Boot_Slot() == BL_SLOT_A else BL_SLOT_A
+        return self.Update_Slot
+
+    def Slot_Range_Is_Valid(self, Address, Length):
+        Slot_Base = self.Slot_Base_Address(self.Inactive_Slot())
+        return Slot_Base <= Address and Address + Length <= Slot_Base + BL_SLOT_SIZE
+
+    def Handle_GET_SLOT_INFO(self, Frame):
+        Update_Slot = self.Inactive_Slot()
+        return struct.pack('<BBII', self.Boot_Slot(), Update_Slot, self.Slot_Base_Address(Update_Slot), BL_SLOT_SIZE)
+
+    def Handle_SWITCH_SLOT(self, Frame):
+        Update_Slot = self.Inactive_Slot()
+        if(self.Auth_Key is not None and (self.Auth_Status != BL_AUTH_PASSED or
+                                          self.Slot_Base_Address(Update_Slot) != self.Auth_Image[0])):
+            return bytes([BL_SLOT_SWITCH_FAILED])
+        if(not self.Slot_Is_Valid(Update_Slot)):
+            return bytes([BL_SLOT_SWITCH_FAILED])
+        if(self.Write_Boot_Record(0xA50A + Update_Slot)):
+            ''' The old boot slot takes the next update, its first write opens it '''
+            self.Update_Slot = BL_SLOT_NONE
+            self.Opened_Slot = BL_SLOT_NONE
+            return bytes([BL_SLOT_SWITCH_PASSED])
+        return bytes([BL_SLOT_SWITCH_FAILED])
+
+    def Handle_FLASH_ERASE(self, Frame):
+        ''' Perform_Flash_Erase: the bootloader pages are never erased, a mass erase only clears the application area '''
+        Page_Number, Page_Count = Frame[2], Frame[3]
+        self.Seq_History = []
+        self.Bcast_Received = set()
+        Max_Page_Number = self.Flash.Size // FLASH_PAGE_SIZE
+        if(Page_Number == CBL_MASS_ERASE):
+            if(self.Dual_Slot):
+                Page_Number = (self.Slot_Base_Address(self.Inactive_Slot()) - STM32F103_FLASH_BASE) // FLASH_PAGE_SIZE
+                Page_Count = BL_SLOT_SIZE // FLASH_PAGE_SIZE
+            else:
+                Page_Number = CBL_BOOTLOADER_PAGES
+                Page_Count = Max_Page_Number - CBL_BOOTLOADER_PAGES
+        elif(CBL_BOOTLOADER_PAGES <= Page_Number < Max_Page_Number):
+            Page_Count = min(Page_Count, Max_Page_Number - Page_Number)
+        else:
+            return bytes([UNSUCCESSFUL_ERASE])
+        if(self.Dual_Slot and not self.Slot_Range_Is_Valid(STM32F103_FLASH_BASE + Page_Number * FLASH_PAGE_SIZE, Page_Count * FLASH_PAGE_SIZE)):
+            ''' INVALID_SECTOR_NUMBER '''
+            return bytes([0x00])
+        if(not self.Open_Slot(self.Inactive_Slot() if self.Dual_Slot else BL_SLOT_A)):
+            return bytes([UNSUCCESSFUL_ERASE])
+        self.Flash.Erase_Pages(Page_Number, Page_Count)
+        self.Erased_Pages.update(range(Page_Number, Page_Number + Page_Count))
+        self.Auth_Stream_Erase(STM32F103_FLASH_BASE + Page_Number * FLASH_PAGE_SIZE, Page_Count * FLASH_PAGE_SIZE)
+        return bytes([SUCCESSFUL_ERASE])
+
+    def Write_Host_Data(self, Address, Data):
+        ''' Bootloader_Write_Host_Data. Data holds one entry per output byte, None marks a skipped byte
+            that stays erased. Returns the write status byte. '''
+        if(self.Dual_Slot):
+            if(not self.Slot_Range_Is_Valid(Address, len(Data)) or not self.Open_Slot(self.Inactive_Slot())):
+                return bytes([FLASH_PAYLOAD_WRITE_FAILED])
+            for Page_Number in range((Address - STM32F103_FLASH_BASE) // FLASH_PAGE_SIZE,
+                                     (Address + len(Data) - 1 - STM32F103_FLASH_BASE) // FLASH_PAGE_SIZE + 1):
+                if(Page_Number not in self.Erased_Pages):
+                    self.Flash.Erase_Pages(Page_Number, 1)
+                    self.Erased_Pages.add(Page_Number)
+                    self.Auth_Stream_Erase(STM32F103_FLASH_BASE + Page_Number * FLASH_PAGE_SIZE, FLASH_PAGE_SIZE)
+        elif(not self.Address_Is_Valid(Address) or (len(Data) and not self.Address_Is_Valid(Address + len(Data) - 1))):
+            return bytes([FLASH_PAYLOAD_WRITE_FAILED])
+        elif(STM32F103_FLASH_BASE <= Address <= STM32F103_FLASH_BASE + self.Flash.Size):
+            ''' The bootloader and its boot selector page are not the host's to write '''
+            if(Address < APP_BASE_ADDRESS or not self.Open_Slot(BL_SLOT_A)):
+                return bytes([FLASH_PAYLOAD_WRITE_FAILED])
+
+        if(STM32F103_SRAM_BASE <= Address):
+            ''' RAM loads are plain stores '''
+            for Index, Value in enumerate(Data):
+                if(Value is not None and Address + Index - STM32F103_SRAM_BASE < STM32F103_SRAM_SIZE):
+                    self.SRAM[Address + Index - STM32F103_SRAM_BASE] = Value
+            return bytes([FLASH_PAYLOAD_WRITE_PASSED])
+        Length = len(Data)
+        if(not self.Flash.Contains(Address & ~1, ((Address + Length + 1) & ~1) - (Address & ~1))):
+            self.Auth_Stream_Write(Address, Length, FLASH_PAYLOAD_WRITE_FAILED)
+            return bytes([FLASH_PAYLOAD_WRITE_FAILED])
+
+        ''' FLASH_Stream_Put / Skip / Flush: half-words with one skipped byte are completed with 0xFF,
+            fully skipped half-words are not programmed, the first programming error stops the frame '''
+        Data = ([None] if Address & 1 else []) + list(Data)
+        if(len(Data) % 2):
+            Data.append(None)
+        Status = FLASH_PAYLOAD_WRITE_PASSED
+        for Index in range(0, len(Data), 2):
+            if(Data[Index] is None and Data[Index + 1] is None):
+                continue
+            Value = (0xFF if Data[Index] is None else Data[Index]) | ((0xFF if Data[Index + 1] is None else Data[Index + 1]) << 8)
+            if(not self.Flash.Program_Halfword((Address & ~1) + Index, Value)):
+                Status = FLASH_PAYLOAD_WRITE_FAILED
+                break
+        self.Auth_Stream_Write(Address, Length, Status)
+        return bytes([Status])
+
+    def Handle_MEM_WRITE(self, Frame):
+        Address, Payload_Len = struct.unpack_from('<IB', Frame, 2)
+        return self.Write_Host_Data(Address, Frame[7 : 7 + Payload_Len])
+
+    def Handle_MEM_WRITE_AES(self, Frame):
+        ''' The payload is decrypted in place and written like CBL_MEM_WRITE_CMD '''
+        Address, Payload_Len = struct.unpack_from('<IB', Frame, 2)
+        if(BL_AES_HEADER_SIZE + Payload_Len + CRC_TYPE_SIZE != len(Frame) or self.AES_Round_Key is None):
+            return bytes([FLASH_PAYLOAD_WRITE_FAILED])
+        self.Flash.Busy_Time = self.Flash.Busy_Time + Payload_Len * AES128_CYCLES_PER_BYTE / BL_CORE_CLOCK
+        return self.Write_Host_Data(Address, AES128_CTR_Xor(self.AES_Round_Key, Frame[7 : BL_AES_HEADER_SIZE],
+                                                            Frame[BL_AES_HEADER_SIZE : BL_AES_HEADER_SIZE + Payload_Len]))
+
+    def Handle_MEM_WRITE_SEQ(self, Frame):
+        ''' A sequence number still in the history gets its stored status, nothing is programmed twice '''
+        Sequence_Number, Address, Payload_Len = struct.unpack_from('<HIB', Frame, 2)
+        for Seq_Number, Status in self.Seq_History:
+            if(Seq_Number == Sequence_Number):
+                self.Log("0x{:02x} : sequence {} sent again".format(Frame[1], Sequence_Number))
+                return Status + struct.pack('<H', Sequence_Number)
+        Status = bytes([FLASH_PAYLOAD_WRITE_FAILED])
+        if(BL_SEQ_HEADER_SIZE + Payload_Len + CRC_TYPE_SIZE == len(Frame)):
+            Status = self.Write_Host_Data(Address, Frame[BL_SEQ_HEADER_SIZE : BL_SEQ_HEADER_SIZE + Payload_Len])
+        self.Seq_History = (self.Seq_History + [(Sequence_Number, Status)])[-BL_SEQ_HISTORY_SIZE:]
+        if(Status[0] == FLASH_PAYLOAD_WRITE_PASSED and Sequence_Number < BL_BCAST_MAX_FRAMES):
+            self.Bcast_Received.add(Sequence_Number)
+        return Status + struct.pack('<H', Sequence_Number)
+
+    def Handle_NODE_SELECT(self, Frame):
+        ''' The reply is built for every address, the quiet transport keeps it off the bus '''
+        Address = struct.unpack_from('<H', Frame, 2)[0]
+        if(Address == BL_NODE_BROADCAST):
+            self.Node_State = BL_NODE_STATE_BROADCAST
+        elif(Address == self.Node_Address):
+            self.Node_State = BL_NODE_STATE_SELECTED
+        elif(Address != BL_NODE_ANY):
+            self.Node_State = BL_NODE_STATE_UNSELECTED
+        return struct.pack('<BH', BL_NODE_SELECTED, self.Node_Address)
+
+    def Handle_BCAST_STATUS(self, Frame):
+        Bitmap = bytearray(BL_BCAST_MAX_FRAMES // 8)
+        for Sequence_Number in self.Bcast_Received:
+            Bitmap[Sequence_Number // 8] |= 1 << (Sequence_Number % 8)
+        return struct.pack('<H', len(self.Bcast_Received)) + bytes(Bitmap)
+
+    def LZ_Put_Byte(self, Output, Value):
+        Output.append(Value)
+        self.LZ_Window[self.LZ_Window_Pos] = Value
+        self.LZ_Window_Pos = (self.LZ_Window_Pos + 1) % BL_LZ_WINDOW_SIZE
+        self.LZ_History = min(self.LZ_History + 1, BL_LZ_WINDOW_SIZE)
+
+    def LZ_Decode(self, Payload):
+        ''' Bootloader_LZ_Decode, None when the frame is malformed '''
+        Output = bytearray()
+        Index = 0
+        while(Index < len(Payload)):
+            Token = Payload[Index]
+            Index = Index + 1
+            if(Token < LZ_TOKEN_MATCH_FLAG):
+                ''' Literal run: copy (Token+1) bytes from the frame '''
+                Run_Length = Token + 1
+                if(Index + Run_Length > len(Payload) or len(Output) + Run_Length > BL_LZ_MAX_FRAME_OUTPUT):
+                    return None
+                for Value in Payload[Index : Index + Run_Length]:
+                    self.LZ_Put_Byte(Output, Value)
+                Index = Index + Run_Length
+            else:
+                ''' Match: copy a run from the sliding window, overlapping copies allowed '''
+                Run_Length = (Token & ~LZ_TOKEN_MATCH_FLAG) + LZ_MIN_MATCH_LENGTH
+                if(Index >= len(Payload)):
+                    return None
+                Distance = Payload[Index] + 1
+                Index = Index + 1
+                if(Distance > self.LZ_History or len(Output) + Run_Length > BL_LZ_MAX_FRAME_OUTPUT):
+                    return None
+                for Count in range(Run_Length):
+                    self.LZ_Put_Byte(Output, self.LZ_Window[(self.LZ_Window_Pos - Distance) % BL_LZ_WINDOW_SIZE])
+        return Output
+
+    def Handle_MEM_WRITE_LZ(self, Frame):
+        ''' A frame continuing the previous output keeps the window, any other address starts a new stream '''
+        Address, Payload_Len = struct.unpack_from('<IB', Frame, 2)
+        if(Address != self.LZ_Next_Address):
+            self.LZ_History = 0
+        Output = self.LZ_Decode(Frame[7 : 7 + Payload_Len])
+        Status = bytes([FLASH_PAYLOAD_WRITE_FAILED]) if Output is None else self.Write_Host_Data(Address, Output)
+        self.LZ_Next_Address = Address + len(Output) if Status[0] == FLASH_PAYLOAD_WRITE_PASSED else 0
+        return Status
+
+    def RLE_Decode(self, Payload):
+        ''' Bootloader_RLE_Decoded_Length and the inline decoder, skipped bytes come back as None '''
+        Output = []
+        Index = 0
+        while(Index < len(Payload)):
+            Token = Payload[Index]
+            Index = Index + 1
+            if((Token & RLE_TOKEN_TYPE_MASK_LITERAL) == RLE_TOKEN_LITERAL):
+                Output.extend(Payload[Index : Index + Token + 1])
+                Index = Index + Token + 1
+            elif(Index < len(Payload)):
+                Run_Length = (((Token & RLE_TOKEN_RUN_MASK) << 8) | Payload[Index]) + 1
+                if((Token & RLE_TOKEN_TYPE_MASK_RUN) == RLE_TOKEN_FILL):
+                    if(Index + 1 >= len(Payload)):
+                        return None
+                    Output.extend([Payload[Index + 1]] * Run_Length)
+                    Index = Index + 2
+                else:
+                    Output.extend([None] * Run_Length)
+                    Index = Index + 1
+            else:
+                return None
+        if(Index != len(Payload)):
+            return None
+        return Output
+
+    def Handle_MEM_WRITE_RLE(self, Frame):
+        Address, Payload_Len = struct.unpack_from('<IB', Frame, 2)
+        Output = self.RLE_Decode(Frame[7 : 7 + Payload_Len])
+        if(Output is None):
+            return bytes([FLASH_PAYLOAD_WRITE_FAILED])
+        return self.Write_Host_Data(Address, Output)
+
+    def Handle_VERIFY_SEGMENTS(self, Frame):
+        Segment_Count = Frame[2]
+        Session_CRC32 = 0xFFFFFFFF
+        Status = SEGMENT_CRC_FAILED
+        if(0 < Segment_Count <= BL_MAX_SEGMENTS and len(Frame) == 3 + Segment_Count * BL_SEGMENT_DESCRIPTOR_SIZE + 2 * CRC_TYPE_SIZE):
+            Status = SEGMENT_CRC_PASSED
+            for Segment_Index in range(Segment_Count):
+                Segment_Address, Segment_Length = struct.unpack_from('<II', Frame, 3 + Segment_Index * BL_SEGMENT_DESCRIPTOR_SIZE)
+                if(not self.Flash.Contains(Segment_Address, Segment_Length)):
+                    Status = SEGMENT_CRC_FAILED
+                    break
+                Session_CRC32 = Calculate_CRC32(self.Flash.Read(Segment_Address, Segment_Length), Session_CRC32)
+                self.Flash.Busy_Time = self.Flash.Busy_Time + Segment_Length * FLASH_CRC_BYTE_TIME
+            if(Session_CRC32 != struct.unpack_from('<I', Frame, 3 + Segment_Count * BL_SEGMENT_DESCRIPTOR_SIZE)[0]):
+                Status = SEGMENT_CRC_FAILED
+            Descriptors = [struct.unpack_from('<II', Frame, 3 + Segment_Index * BL_SEGMENT_DESCRIPTOR_SIZE) for Segment_Index in range(Segment_Count)]
+            if(Status == SEGMENT_CRC_PASSED and not self.Dual_Slot and self.Auth_Key is None and
+               any(Address == APP_BASE_ADDRESS and Length for Address, Length in Descriptors)):
+                ''' The host read back the whole image it wrote, from now on it may be started '''
+                self.Close_Slot()
+        return struct.pack('<BI', Status, Session_CRC32)
+
+    def Handle_READ_SECTOR_STATUS(self, Frame):
+        ''' Only the programmed pages cost a CRC pass, the blank ones share one CRC '''
+        Page_Count = self.Flash.Size // FLASH_PAGE_SIZE
+        Blank_Map = bytearray(Page_Count // 8)
+        Page_CRCs = []
+        for Page_Index in range(Page_Count):
+            Page = self.Flash.Read(STM32F103_FLASH_BASE + Page_Index * FLASH_PAGE_SIZE, FLASH_PAGE_SIZE)
+            if(Page == b'\xff' * FLASH_PAGE_SIZE):
+                Blank_Map[Page_Index // 8] = Blank_Map[Page_Index // 8] | (1 << (Page_Index % 8))
+            else:
+                self.Flash.Busy_Time = self.Flash.Busy_Time + FLASH_PAGE_SIZE * FLASH_CRC_BYTE_TIME
+            Page_CRCs.append(Calculate_CRC32(Page))
+        return struct.pack('<BI', Page_Count, self.Flash.WRP) + bytes(Blank_Map) + struct.pack('<{}I'.format(Page_Count), *Page_CRCs)
+
+    ''' Signed images, see the signed image part of bootloader.c '''
+    def Auth_Hash_Flash(self, Address, Length):
+        self.Auth_Stream.update(self.Flash.Read(Address, Length))
+        self.Auth_Hash_Cycles = self.Auth_Hash_Cycles + Length * SHA256_CYCLES_PER_BYTE
+        self.Flash.Busy_Time = self.Flash.Busy_Time + Length * SHA256_CYCLES_PER_BYTE / BL_CORE_CLOCK
+
+    def Auth_Stream_Write(self, Address, Length, Status):
+        ''' Bootloader_Auth_Stream_Write '''
+        if(self.Auth_Key is None or not self.Flash.Contains(Address) or Length == 0):
+            return
+        self.Auth_Status = BL_AUTH_FAILED
+        if(Status != FLASH_PAYLOAD_WRITE_PASSED):
+            self.Auth_Stream_State = BL_AUTH_STREAM_BROKEN
+            return
+        if(self.Auth_Stream_State == BL_AUTH_STREAM_EMPTY):
+            self.Auth_Stream = hashlib.sha256()
+            self.Auth_Stream_Start = self.Auth_Stream_End = Address
+            self.Auth_Hash_Cycles = 0
+            self.Auth_Stream_State = BL_AUTH_STREAM_VALID
+        if(self.Auth_Stream_State == BL_AUTH_STREAM_VALID and Address >= self.Auth_Stream_End):
+            self.Auth_Hash_Flash(self.Auth_Stream_End, Address + Length - self.Auth_Stream_End)
+            self.Auth_Stream_End = Address + Length
+        else:
+            self.Auth_Stream_State = BL_AUTH_STREAM_BROKEN
+
+    def Auth_Stream_Erase(self, Address, Length):
+        ''' Bootloader_Auth_Stream_Erase '''
+        self.Auth_Status = BL_AUTH_FAILED
+        if(self.Auth_Stream_State != BL_AUTH_STREAM_EMPTY and Address < self.Auth_Stream_End and
+           Address + Length > self.Auth_Stream_Start):
+            self.Auth_Stream_State = BL_AUTH_STREAM_EMPTY if Address <= self.Auth_Stream_Start else BL_AUTH_STREAM_BROKEN
+
+    def Handle_AUTH_VERIFY(self, Frame):
+        Image_Address, Image_Length = struct.unpack_from('<II', Frame, 2)
+        Status, Path, Streamed_Bytes, Verify_Cycles = BL_AUTH_FAILED, BL_AUTH_PATH_FULL, 0, 0
+        self.Auth_Status = BL_AUTH_FAILED
+        if(len(Frame) == BL_AUTH_HEADER_SIZE + 64 + CRC_TYPE_SIZE and Image_Length and
+           STM32F103_FLASH_BASE <= Image_Address < STM32F103_FLASH_BASE + self.Flash.Size and
+           Image_Length <= STM32F103_FLASH_BASE + self.Flash.Size - Image_Address):
+            if(self.Auth_Stream_State == BL_AUTH_STREAM_VALID and Image_Address == self.Auth_Stream_Start and
+               self.Auth_Stream_End <= Image_Address + Image_Length):
+                Path = BL_AUTH_PATH_STREAMED
+                Streamed_Bytes = self.Auth_Stream_End - Image_Address
+                self.Auth_Hash_Flash(self.Auth_Stream_End, Image_Length - Streamed_Bytes)
+            else:
+                self.Auth_Stream = hashlib.sha256()
+                self.Auth_Hash_Cycles = 0
+                self.Auth_Hash_Flash(Image_Address, Image_Length)
+            self.Auth_Stream_State = BL_AUTH_STREAM_EMPTY
+            Verify_Cycles = ECDSA_P256_VERIFY_CYCLES
+            self.Flash.Busy_Time = self.Flash.Busy_Time + ECDSA_P256_VERIFY_CYCLES / BL_CORE_CLOCK
+            if(ECDSA_P256_Verify(self.Auth_Key, self.Auth_Stream.digest(), Frame[BL_AUTH_HEADER_SIZE : BL_AUTH_HEADER_SIZE + 64])):
+                Status = BL_AUTH_PASSED
+                self.Auth_Status = BL_AUTH_PASSED
+                self.Auth_Image = (Image_Address, Image_Length)
+                if(not self.Dual_Slot and Image_Address == APP_BASE_ADDRESS):
+                    self.Close_Slot()
+        self.Log("signature {}, {} of {} bytes streamed".format("ok" if Status == BL_AUTH_PASSED else "refused",
+                 Streamed_Bytes, Image_Length))
+        return struct.pack('<BBIII', Status, Path, Streamed_Bytes, self.Auth_Hash_Cycles, Verify_Cycles)
+
+class BL_Fault_Model:
+    ''' Faults of a noisy link for the host retry paths: bit errors per data bit, dropped bytes per byte,
+        delayed replies and device resets per frame. The same Seed replays the same faults. '''
+    def __init__(self, Bit_Error_Rate = 0, Drop_Rate = 0, Delay_Rate = 0, Delay = 0.25, Reset_Rate = 0, Seed = None):
+        self.Random = random.Random(Seed)
+        self.Byte_Error_Rate = 1 - (1 - Bit_Error_Rate) ** 8
+        self.Drop_Rate = Drop_Rate
+        self.Delay_Rate = Delay_Rate
+        self.Delay = Delay
+        self.Reset_Rate = Reset_Rate
+        self.Bit_Errors = 0
+        self.Dropped_Bytes = 0
+        self.Delayed_Replies = 0
+        self.Resets = 0
+
+    def Happens(self, Rate):
+        return Rate > 0 and self.Random.random() < Rate
+
+    def Corrupt(self, Data):
+        ''' Data as the other end receives it '''
+        if(self.Byte_Error_Rate <= 0 and self.Drop_Rate <= 0):
+            return Data
+        Output = bytearray()
+        for Value in Data:
+            if(self.Happens(self.Drop_Rate)):
+                self.Dropped_Bytes = self.Dropped_Bytes + 1
+                continue
+            if(self.Happens(self.Byte_Error_Rate)):
+                Value = Value ^ (1 << self.Random.randrange(8))
+                self.Bit_Errors = self.Bit_Errors + 1
+            Output.append(Value)
+        return Output
+
+    def Summary(self):
+        return "{} bit errors, {} dropped bytes, {} delayed replies, {} resets".format(self.Bit_Errors, self.Dropped_Bytes,
+                                                                                       self.Delayed_Replies, self.Resets)
+
+class BL_Simulated_Link:
+    ''' UART side of the simulator on the master end of a pseudo-terminal.
+        Bytes move at the simulated baud rate, the flash work takes its simulated time, Time_Scale 0 disables both.
+        Several devices share the line like nodes on an RS-485 bus, each one receives its own faulty copy. '''
+    def __init__(self, Devices, Baudrate, Time_Scale, Faults = None):
+        self.Devices = Devices
+        self.Device = Devices[0]
+        self.Baudrate = Baudrate
+        self.Time_Scale = Time_Scale
+        self.Faults = Faults if Faults is not None else BL_Fault_Model()
+        ''' When the last received byte finished crossing the wire '''
+        self.Rx_End = 0
+        self.Master_Fd, self.Slave_Fd = os.openpty()
+        ''' Raw mode on our own slave descriptor; it also stays open, so the master never sees EIO
+            while no host has the port open '''
+        tty.setraw(self.Slave_Fd)
+        self.Port_Name = os.ttyname(self.Slave_Fd)
+
+    def Wire_Time(self, Byte_Count):
+        return Byte_Count * UART_BITS_PER_BYTE / self.Baudrate
+
+    def Wait(self, Until):
+        Delay = Until - time.monotonic()
+        if(Delay > 0):
+            time.sleep(Delay)
+
+    def Read_Exactly(self, Length, Timeout = None):
+        ''' Stops early when no byte comes for Timeout seconds '''
+        Data = bytearray()
+        while(len(Data) < Length):
+            if(Timeout is not None and not len(select.select([self.Master_Fd], [], [], Timeout)[0])):
+                break
+            Received = os.read(self.Master_Fd, Length - len(Data))
+            ''' On a bus every node corrupts its own copy, see Serve_Bus_Frame '''
+            Data.extend(self.Faults.Corrupt(Received) if len(self.Devices) == 1 else Received)
+        return Data
+
+    def Discard_Input(self):
+        ''' Bytes that arrive while the device is in reset are lost '''
+        while(len(select.select([self.Master_Fd], [], [], 0)[0])):
+            os.read(self.Master_Fd, 4096)
+
+    def Send(self, Data):
+        if(len(Data)):
+            self.Wait(time.monotonic() + self.Wire_Time(len(Data)) * self.Time_Scale)
+            os.write(self.Master_Fd, self.Faults.Corrupt(Data))
+
+    def Serve(self):
+        ''' BL_UART_FETCH_HOST_COMMAND: the length byte, then that many bytes with the inter-byte timeout, then the handler '''
+        while True:
+            ''' A frame that was already waiting crossed the wire right behind the previous one,
+                like a window of frames does on a bootloader that receives in the background '''
+            Queued = len(select.select([self.Master_Fd], [], [], 0)[0])
+            Frame = self.Read_Exactly(1)
+            Frame_Start = self.Rx_End if Queued else time.monotonic() - self.Wire_Time(1) * self.Time_Scale
+            Frame.extend(self.Read_Exactly(Frame[0], BL_INTER_BYTE_TIMEOUT))
+            ''' The last byte only arrives after the whole frame crossed the wire '''
+            self.Rx_End = max(Frame_Start + self.Wire_Time(len(Frame)) * self.Time_Scale, self.Rx_End)
+            if(Frame[0] == 0):
+                ''' An empty frame, e.g. the zero bytes of a resynchronisation, gets no answer '''
+                continue
+            if(len(self.Devices) > 1):
+                self.Serve_Bus_Frame(Frame)
+                continue
+            if(len(Frame) < Frame[0] + 1):
+                self.Device.Log("{} : {} of {} bytes, inter-byte timeout, NACK".format(Command_Name(Frame), len(Frame), Frame[0] + 1))
+                self.Send(self.Device.NACK(Frame))
+                continue
+            self.Wait(self.Rx_End)
+            Reset = self.Faults.Happens(self.Faults.Reset_Rate)
+            if(Reset):
+                ''' The reset hits somewhere in the flash work of this frame, a write may stop half way '''
+                self.Device.Flash.Program_Budget = self.Faults.Random.randrange(BL_LZ_MAX_FRAME_OUTPUT // 2)
+            BL_ACK, Reply, Busy_Time = self.Device.Handle_Frame(bytes(Frame))
+            self.Send(BL_ACK)
+            if(Reset):
+                self.Faults.Resets = self.Faults.Resets + 1
+                self.Device.Log("reset")
+                self.Device.Reset()
+                self.Wait(time.monotonic() + BL_BOOT_TIME * self.Time_Scale)
+                self.Discard_Input()
+                continue
+            Reply_Time = time.monotonic() + Busy_Time * self.Time_Scale
+            if(self.Faults.Happens(self.Faults.Delay_Rate)):
+                ''' Not scaled, the delay is measured against the host timeouts '''
+                self.Faults.Delayed_Replies = self.Faults.Delayed_Replies + 1
+                Reply_Time = Reply_Time + self.Faults.Delay
+            self.Wait(Reply_Time)
+            self.Send(Reply)
+
+    def Serve_Bus_Frame(self, Frame):
+        ''' Every node takes its own copy of the frame and works in parallel, only the selected one answers.
+            A node whose copy lost a byte sees a short frame, one with a damaged length byte takes what it got. '''
+        self.Wait(self.Rx_End)
+        Answers = []
+        Busy_Time = 0
+        for Device in self.Devices:
+            Node_Frame = self.Faults.Corrupt(Frame)
+            if(len(Node_Frame) < 1 or Node_Frame[0] == 0):
+                continue
+            if(len(Node_Frame) < Node_Frame[0] + 1):
+                Device.Log("{} : {} of {} bytes, inter-byte timeout, NACK".format(Command_Name(Node_Frame), len(Node_Frame), Node_Frame[0] + 1))
+                Answers.append((Device.NACK(Node_Frame), b''))
+                continue
+            Reset = self.Faults.Happens(self.Faults.Reset_Rate)
+            if(Reset):
+                Device.Flash.Program_Budget = self.Faults.Random.randrange(BL_LZ_MAX_FRAME_OUTPUT // 2)
+            BL_ACK, Reply, Device_Busy_Time = Device.Handle_Frame(bytes(Node_Frame[:Node_Frame[0] + 1]))
+            if(Reset):
+                self.Faults.Resets = self.Faults.Resets + 1
+                Device.Log("reset")
+                Device.Reset()
+                Reply = b''
+            Answers.append((BL_ACK, Reply))
+            Busy_Time = max(Busy_Time, Device_Busy_Time)
+        self.Send(b''.join(BL_ACK for BL_ACK, Reply in Answers))
+        Reply_Time = time.monotonic() + Busy_Time * self.Time_Scale
+        if(self.Faults.Happens(self.Faults.Delay_Rate)):
+            self.Faults.Delayed_Replies = self.Faults.Delayed_Replies + 1
+            Reply_Time = Reply_Time + self.Faults.Delay
+        self.Wait(Reply_Time)
+        self.Send(b''.join(Reply for BL_ACK, Reply in Answers))
+
+def Load_Binary_Image(Device, File_Name, Address):
+    ''' Preload flash, e.g. a bootable image for the slot commands or a base image for --delta runs '''
+    with open(File_Name, 'rb') as ImageFile:
+        Image = ImageFile.read()
+    Offset = Address - STM32F103_FLASH_BASE
+    Device.Flash.Memory[Offset : Offset + len(Image)] = Image
+
+if __name__ == '__main__':
+    Parser = argparse.ArgumentParser(description = "Simulated STM32F103 bootloader on a pseudo-terminal")
+    Parser.add_argument('--baud', type = int, default = 115200, help = "simulated UART baud rate")
+    Parser.add_argument('--time-scale', type = float, default = 1.0,
+                        help = "scale of the wire and flash timing, 0 answers as fast as possible")
+    Parser.add_argument('--dual-slot', action = 'store_true', help = "128 KB part with the A/B slot layout")
+    Parser.add_argument('--image', help = "binary preloaded into flash at --addr")
+    Parser.add_argument('--addr', type = lambda Value: int(Value, 0), default = APP_BASE_ADDRESS)
+    Parser.add_argument('--link', help = "also expose the port under this path, e.g. /tmp/ttyBL0")
+    Parser.add_argument('--verbose', action = 'store_true', help = "log every frame on stderr")
+    Parser.add_argument('--ber', type = float, default = 0, help = "bit error rate of both directions, e.g. 1e-4")
+    Parser.add_argument('--drop', type = float, default = 0, help = "probability that a byte is lost")
+    Parser.add_argument('--delay-rate', type = float, default = 0, help = "probability that a reply comes late")
+    Parser.add_argument('--delay', type = float, default = 0.25, help = "seconds a late reply is held back")
+    Parser.add_argument('--reset-rate', type = float, default = 0, help = "probability that a frame resets the device")
+    Parser.add_argument('--seed', type = int, help = "replay the same fault pattern")
+    Parser.add_argument('--nodes', type = int, default = 1, help = "devices sharing the line like an RS-485 bus")
+    Parser.add_argument('--auth-key', help = "KEY.pub from Host.py keygen, simulates a BL_AUTH build that starts signed images only")
+    Parser.add_argument('--aes-key', help = "key from Host.py keygen --aes, simulates a BL_AES build that takes encrypted writes")
+    Parser.add_argument('--wrp', type = lambda Value: int(Value, 0), default = 0xFFFFFFFF,
+                        help = "write protection option bytes (WRPR), a cleared bit protects 4 pages")
+    Arguments = Parser.parse_args()
+
+    Auth_Key = None
+    if(Arguments.auth_key):
+        with open(Arguments.auth_key) as Key_File:
+            Auth_Key = bytes.fromhex(Key_File.read().strip())
+    AES_Key = None
+    if(Arguments.aes_key):
+        with open(Arguments.aes_key) as Key_File:
+            AES_Key = bytes.fromhex(Key_File.read().strip())
+
+    Devices = []
+    for Node_Index in range(Arguments.nodes):
+        Unique_ID = BL_DEFAULT_UNIQUE_ID if Node_Index == 0 else random.Random(Node_Index).randbytes(len(BL_DEFAULT_UNIQUE_ID))
+        Device = BL_Simulated_Device(Arguments.dual_slot, Arguments.verbose, Unique_ID, Auth_Key, AES_Key, Arguments.wrp)
+        if(Arguments.image):
+            Load_Binary_Image(Device, Arguments.image, Arguments.addr)
+        if(Arguments.nodes > 1):
+            Device.Log_Prefix = "node 0x{:04X}: ".format(Device.Node_Address)
+            sys.stderr.write("node address 0x{:04X}\n".format(Device.Node_Address))
+        Devices.append(Device)
+    Faults = BL_Fault_Model(Arguments.ber, Arguments.drop, Arguments.delay_rate, Arguments.delay, Arguments.reset_rate, Arguments.seed)
+    Link = BL_Simulated_Link(Devices, Arguments.baud, Arguments.time_scale, Faults)
+    Port_Name = Link.Port_Name
+    if(Arguments.link):
+        if(os.path.lexists(Arguments.link)):
+            os.remove(Arguments.link)
+        os.symlink(Link.Port_Name, Arguments.link)
+        Port_Name = Arguments.link
+    print(Port_Name, flush = True)
+    try:
+        Link.Serve()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sys.stderr.write("faults: " + Faults.Summary() + "\n")
+        if(Arguments.link and os.path.islink(Arguments.link)):
+            os.remove(Arguments.link)
@@ -3,6 +3,13 @@ import struct
 import os
 import sys
 import glob
+import mmap
+import argparse
+import hashlib
+import hmac
+import secrets
+import threading
+import time
 from time import sleep
 
 ''' Bootloader Commands '''
@@ -18,23 +25,189 @@ CBL_MEM_READ_CMD             = 0x18
 CBL_READ_SECTOR_STATUS_CMD   = 0x19
 CBL_OTP_READ_CMD             = 0x20
 CBL_CHANGE_ROP_Level_CMD     = 0x21
+CBL_GET_SLOT_INFO_CMD        = 0x22
+CBL_SWITCH_SLOT_CMD          = 0x23
+CBL_MEM_WRITE_LZ_CMD         = 0x24
+CBL_MEM_WRITE_RLE_CMD        = 0x25
+CBL_VERIFY_SEGMENTS_CMD      = 0x26
+CBL_MEM_WRITE_SEQ_CMD        = 0x27
+CBL_NODE_SELECT_CMD          = 0x28
+CBL_BCAST_STATUS_CMD         = 0x29
+CBL_AUTH_VERIFY_CMD          = 0x2A
+CBL_MEM_WRITE_AES_CMD        = 0x2B
+CBL_BATCH_CMD                = 0x2C
 
 INVALID_SECTOR_NUMBER        = 0x00
 VALID_SECTOR_NUMBER          = 0x01
 UNSUCCESSFUL_ERASE           = 0x02
 SUCCESSFUL_ERASE             = 0x03
 
+CBL_SEND_ACK                 = 0xAB
+CBL_SEND_NACK                = 0xCD
+''' ACK with a 16-bit length, for replies longer than 255 bytes '''
+CBL_SEND_LONG_ACK            = 0xAC
+
 FLASH_PAYLOAD_WRITE_FAILED   = 0x00
 FLASH_PAYLOAD_WRITE_PASSED   = 0x01
 
+''' Compressed write stream, must match bootloader.h '''
+LZ_WINDOW_SIZE               = 256
+LZ_MIN_MATCH_LENGTH          = 3
+LZ_MAX_MATCH_LENGTH          = 130
+LZ_MAX_LITERAL_RUN           = 128
+LZ_MAX_FRAME_OUTPUT          = 512
+LZ_MAX_FRAME_PAYLOAD         = 160
+LZ_TOKEN_MATCH_FLAG          = 0x80
+
+''' Run-length write records, must match bootloader.h '''
+RLE_TOKEN_LITERAL            = 0x00
+RLE_TOKEN_SKIP               = 0x80
+RLE_TOKEN_FILL               = 0xC0
+RLE_MAX_LITERAL_RUN          = 128
+RLE_MAX_RUN                  = 0x4000
+RLE_MIN_SKIP_RUN             = 3
+RLE_MIN_FILL_RUN             = 4
+RLE_MAX_FRAME_OUTPUT         = 4096
+RLE_MAX_FRAME_PAYLOAD        = 160
+
+''' Sparse images, must match bootloader.h '''
+FLASH_PAGE_SIZE              = 0x400
+STM32F103_FLASH_BASE         = 0x08000000
+BL_MAX_SEGMENTS              = 23
+SEGMENT_WRITE_CHUNK          = 128
+SEGMENT_CRC_FAILED           = 0x00
+SEGMENT_CRC_PASSED           = 0x01
+
+''' Transfer plans are cached per image, see Get_Transfer_Plan '''
+BL_PLAN_CACHE_DIR            = os.path.join(os.path.expanduser('~'), '.cache', 'stm32f103_bl_host')
+BL_PLAN_MAGIC                = b'BLPLAN'
+BL_PLAN_VERSION              = 2
+
+BL_SLOT_NONE                 = 0xFF
+BL_SLOT_SWITCH_FAILED        = 0x00
+BL_SLOT_SWITCH_PASSED        = 0x01
+
+''' STM32 CRC unit, one data byte per 32-bit word written to CRC->DR '''
+CRC32_POLYNOMIAL             = 0x04C11DB7
+CRC32_KNOWN_VECTORS          = [(b'', 0xFFFFFFFF),
+                                (b'\x00', 0xC704DD7B),
+                                (b'\xFF', 0x76F39DCF),
+                                (b'123456789', 0x1556F485),
+                                (bytes([0x05, CBL_GET_VER_CMD]), 0x4CEC8427)]
+
+''' Every session assembles its frames in a buffer sized like BL_HOST_BUFFER in the bootloader '''
+BL_HOST_BUFFER_LENGTH        = 200
+
+''' Response timeouts are computed per frame instead of pacing the link with fixed sleeps.
+    Device work is bounded with the F1 datasheet maxima (tERASE, tPROG). '''
+UART_BITS_PER_BYTE           = 10
+BL_RESPONSE_MARGIN           = 0.1
+FLASH_PAGE_ERASE_TIME        = 0.040
+FLASH_HALFWORD_PROGRAM_TIME  = 0.000070
+FLASH_CRC_BYTE_TIME          = 0.000002
+FLASH_MAX_PAGE_COUNT         = 128
+
+''' CBL_READ_SECTOR_STATUS_CMD answers [page count][WRPR u32][blank bitmap][page CRC32 per page] '''
+BL_SECTOR_STATUS_HEADER_SIZE = 5
+
+''' Link error recovery of the batch sessions. The bootloader takes the first byte of a frame as its length,
+    zero bytes finish a frame cut short by a lost byte and are then dropped as empty frames. '''
+BL_RESYNC_LENGTH             = 256
+BL_RESYNC_QUIET_TIME         = 0.3
+''' Longer than BL_INTER_BYTE_TIMEOUT_MS: after this much silence the bootloader waits for a length byte '''
+BL_FRAME_GAP_TIME            = 0.03
+BL_DEFAULT_RETRIES           = 3
+
+''' CBL_MEM_WRITE_SEQ_CMD frames in flight. Older bootloaders poll their UART and lose the bytes that arrive
+    while they program, only one that receives in the background (DMA ring, simulator) takes a larger window. '''
+BL_DEFAULT_WINDOW            = 1
+''' Receive ring of the DMA, must match bl_transport.h. The frames in flight are kept within it whatever
+    the window, bytes past it would overwrite a frame the bootloader has not read yet. '''
+BL_UART_RX_BUFFER_SIZE       = 1024
+BL_SEQ_REPLY_SIZE            = 3
+
+''' Nodes on a shared bus, must match bootloader.h. The broadcast select gets no answer, it is sent a few times
+    so that a node missing one does not keep answering the stream. '''
+BL_NODE_BROADCAST            = 0xFFFF
+BL_NODE_ANY                  = 0x0000
+BL_NODE_SELECTED             = 0x01
+BL_NODE_REPLY_SIZE           = 3
+BL_BCAST_MAX_FRAMES          = 512
+BL_BCAST_STATUS_SIZE         = 2 + BL_BCAST_MAX_FRAMES // 8
+BL_BCAST_SELECT_REPEATS      = 3
+
+''' CBL_BATCH_CMD, must match bootloader.h. Each reply entry is [command][length][reply], length 0 for a command
+    the bootloader does not answer in a batch. '''
+BL_BATCH_MAX_COMMANDS        = 16
+BL_BATCH_ENTRY_HEADER_SIZE   = 2
+BL_IDENTIFY_COMMANDS         = (CBL_GET_VER_CMD, CBL_GET_CID_CMD, CBL_GET_RDP_STATUS_CMD, CBL_GET_HELP_CMD, CBL_GET_SLOT_INFO_CMD)
+''' Idle time after every broadcast frame on top of its wire and flash time, no node answers to pace the stream '''
+BL_BCAST_FRAME_GAP           = 0.005
+
+''' Signed images, must match bootloader.h. The signature is ECDSA on the NIST P-256 curve over the SHA-256
+    of the image, the bootloader starts only an image that passed CBL_AUTH_VERIFY_CMD. '''
+BL_AUTH_PASSED               = 0x01
+BL_AUTH_PATH_STREAMED        = 0x01
+BL_AUTH_REPLY_SIZE           = 14
+''' Signature check on the 8 MHz core with margin, the hash of a full image read comes on top '''
+BL_AUTH_VERIFY_TIME          = 3.0
+FLASH_HASH_BYTE_TIME         = 0.00001
+''' Encrypted writes, must match bootloader.h. AES-128-CTR, the counter block is the nonce of the frame
+    and a 64-bit big endian block counter from 0. '''
+BL_AES_NONCE_SIZE            = 8
+BL_AES_KEY_SIZE              = 16
+AES_DECRYPT_BYTE_TIME        = 0.00001
+P256_P                       = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF
+P256_N                       = 0xFFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551
+P256_B                       = 0x5AC635D8AA3A93E7B3EBBD55769886BC651D06B0CC53B0F63BCE3C3E27D2604B
+P256_G                       = (0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296,
+                                0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5)
+
+''' Reply length of the commands a transfer plan sends, anything else is a late or garbled reply '''
+BL_REPLY_LENGTHS             = {CBL_FLASH_ERASE_CMD : 1, CBL_MEM_WRITE_CMD : 1, CBL_MEM_WRITE_LZ_CMD : 1,
+                                CBL_MEM_WRITE_RLE_CMD : 1, CBL_VERIFY_SEGMENTS_CMD : 5, CBL_GO_TO_ADDR_CMD : 1,
+                                CBL_MEM_WRITE_SEQ_CMD : BL_SEQ_REPLY_SIZE, CBL_NODE_SELECT_CMD : BL_NODE_REPLY_SIZE,
+                                CBL_BCAST_STATUS_CMD : BL_BCAST_STATUS_SIZE, CBL_AUTH_VERIFY_CMD : BL_AUTH_REPLY_SIZE,
+                                CBL_MEM_WRITE_AES_CMD : 1}
+
+''' Write command of each transfer plan mode '''
+BL_WRITE_MODES               = {'raw' : CBL_MEM_WRITE_CMD, 'lz' : CBL_MEM_WRITE_LZ_CMD, 'rle' : CBL_MEM_WRITE_RLE_CMD,
+                                'seq' : CBL_MEM_WRITE_SEQ_CMD, 'aes' : CBL_MEM_WRITE_AES_CMD}
+
+BL_Baudrate = 115200
+BL_Pace_Delay = 0
+BL_PROGRESS_INTERVAL         = 1.0
+
+''' Batch mode exit codes '''
+EXIT_OK                      = 0
+EXIT_SELF_TEST_FAILED        = 3
+EXIT_PORT_ERROR              = 4
+EXIT_NO_RESPONSE             = 5
+EXIT_NACK                    = 6
+EXIT_ERASE_FAILED            = 7
+EXIT_WRITE_FAILED            = 8
+EXIT_VERIFY_FAILED           = 9
+EXIT_JUMP_FAILED             = 10
+EXIT_AUTH_FAILED             = 11
+
+APP_BASE_ADDRESS             = 0x08008000
+
+''' The interactive menu talks through one session, its last reply waits here for the Process_* functions '''
+BL_Menu_Session = None
+BL_Reply_Buffer = bytearray()
+
 verbose_mode = 1
-Memory_Write_Active = 0
 
 def Check_Serial_Ports():
     Serial_Ports = []
     
     if sys.platform.startswith('win'):
         Ports = ['COM%s' % (i + 1) for i in range(256)]
+    elif sys.platform.startswith('linux'):
+        ''' USB-UART bridges (FTDI, CP210x, CH340) and CDC-ACM devices '''
+        Ports = sorted(glob.glob('/dev/ttyUSB*') + glob.glob('/dev/ttyACM*'))
+    elif sys.platform.startswith('darwin'):
+        Ports = sorted(glob.glob('/dev/cu.usbserial*') + glob.glob('/dev/cu.usbmodem*'))
     else:
         raise EnvironmentError("Error !! Unsupported Platform \n")
     
@@ -50,9 +223,12 @@ def Check_Serial_Ports():
 
 def Serial_Port_Configuration(Port_Number):
     global Serial_Port_Obj
+    global BL_Menu_Session
+    BL_Menu_Session = BL_Session(Port_Number, BL_Baudrate, BL_Pace_Delay, verbose_mode)
     try:
-        Serial_Port_Obj = serial.Serial(Port_Number, 115200, timeout = 2)
-    except:
+        BL_Menu_Session.Open()
+        Serial_Port_Obj = BL_Menu_Session.Port
+    except BL_Session_Error:
         print("\nError !! That was not a valid port")
     
         Port_Number = Check_Serial_Ports()
@@ -68,59 +244,455 @@ def Serial_Port_Configuration(Port_Number):
     else:
         print("Port Open Failed \n")
 
-def Write_Data_To_Serial_Port(Value, Length):
-    _data = struct.pack('>B', Value)
-    if(verbose_mode):
-        Value = bytearray(_data)
-        print("   "+"0x{:02x}".format(Value[0]), end = ' ')
-        if(Memory_Write_Active and (not verbose_mode)):
-            print("#", end = ' ')
-        Serial_Port_Obj.write(_data)
+def Build_CBL_Frame(Frame_View, Command_Code, *Fields):
+    ''' Assemble [length][command][fields...][CRC32] in Frame_View and return the frame length.
+        Fields are bytes-like objects, memoryview slices of a mapped image are copied only once. '''
+    Frame_Len = 2
+    for Field in Fields:
+        Frame_View[Frame_Len : Frame_Len + len(Field)] = Field
+        Frame_Len = Frame_Len + len(Field)
+    Frame_Len = Frame_Len + 4
+    Frame_View[0] = Frame_Len - 1
+    Frame_View[1] = Command_Code
+    CRC32_Value = Calculate_CRC32(Frame_View, Frame_Len - 4) & 0xFFFFFFFF
+    struct.pack_into('<I', Frame_View, Frame_Len - 4, CRC32_Value)
+    return Frame_Len
 
-def Read_Serial_Port(Data_Len):
+class BL_Session_Error(Exception):
+    def __init__(self, Exit_Code, Message):
+        Exception.__init__(self, Message)
+        self.Exit_Code = Exit_Code
+
+class BL_Session:
+    ''' One bootloader connection. The port, the frame buffer and the timing state live here,
+        so several sessions can run side by side in their own threads. '''
+    def __init__(self, Port_Name, Baudrate = 115200, Pace_Delay = 0, Verbose = 0, Retries = 0, Window = 1):
+        self.Port_Name = Port_Name
+        self.Baudrate = Baudrate
+        self.Pace_Delay = Pace_Delay
+        self.Verbose = Verbose
+        self.Retries = Retries
+        self.Window = Window
+        self.Port = None
+        self.Frame_Buffer = bytearray(BL_HOST_BUFFER_LENGTH)
+        self.Frame_View = memoryview(self.Frame_Buffer)
+        self.Last_Frame_Len = 0
+        self.Device_Time = 0
+        self.Bytes_Total = 0
+        self.Bytes_Written = 0
+        self.Pages_Written = 0
+        self.Stage = "idle"
+        self.Exit_Code = None
+        self.Error_Message = ""
+        self.Link_Errors = 0
+        self.Retransmissions = 0
+        self.Page_Repairs = 0
+        self.Recoveries = 0
+        self.Recovery_Time = 0
+        self.Recovery_Start = None
+        self.Auth_Reply = None
     
-    Serial_Value = Serial_Port_Obj.read(Data_Len)
-    Serial_Value_len = len(Serial_Value)
-    while Serial_Value_len <= 0:
-        Serial_Value = Serial_Port_Obj.read(Data_Len)
-        Serial_Value_len = len(Serial_Value)
-        print("Waiting Replay from the Bootloader")
-    return Serial_Value
+    def Open(self):
+        try:
+            self.Port = serial.Serial(self.Port_Name, self.Baudrate, timeout = 2)
+        except (OSError, serial.SerialException):
+            raise BL_Session_Error(EXIT_PORT_ERROR, "cannot open " + self.Port_Name)
+    
+    def Close(self):
+        if(self.Port is not None):
+            self.Port.close()
+    
+    def Wire_Time(self, Byte_Count):
+        return Byte_Count * UART_BITS_PER_BYTE / self.Baudrate
+    
+    def Send_Built_Frame(self, Frame, Device_Time):
+        ''' Send a complete frame with one write.
+            Device_Time is the worst case work between the ACK and the reply, it sizes the reply timeout. '''
+        self.Last_Frame_Len = len(Frame)
+        self.Device_Time = Device_Time
+        if(self.Verbose):
+            print("   " + " ".join("0x{:02x}".format(Value) for Value in Frame))
+        self.Port.write(Frame)
+    
+    def Send_Frame(self, Command_Code, *Fields, Device_Time = 0):
+        Frame_Len = Build_CBL_Frame(self.Frame_View, Command_Code, *Fields)
+        self.Send_Built_Frame(self.Frame_View[:Frame_Len], Device_Time)
+    
+    def Receive_Reply(self):
+        ''' Wait for the ACK and the reply of the last frame, None on a timeout.
+            The next frame is only sent after this returns, the link needs no extra pacing. '''
+        ''' The ACK follows as soon as the frame CRC is checked '''
+        self.Port.timeout = self.Wire_Time(self.Last_Frame_Len + 2) + BL_RESPONSE_MARGIN
+        BL_ACK = self.Port.read(1)
+        if(len(BL_ACK) < 1):
+            return None
+        if(BL_ACK[0] == CBL_SEND_LONG_ACK):
+            BL_ACK = BL_ACK + self.Port.read(2)
+            if(len(BL_ACK) < 3):
+                return None
+            Reply_Length = struct.unpack_from('<H', BL_ACK, 1)[0]
+        elif(BL_ACK[0] == CBL_SEND_ACK):
+            BL_ACK = BL_ACK + self.Port.read(1)
+            if(len(BL_ACK) < 2):
+                return None
+            Reply_Length = BL_ACK[1]
+        else:
+            ''' A NACK comes alone, there is no length byte to wait for '''
+            raise BL_Session_Error(EXIT_NACK, "NACK from the bootloader")
+        ''' The reply follows once the flash work is done '''
+        self.Port.timeout = self.Wire_Time(Reply_Length) + self.Device_Time + BL_RESPONSE_MARGIN
+        Reply = self.Port.read(Reply_Length)
+        if(len(Reply) < Reply_Length):
+            return None
+        if(self.Pace_Delay):
+            ''' Legacy firmware that cannot keep up with response driven flow control '''
+            sleep(self.Pace_Delay)
+        return Reply
+    
+    def Progress(self):
+        if(self.Bytes_Total == 0):
+            return 0
+        return 100 * self.Bytes_Written // self.Bytes_Total
+    
+    def Drain(self, First_Timeout, Quiet_Time):
+        ''' Drop whatever is still on the way to us, until the line was quiet for Quiet_Time '''
+        self.Port.timeout = First_Timeout
+        while(len(self.Port.read(BL_HOST_BUFFER_LENGTH))):
+            self.Port.timeout = Quiet_Time
+    
+    def Resynchronise(self):
+        ''' Bring the bootloader back to a frame start and drop whatever is still on the way to us.
+            A reply later than BL_RESYNC_QUIET_TIME cannot be told from the next one, the page CRC catches that. '''
+        self.Port.write(bytes(BL_RESYNC_LENGTH))
+        self.Drain(self.Wire_Time(BL_RESYNC_LENGTH) + BL_RESYNC_QUIET_TIME, BL_RESYNC_QUIET_TIME)
+    
+    def Wait_Frame_Gap(self):
+        ''' After a NACK the bootloader is back at a frame start once the line idles past its inter-byte timeout,
+            the rest of a frame it cut short is NACKed on its own and dropped here '''
+        self.Drain(BL_FRAME_GAP_TIME, BL_FRAME_GAP_TIME)
+    
+    def Start_Recovery(self):
+        ''' Returns True for the caller that owns the recovery, nested link errors are part of it '''
+        if(self.Recovery_Start is not None):
+            return False
+        self.Recovery_Start = time.time()
+        return True
+    
+    def End_Recovery(self):
+        self.Recovery_Time = self.Recovery_Time + time.time() - self.Recovery_Start
+        self.Recoveries = self.Recoveries + 1
+        self.Recovery_Start = None
+    
+    def Transact_Frame(self, Frame, Device_Time):
+        ''' NACKs, timeouts and replies of the wrong length are link errors: the frame is sent again, up to Retries times.
+            A NACK only needs the idle gap, anything else a full resynchronisation. A write may have been programmed
+            before its reply was lost, Flash_Page settles that with the page CRC. '''
+        Reply_Length = BL_REPLY_LENGTHS.get(Frame[1])
+        Recovery_Owner = False
+        for Attempt in range(self.Retries + 1):
+            if(Attempt):
+                self.Retransmissions = self.Retransmissions + 1
+                if(Error.Exit_Code == EXIT_NACK):
+                    self.Wait_Frame_Gap()
+                else:
+                    self.Resynchronise()
+            self.Send_Built_Frame(Frame, Device_Time)
+            try:
+                Reply = self.Receive_Reply()
+                Error = BL_Session_Error(EXIT_NO_RESPONSE, "bootloader not responding")
+            except BL_Session_Error as NACK_Error:
+                Reply = None
+                Error = NACK_Error
+            if(Reply is not None):
+                if(Reply_Length is None or len(Reply) == Reply_Length):
+                    if(Recovery_Owner):
+                        self.End_Recovery()
+                    return Reply
+                Error = BL_Session_Error(EXIT_NO_RESPONSE, "unexpected reply from the bootloader")
+            self.Link_Errors = self.Link_Errors + 1
+            Recovery_Owner = self.Start_Recovery() or Recovery_Owner
+        raise Error
+    
+    def Transact(self, Command_Code, *Fields, Device_Time = 0):
+        Frame_Len = Build_CBL_Frame(self.Frame_View, Command_Code, *Fields)
+        return self.Transact_Frame(self.Frame_View[:Frame_Len], Device_Time)
+    
+    def Broadcast_Frame(self, Frame, Device_Time):
+        ''' Send a frame no node answers and wait until every node is done with it '''
+        self.Send_Built_Frame(Frame, Device_Time)
+        sleep(self.Wire_Time(len(Frame)) + Device_Time + BL_BCAST_FRAME_GAP)
+    
+    def Broadcast(self, Command_Code, *Fields, Device_Time = 0):
+        Frame_Len = Build_CBL_Frame(self.Frame_View, Command_Code, *Fields)
+        self.Broadcast_Frame(self.Frame_View[:Frame_Len], Device_Time)
+    
+    def Select_Node(self, Address):
+        ''' Address one node of a shared bus, all the others fall silent. Returns the address of the node that answered,
+            BL_NODE_ANY reads it from a single board. BL_NODE_BROADCAST selects every node and gets no answer. '''
+        if(Address == BL_NODE_BROADCAST):
+            for Repeat in range(BL_BCAST_SELECT_REPEATS):
+                self.Broadcast(CBL_NODE_SELECT_CMD, struct.pack('<H', Address))
+            return Address
+        Reply = self.Transact(CBL_NODE_SELECT_CMD, struct.pack('<H', Address))
+        Node_Address = struct.unpack_from('<H', Reply, 1)[0]
+        if(Reply[0] != BL_NODE_SELECTED or (Address != BL_NODE_ANY and Node_Address != Address)):
+            raise BL_Session_Error(EXIT_NO_RESPONSE, "node 0x{:04X} not answering".format(Address))
+        return Node_Address
+    
+    def Broadcast_Missing(self, Frame_Count):
+        ''' Sequence numbers below Frame_Count the selected node has not written since its last erase '''
+        Bitmap = self.Transact(CBL_BCAST_STATUS_CMD)[2:]
+        return [Sequence_Number for Sequence_Number in range(Frame_Count)
+                if not Bitmap[Sequence_Number // 8] & (1 << (Sequence_Number % 8))]
+    
+    def Read_Sector_Status(self):
+        ''' Write protection, blank pages and page CRCs of the whole flash in one round trip:
+            (WRPR, set of blank pages, list of page CRCs), None when the bootloader does not answer it. '''
+        try:
+            Reply = self.Transact(CBL_READ_SECTOR_STATUS_CMD, Device_Time = FLASH_MAX_PAGE_COUNT * FLASH_PAGE_SIZE * FLASH_CRC_BYTE_TIME)
+        except BL_Session_Error:
+            return None
+        Page_Count = Reply[0]
+        Map_Size = Page_Count // 8
+        if(len(Reply) != BL_SECTOR_STATUS_HEADER_SIZE + Map_Size + 4 * Page_Count):
+            return None
+        WRP = struct.unpack_from('<I', Reply, 1)[0]
+        Blank_Map = Reply[BL_SECTOR_STATUS_HEADER_SIZE : BL_SECTOR_STATUS_HEADER_SIZE + Map_Size]
+        Blank_Pages = set(Page_Index for Page_Index in range(Page_Count) if Blank_Map[Page_Index // 8] & (1 << (Page_Index % 8)))
+        Page_CRCs = list(struct.unpack_from('<{}I'.format(Page_Count), Reply, BL_SECTOR_STATUS_HEADER_SIZE + Map_Size))
+        return WRP, Blank_Pages, Page_CRCs
+    
+    def Batch(self, Commands):
+        ''' Run several queries in one round trip. Returns (command, reply) in the order sent,
+            the reply is None for a command the bootloader does not answer in a batch.
+            The bootloader NACKs more than BL_BATCH_MAX_COMMANDS, they are refused before sending. '''
+        if(len(Commands) > BL_BATCH_MAX_COMMANDS):
+            raise ValueError("A batch holds at most {} commands, not {}".format(BL_BATCH_MAX_COMMANDS, len(Commands)))
+        Reply = self.Transact(CBL_BATCH_CMD, bytes(Commands))
+        Entries = []
+        Offset = 0
+        while(Offset + BL_BATCH_ENTRY_HEADER_SIZE <= len(Reply)):
+            Command, Length = Reply[Offset], Reply[Offset + 1]
+            Offset = Offset + BL_BATCH_ENTRY_HEADER_SIZE
+            Entries.append((Command, bytes(Reply[Offset : Offset + Length]) if Length else None))
+            Offset = Offset + Length
+        return Entries
     
-    '''
-    Serial_Value = Serial_Port_Obj.read(Data_Len)
+    def Erase_Pages(self, First_Page, Page_Count):
+        Erase_Pages = FLASH_MAX_PAGE_COUNT if (First_Page == 0xFF) else Page_Count
+        Reply = self.Transact(CBL_FLASH_ERASE_CMD, bytes([First_Page, Page_Count]),
+                              Device_Time = Erase_Pages * FLASH_PAGE_ERASE_TIME)
+        if(Reply[0] != SUCCESSFUL_ERASE):
+            raise BL_Session_Error(EXIT_ERASE_FAILED, "erase of page {} failed".format(First_Page))
+    
+    def Receive_Seq_Reply(self, In_Flight):
+        ''' Next answer inside a window: (CBL_SEND_ACK, sequence number, status), (CBL_SEND_NACK, sequence number, None),
+            or None on a timeout or a garbled answer. The timeout covers every frame still in flight. '''
+        self.Port.timeout = sum(self.Wire_Time(len(Frame) + 2 + BL_SEQ_REPLY_SIZE) + Device_Time
+                                for Frame, Device_Time in In_Flight) + BL_RESPONSE_MARGIN
+        BL_ACK = self.Port.read(1)
+        if(len(BL_ACK) < 1):
+            return None
+        if(BL_ACK[0] == CBL_SEND_NACK):
+            Reply = self.Port.read(2)
+            return (CBL_SEND_NACK, struct.unpack('<H', Reply)[0], None) if len(Reply) == 2 else None
+        Reply = self.Port.read(1 + BL_SEQ_REPLY_SIZE)
+        if(BL_ACK[0] != CBL_SEND_ACK or len(Reply) < 1 + BL_SEQ_REPLY_SIZE or Reply[0] != BL_SEQ_REPLY_SIZE):
+            return None
+        return (CBL_SEND_ACK, struct.unpack_from('<H', Reply, 2)[0], Reply[1])
+    
+    def Transact_Window(self, Frames):
+        ''' Selective repeat over CBL_MEM_WRITE_SEQ_CMD frames: up to Window frames, and at most BL_UART_RX_BUFFER_SIZE
+            bytes, are in flight, a NACK names
+            the one frame to send again, a timeout or a garbled answer resends what is still in flight after
+            a resynchronisation. The bootloader answers a frame it already wrote from its history, so a frame
+            sent twice is not programmed twice. Returns False when a frame reported a failed write. '''
+        In_Flight = {}
+        Attempts = {}
+        Write_Passed = True
+        Recovery_Owner = False
+        Next_Frame = 0
+        while(Next_Frame < len(Frames) or len(In_Flight)):
+            while(Next_Frame < len(Frames) and len(In_Flight) < self.Window and
+                  (not In_Flight or sum(len(Frame) for Frame, Device_Time in In_Flight.values())
+                                    + len(Frames[Next_Frame][0]) <= BL_UART_RX_BUFFER_SIZE)):
+                Frame, Device_Time = Frames[Next_Frame]
+                Sequence_Number = struct.unpack_from('<H', Frame, 2)[0]
+                In_Flight[Sequence_Number] = Frames[Next_Frame]
+                Attempts[Sequence_Number] = 0
+                self.Send_Built_Frame(Frame, Device_Time)
+                Next_Frame = Next_Frame + 1
+            Answer = self.Receive_Seq_Reply(In_Flight.values())
+            if(Answer is not None and Answer[0] == CBL_SEND_ACK):
+                if(Answer[1] in In_Flight):
+                    del In_Flight[Answer[1]]
+                    if(Answer[2] != FLASH_PAYLOAD_WRITE_PASSED):
+                        Write_Passed = False
+                ''' else the late answer to a frame that was sent twice '''
+                continue
+            self.Link_Errors = self.Link_Errors + 1
+            Recovery_Owner = self.Start_Recovery() or Recovery_Owner
+            if(Answer is not None and Answer[1] in In_Flight):
+                Resend = [Answer[1]]
+            else:
+                ''' A NACK with a damaged number still means the bootloader is at a frame start '''
+                if(Answer is None):
+                    self.Resynchronise()
+                Resend = list(In_Flight)
+            for Sequence_Number in Resend:
+                Attempts[Sequence_Number] = Attempts[Sequence_Number] + 1
+                if(Attempts[Sequence_Number] > self.Retries):
+                    if(Answer is None):
+                        raise BL_Session_Error(EXIT_NO_RESPONSE, "bootloader not responding")
+                    raise BL_Session_Error(EXIT_NACK, "NACK from the bootloader")
+                self.Retransmissions = self.Retransmissions + 1
+                self.Send_Built_Frame(*In_Flight[Sequence_Number])
+        if(Recovery_Owner):
+            self.End_Recovery()
+        return Write_Passed
+    
+    def Flash_Page(self, Page):
+        ''' Write the frames of one plan page. After a failed write or a link error the page CRC decides:
+            a frame sent again may already have been programmed, a reset may have cut a frame short.
+            A page that does not match is erased and written again, up to Retries times. '''
+        Page_Index, Page_CRC32, Compare_Frame, Write_Frames, Page_Bytes = Page
+        Recovery_Owner = False
+        for Attempt in range(self.Retries + 1):
+            if(Attempt):
+                self.Page_Repairs = self.Page_Repairs + 1
+                self.Erase_Pages(Page_Index, 1)
+            Link_Errors = self.Link_Errors
+            Write_Passed = True
+            if(Write_Frames[0][0][1] == CBL_MEM_WRITE_SEQ_CMD):
+                Write_Passed = self.Transact_Window(Write_Frames)
+            else:
+                for Frame, Device_Time in Write_Frames:
+                    if(self.Transact_Frame(Frame, Device_Time)[0] != FLASH_PAYLOAD_WRITE_PASSED):
+                        Write_Passed = False
+            if((Write_Passed and Link_Errors == self.Link_Errors) or self.Transact_Frame(*Compare_Frame)[0] == SEGMENT_CRC_PASSED):
+                if(Recovery_Owner):
+                    self.End_Recovery()
+                self.Bytes_Written = self.Bytes_Written + Page_Bytes
+                return
+            Recovery_Owner = self.Start_Recovery() or Recovery_Owner
+        raise BL_Session_Error(EXIT_WRITE_FAILED, "write at 0x{:08X} failed".format(STM32F103_FLASH_BASE + Page_Index * FLASH_PAGE_SIZE))
+    
+    def Flash(self, Plan, Verify, Jump, Delta, Auth_Frame = None):
+        ''' Stream the pre-built frames of a transfer plan. The plan is only read, one plan can feed every session.
+            With Delta, pages whose flash CRC already matches the plan are neither erased nor written, and blank pages
+            are not erased. The sector status gives all of that in one round trip, a bootloader without it is asked
+            page by page. Auth_Frame, a CBL_AUTH_VERIFY_CMD frame, goes out after the verify and before the jump. '''
+        Pages = Plan.Pages
+        Erase_Pages = [Page[0] for Page in Pages]
+        if(Delta):
+            self.Stage = "compare"
+            Sector_Status = self.Read_Sector_Status()
+            if(Sector_Status is None):
+                Pages = [Page for Page in Plan.Pages if self.Transact_Frame(*Page[2])[0] != SEGMENT_CRC_PASSED]
+                Erase_Pages = [Page[0] for Page in Pages]
+            else:
+                WRP, Blank_Pages, Page_CRCs = Sector_Status
+                Pages = [Page for Page in Plan.Pages if Page[0] >= len(Page_CRCs) or Page_CRCs[Page[0]] != Page[1]]
+                for Page in Pages:
+                    if(Page_Is_Protected(WRP, Page[0])):
+                        raise BL_Session_Error(EXIT_WRITE_FAILED, "page {} at 0x{:08X} is write protected".format(
+                                               Page[0], STM32F103_FLASH_BASE + Page[0] * FLASH_PAGE_SIZE))
+                Erase_Pages = [Page[0] for Page in Pages if Page[0] not in Blank_Pages]
+        self.Pages_Written = len(Pages)
+        self.Bytes_Total = sum(Page[4] for Page in Pages)
+        self.Bytes_Written = 0
+        self.Stage = "erase"
+        for First_Page, Page_Count in Page_Runs(Erase_Pages):
+            self.Erase_Pages(First_Page, Page_Count)
+        self.Stage = "write"
+        for Page in Pages:
+            self.Flash_Page(Page)
+        if(Verify):
+            self.Stage = "verify"
+            if(self.Transact_Frame(*Plan.Verify_Frame)[0] != SEGMENT_CRC_PASSED):
+                raise BL_Session_Error(EXIT_VERIFY_FAILED, "session CRC mismatch")
+        if(Auth_Frame is not None):
+            self.Stage = "auth"
+            self.Auth_Reply = self.Transact_Frame(*Auth_Frame)
+            if(self.Auth_Reply[0] != BL_AUTH_PASSED):
+                raise BL_Session_Error(EXIT_AUTH_FAILED, "signature refused")
+        if(Jump):
+            self.Stage = "jump"
+            if(self.Transact_Frame(*Plan.Jump_Frame)[0] != 1):
+                raise BL_Session_Error(EXIT_JUMP_FAILED, "jump refused")
+        self.Stage = "done"
+    
+    def Run_Flash(self, Plan, Verify, Jump, Delta, Auth_Frame = None):
+        ''' Thread body, the outcome is left in Exit_Code and Error_Message '''
+        try:
+            self.Stage = "open"
+            self.Open()
+            self.Flash(Plan, Verify, Jump, Delta, Auth_Frame)
+            self.Exit_Code = EXIT_OK
+        except BL_Session_Error as Error:
+            self.Exit_Code = Error.Exit_Code
+            self.Error_Message = str(Error)
+        except (OSError, serial.SerialException) as Error:
+            self.Exit_Code = EXIT_PORT_ERROR
+            self.Error_Message = str(Error)
+        finally:
+            self.Close()
+
+def Write_Device_Time(Address, Output_Len):
+    ''' Programming time of Output_Len bytes, plus the erase of every page a dual-slot build erases on demand '''
+    Pages = (Address + Output_Len - 1) // FLASH_PAGE_SIZE - Address // FLASH_PAGE_SIZE + 1
+    return ((Output_Len + 1) // 2) * FLASH_HALFWORD_PROGRAM_TIME + Pages * FLASH_PAGE_ERASE_TIME
+
+def Send_CBL_Frame(Command_Code, *Fields, Device_Time = 0):
+    BL_Menu_Session.Send_Frame(Command_Code, *Fields, Device_Time = Device_Time)
+
+def Read_Serial_Port(Data_Len):
+    ''' Hands the Process_* functions the reply received by Read_Data_From_Serial_Port '''
+    Serial_Value = bytes(BL_Reply_Buffer[:Data_Len])
+    del BL_Reply_Buffer[:Data_Len]
     return Serial_Value
-    '''
 
 def Read_Data_From_Serial_Port(Command_Code):
-    Length_To_Follow = 0
-    
-    BL_ACK = Read_Serial_Port(2)
-    if(len(BL_ACK)):
-        BL_ACK_Array = bytearray(BL_ACK)
-        if(BL_ACK_Array[0] == 0xCD):
-            print ("\n   Received Acknowledgement from Bootloader")
-            Length_To_Follow = BL_ACK_Array[1]
-            print("   Preparing to receive (", int(Length_To_Follow), ") bytes from the bootloader")
-            if(Command_Code == CBL_GET_VER_CMD):
-                Process_CBL_GET_VER_CMD(Length_To_Follow)
-            elif (Command_Code == CBL_GET_HELP_CMD):
-                Process_CBL_GET_HELP_CMD(Length_To_Follow)
-            elif (Command_Code == CBL_GET_CID_CMD):
-                Process_CBL_GET_CID_CMD(Length_To_Follow)
-            elif (Command_Code == CBL_GET_RDP_STATUS_CMD):
-                Process_CBL_GET_RDP_STATUS_CMD(Length_To_Follow)
-            elif (Command_Code == CBL_GO_TO_ADDR_CMD):
-                Process_CBL_GO_TO_ADDR_CMD(Length_To_Follow)
-            elif (Command_Code == CBL_FLASH_ERASE_CMD):
-                Process_CBL_FLASH_ERASE_CMD(Length_To_Follow)
-            elif (Command_Code == CBL_MEM_WRITE_CMD):
-                Process_CBL_MEM_WRITE_CMD(Length_To_Follow)
-            elif (Command_Code == CBL_CHANGE_ROP_Level_CMD):
-                Process_CBL_CHANGE_ROP_Level_CMD(Length_To_Follow)
-        else:
-            print ("\n   Received Not-Acknowledgement from Bootloader")
-            sys.exit()
+    ''' Waits for the ACK and the reply of the last menu frame, returns 1 once both were received '''
+    global BL_Reply_Buffer
+    try:
+        Reply = BL_Menu_Session.Receive_Reply()
+    except BL_Session_Error:
+        print ("\n   Received Not-Acknowledgement from Bootloader")
+        sys.exit(EXIT_NACK)
+    if(Reply is None):
+        print("Timeout !!, Bootloader is not responding")
+        return 0
+    else:
+        BL_Reply_Buffer = bytearray(Reply)
+        Length_To_Follow = len(Reply)
+        print ("\n   Received Acknowledgement from Bootloader")
+        print("   Preparing to receive (", int(Length_To_Follow), ") bytes from the bootloader")
+        if(Command_Code == CBL_GET_VER_CMD):
+            Process_CBL_GET_VER_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_GET_HELP_CMD):
+            Process_CBL_GET_HELP_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_GET_CID_CMD):
+            Process_CBL_GET_CID_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_GET_RDP_STATUS_CMD):
+            Process_CBL_GET_RDP_STATUS_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_GO_TO_ADDR_CMD):
+            Process_CBL_GO_TO_ADDR_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_FLASH_ERASE_CMD):
+            Process_CBL_FLASH_ERASE_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_MEM_WRITE_CMD or Command_Code == CBL_MEM_WRITE_LZ_CMD or Command_Code == CBL_MEM_WRITE_RLE_CMD):
+            Process_CBL_MEM_WRITE_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_CHANGE_ROP_Level_CMD):
+            Process_CBL_CHANGE_ROP_Level_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_VERIFY_SEGMENTS_CMD):
+            Process_CBL_VERIFY_SEGMENTS_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_READ_SECTOR_STATUS_CMD):
+            Process_CBL_READ_SECTOR_STATUS_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_GET_SLOT_INFO_CMD):
+            Process_CBL_GET_SLOT_INFO_CMD(Length_To_Follow)
+        elif (Command_Code == CBL_SWITCH_SLOT_CMD):
+            Process_CBL_SWITCH_SLOT_CMD(Length_To_Follow)
+        return 1
         
 def Process_CBL_GET_VER_CMD(Data_Len):
     Serial_Data = Read_Serial_Port(Data_Len)
@@ -183,6 +755,7 @@ def Process_CBL_MEM_WRITE_CMD(Data_Len):
     BL_Write_Status = bytearray(Serial_Data)
     if(BL_Write_Status[0] == FLASH_PAYLOAD_WRITE_FAILED):
         print("\n   Write Status -> Write Failed or Invalid Address ")
+        Memory_Write_All = 0
     elif (BL_Write_Status[0] == FLASH_PAYLOAD_WRITE_PASSED):
         print("\n   Write Status -> Write Successfule ")
         Memory_Write_All = Memory_Write_All and FLASH_PAYLOAD_WRITE_PASSED
@@ -201,227 +774,1079 @@ def Process_CBL_CHANGE_ROP_Level_CMD(Data_Len):
         else:
             print("\n   ROP Level -> Unknown Error")
 
-def Calculate_CRC32(Buffer, Buffer_Length):
+def Page_Is_Protected(WRP, Page_Index):
+    ''' WRPR bit n covers pages 4n..4n+3, the last bit all pages above, a cleared bit protects '''
+    return not (WRP >> min(Page_Index // 4, 31)) & 1
+
+def Process_CBL_READ_SECTOR_STATUS_CMD(Data_Len):
+    Serial_Data = Read_Serial_Port(Data_Len)
+    if(len(Serial_Data) < BL_SECTOR_STATUS_HEADER_SIZE):
+        print("Timeout !!, Bootloader is not responding")
+        return
+    Page_Count = Serial_Data[0]
+    Map_Size = Page_Count // 8
+    WRP = struct.unpack_from('<I', Serial_Data, 1)[0]
+    Blank_Map = Serial_Data[BL_SECTOR_STATUS_HEADER_SIZE : BL_SECTOR_STATUS_HEADER_SIZE + Map_Size]
+    Page_CRCs = struct.unpack_from('<{}I'.format(Page_Count), Serial_Data, BL_SECTOR_STATUS_HEADER_SIZE + Map_Size)
+    print("\n   Write Protection (WRPR) : 0x{:08X}".format(WRP))
+    print("   Page  Address     State       CRC32")
+    for Page_Index in range(Page_Count):
+        print("   {:>4}  0x{:08X}  {:<10}  0x{:08X}{}".format(Page_Index, STM32F103_FLASH_BASE + Page_Index * FLASH_PAGE_SIZE,
+              "blank" if Blank_Map[Page_Index // 8] & (1 << (Page_Index % 8)) else "programmed", Page_CRCs[Page_Index],
+              "  protected" if Page_Is_Protected(WRP, Page_Index) else ""))
+
+def Slot_Name(Slot):
+    if(Slot == BL_SLOT_NONE):
+        return "None"
+    return chr(ord('A') + Slot)
+
+def Process_CBL_GET_SLOT_INFO_CMD(Data_Len):
+    Serial_Data = Read_Serial_Port(Data_Len)
+    Boot_Slot, Update_Slot, Update_Base, Slot_Size = struct.unpack('<BBII', Serial_Data[0:10])
+    print("\n   Boot Slot            : ", Slot_Name(Boot_Slot))
+    print("   Update Slot          : ", Slot_Name(Update_Slot))
+    print("   Update Slot Address  : ", hex(Update_Base))
+    print("   Slot Size            : ", Slot_Size, "Bytes")
+
+def Process_CBL_SWITCH_SLOT_CMD(Data_Len):
+    Serial_Data = Read_Serial_Port(Data_Len)
+    if(len(Serial_Data)):
+        if(Serial_Data[0] == BL_SLOT_SWITCH_PASSED):
+            print("\n   Boot Slot Switched, the new image runs after the next reset")
+        else:
+            print("\n   Boot Slot Not Switched, the update slot holds no valid image")
+    else:
+        print("Timeout !!, Bootloader is not responding")
+
+def Process_CBL_VERIFY_SEGMENTS_CMD(Data_Len):
+    Serial_Data = Read_Serial_Port(Data_Len)
+    if(len(Serial_Data) == 5):
+        Device_CRC32 = struct.unpack('<I', bytes(Serial_Data[1:5]))[0]
+        if(Serial_Data[0] == SEGMENT_CRC_PASSED):
+            print("\n   Session CRC Matched : 0x{:08X}".format(Device_CRC32))
+        else:
+            print("\n   Session CRC Mismatch, device calculated : 0x{:08X}".format(Device_CRC32))
+    else:
+        print("Timeout !!, Bootloader is not responding")
+
+def Process_CBL_BATCH_CMD(Entries):
+    ''' Prints each entry with the Process_* function of its command '''
+    global BL_Reply_Buffer
+    Printers = {CBL_GET_VER_CMD : Process_CBL_GET_VER_CMD, CBL_GET_HELP_CMD : Process_CBL_GET_HELP_CMD,
+                CBL_GET_CID_CMD : Process_CBL_GET_CID_CMD, CBL_GET_RDP_STATUS_CMD : Process_CBL_GET_RDP_STATUS_CMD,
+                CBL_GET_SLOT_INFO_CMD : Process_CBL_GET_SLOT_INFO_CMD}
+    for Command, Reply in Entries:
+        if(Reply is None):
+            if(Command != CBL_GET_SLOT_INFO_CMD):
+                print("\n   Command 0x{:02x} not answered in a batch".format(Command))
+        elif(Command in Printers):
+            BL_Reply_Buffer = bytearray(Reply)
+            Printers[Command](len(Reply))
+    print()
+
+def Calculate_CRC32_Bitwise(Buffer, Buffer_Length):
+    ''' Reference model of the STM32 CRC unit fed one byte per 32-bit word '''
     CRC_Value = 0xFFFFFFFF
     for DataElem in Buffer[0:Buffer_Length]:
         CRC_Value = CRC_Value ^ DataElem
         for DataElemBitLen in range(32):
             if(CRC_Value & 0x80000000):
-                CRC_Value = (CRC_Value << 1) ^ 0x04C11DB7
+                CRC_Value = ((CRC_Value << 1) ^ CRC32_POLYNOMIAL) & 0xFFFFFFFF
             else:
-                CRC_Value = (CRC_Value << 1)
+                CRC_Value = (CRC_Value << 1) & 0xFFFFFFFF
     return CRC_Value
+
+def Build_CRC32_Table(Byte_Position, Word_Count):
+    ''' Table of a byte at Byte_Position pushed through Word_Count 32-bit CRC steps '''
+    Table = []
+    for Byte_Value in range(256):
+        CRC_Value = Byte_Value << (8 * Byte_Position)
+        for DataElemBitLen in range(32 * Word_Count):
+            if(CRC_Value & 0x80000000):
+                CRC_Value = ((CRC_Value << 1) ^ CRC32_POLYNOMIAL) & 0xFFFFFFFF
+            else:
+                CRC_Value = (CRC_Value << 1) & 0xFFFFFFFF
+        Table.append(CRC_Value)
+    return Table
+
+''' Every input byte costs the CRC unit a full 32-bit step, and that step is linear, so four bytes
+    b0..b3 fold into CRC' = S4(CRC ^ b0) ^ S3(b1) ^ S2(b2) ^ S1(b3): eight lookups per four bytes '''
+CRC32_TABLES_WORD = [Build_CRC32_Table(Byte_Position, 1) for Byte_Position in range(4)]
+CRC32_TABLES_QUAD = [Build_CRC32_Table(Byte_Position, 4) for Byte_Position in range(4)]
+CRC32_TABLES_TAIL = [Build_CRC32_Table(0, Word_Count) for Word_Count in (3, 2, 1)]
+
+def Calculate_CRC32(Buffer, Buffer_Length):
+    Q0, Q1, Q2, Q3 = CRC32_TABLES_QUAD
+    S3, S2, S1 = CRC32_TABLES_TAIL
+    W0, W1, W2, W3 = CRC32_TABLES_WORD
+    CRC_Value = 0xFFFFFFFF
+    Data = memoryview(Buffer)[0:Buffer_Length]
+    Quad_Length = len(Data) & ~3
+    Quad_Iterator = iter(Data[0:Quad_Length])
+    for Byte0, Byte1, Byte2, Byte3 in zip(Quad_Iterator, Quad_Iterator, Quad_Iterator, Quad_Iterator):
+        CRC_Value = (Q0[(CRC_Value ^ Byte0) & 0xFF] ^ Q1[(CRC_Value >> 8) & 0xFF] ^ Q2[(CRC_Value >> 16) & 0xFF] ^
+                     Q3[CRC_Value >> 24] ^ S3[Byte1] ^ S2[Byte2] ^ S1[Byte3])
+    for DataElem in Data[Quad_Length:]:
+        CRC_Value = W0[(CRC_Value ^ DataElem) & 0xFF] ^ W1[(CRC_Value >> 8) & 0xFF] ^ W2[(CRC_Value >> 16) & 0xFF] ^ W3[CRC_Value >> 24]
+    return CRC_Value
+
+def CRC32_Self_Test():
+    ''' The table CRC must give what the bootloader CRC unit calculates, 0xC704DD7B is the
+        STM32 reference value of a single zero word '''
+    for Vector, Expected_CRC32 in CRC32_KNOWN_VECTORS:
+        if(Calculate_CRC32(Vector, len(Vector)) != Expected_CRC32 or
+           Calculate_CRC32_Bitwise(Vector, len(Vector)) != Expected_CRC32):
+            print("CRC32 self test failed on", Vector.hex())
+            sys.exit(EXIT_SELF_TEST_FAILED)
+    Vector = bytes(range(0, 256, 7))
+    for Vector_Length in range(len(Vector)):
+        if(Calculate_CRC32(Vector, Vector_Length) != Calculate_CRC32_Bitwise(Vector, Vector_Length)):
+            print("CRC32 self test failed on length", Vector_Length)
+            sys.exit(EXIT_SELF_TEST_FAILED)
     
-def Word_Value_To_Byte_Value(Word_Value, Byte_Index, Byte_Lower_First):
-    Byte_Value = (Word_Value >> (8 * (Byte_Index - 1)) & 0x000000FF)
-    return Byte_Value
 
-def CalulateBinFileLength():
-    BinFileLength = os.path.getsize("Application.bin")
-    return BinFileLength
+def LZ_Find_Match(Data, Position, Candidates, Max_Length):
+    Best_Length = 0
+    Best_Distance = 0
+    for Candidate in reversed(Candidates):
+        Distance = Position - Candidate
+        if(Distance <= 0):
+            continue
+        if(Distance > LZ_WINDOW_SIZE):
+            break
+        Length = 0
+        while(Length < Max_Length and Data[Candidate + Length] == Data[Position + Length]):
+            Length = Length + 1
+        if(Length > Best_Length):
+            Best_Length = Length
+            Best_Distance = Distance
+            if(Length == Max_Length):
+                break
+    return Best_Length, Best_Distance
 
-def OpenBinFile():
-    global BinFile
-    BinFile = open('Application.bin', 'rb')
+def LZ_Compress_Frames(Data):
+    ''' Split Data into (output offset, output length, payload) frames for CBL_MEM_WRITE_LZ_CMD.
+        Tokens never straddle frames and every frame but the last decodes to an even length,
+        since the bootloader programs half-words. '''
+    Frames = []
+    Hash_Table = {}
+    Position = 0
+    Data_Len = len(Data)
+    while(Position < Data_Len):
+        Frame_Start = Position
+        Tokens = []
+        Payload_Len = 0
+        Output_Len = 0
+        while(Position < Data_Len):
+            Max_Length = min(LZ_MAX_MATCH_LENGTH, Data_Len - Position, LZ_MAX_FRAME_OUTPUT - Output_Len)
+            if(Max_Length <= 0):
+                break
+            Key = bytes(Data[Position : Position + LZ_MIN_MATCH_LENGTH])
+            Length = 0
+            if(Max_Length >= LZ_MIN_MATCH_LENGTH):
+                Length, Distance = LZ_Find_Match(Data, Position, Hash_Table.get(Key, []), Max_Length)
+            if(Length >= LZ_MIN_MATCH_LENGTH):
+                if(Payload_Len + 2 > LZ_MAX_FRAME_PAYLOAD):
+                    break
+                Tokens.append([Length, Distance])
+                Payload_Len = Payload_Len + 2
+                Step = Length
+            else:
+                Extend = (len(Tokens) and isinstance(Tokens[-1], bytearray) and len(Tokens[-1]) < LZ_MAX_LITERAL_RUN)
+                if(Payload_Len + (1 if Extend else 2) > LZ_MAX_FRAME_PAYLOAD):
+                    break
+                if(Extend):
+                    Tokens[-1].append(Data[Position])
+                    Payload_Len = Payload_Len + 1
+                else:
+                    Tokens.append(bytearray([Data[Position]]))
+                    Payload_Len = Payload_Len + 2
+                Step = 1
+            for Hash_Position in range(Position, Position + Step):
+                Hash_Key = bytes(Data[Hash_Position : Hash_Position + LZ_MIN_MATCH_LENGTH])
+                Hash_Table.setdefault(Hash_Key, []).append(Hash_Position)
+                if(len(Hash_Table[Hash_Key]) > 16):
+                    del Hash_Table[Hash_Key][0]
+            Position = Position + Step
+            Output_Len = Output_Len + Step
+        ''' Give the last byte of an odd frame back to the next one '''
+        if(Output_Len % 2 and Position < Data_Len):
+            if(isinstance(Tokens[-1], bytearray)):
+                del Tokens[-1][-1]
+                if(not len(Tokens[-1])):
+                    del Tokens[-1]
+            elif(Tokens[-1][0] > LZ_MIN_MATCH_LENGTH):
+                Tokens[-1][0] = Tokens[-1][0] - 1
+            else:
+                del Tokens[-1]
+                Position = Position - (LZ_MIN_MATCH_LENGTH - 1)
+                Output_Len = Output_Len - (LZ_MIN_MATCH_LENGTH - 1)
+            Position = Position - 1
+            Output_Len = Output_Len - 1
+        Payload = bytearray()
+        for Token in Tokens:
+            if(isinstance(Token, bytearray)):
+                Payload.append(len(Token) - 1)
+                Payload.extend(Token)
+            else:
+                Payload.append(LZ_TOKEN_MATCH_FLAG | (Token[0] - LZ_MIN_MATCH_LENGTH))
+                Payload.append(Token[1] - 1)
+        Frames.append((Frame_Start, Output_Len, Payload))
+    return Frames
 
-def Decode_CBL_Command(Command):
-    BL_Host_Buffer = []
-    BL_Return_Value = 0
+def RLE_Tokens(Data):
+    ''' Split Data into [type, length, bytes] runs: 0xFF runs are skipped, other repeated bytes are filled '''
+    Tokens = []
+    Position = 0
+    Data_Len = len(Data)
+    while(Position < Data_Len):
+        Run_End = Position + 1
+        while(Run_End < Data_Len and Data[Run_End] == Data[Position]):
+            Run_End = Run_End + 1
+        Run_Len = Run_End - Position
+        if(Data[Position] == 0xFF and Run_Len >= RLE_MIN_SKIP_RUN):
+            Tokens.append([RLE_TOKEN_SKIP, Run_Len, b''])
+        elif(Run_Len >= RLE_MIN_FILL_RUN):
+            Tokens.append([RLE_TOKEN_FILL, Run_Len, bytes([Data[Position]])])
+        elif(len(Tokens) and Tokens[-1][0] == RLE_TOKEN_LITERAL):
+            Tokens[-1][1] = Tokens[-1][1] + Run_Len
+            Tokens[-1][2] = Tokens[-1][2] + bytes(Data[Position : Run_End])
+        else:
+            Tokens.append([RLE_TOKEN_LITERAL, Run_Len, bytes(Data[Position : Run_End])])
+        Position = Run_End
+    return Tokens
+
+def RLE_Split_Token(Token, Length):
+    ''' Cut the first Length bytes off Token, the rest is returned as a new token '''
+    Rest = [Token[0], Token[1] - Length, Token[2][Length:] if Token[0] == RLE_TOKEN_LITERAL else Token[2]]
+    Token[1] = Length
+    if(Token[0] == RLE_TOKEN_LITERAL):
+        Token[2] = Token[2][:Length]
+    return Rest
+
+def RLE_Encode_Frames(Data):
+    ''' Split Data into (output offset, output length, payload) frames for CBL_MEM_WRITE_RLE_CMD.
+        Every frame but the last decodes to an even length, since the bootloader programs half-words. '''
+    Frames = []
+    Tokens = RLE_Tokens(Data)
+    Offset = 0
+    while(len(Tokens)):
+        Frame_Tokens = []
+        Payload_Len = 0
+        Output_Len = 0
+        while(len(Tokens)):
+            Token = Tokens[0]
+            if(Token[0] == RLE_TOKEN_LITERAL):
+                Take = min(Token[1], RLE_MAX_LITERAL_RUN, RLE_MAX_FRAME_PAYLOAD - Payload_Len - 1)
+            elif(Payload_Len + (2 if Token[0] == RLE_TOKEN_SKIP else 3) <= RLE_MAX_FRAME_PAYLOAD):
+                Take = min(Token[1], RLE_MAX_RUN)
+            else:
+                Take = 0
+            Take = min(Take, RLE_MAX_FRAME_OUTPUT - Output_Len)
+            if(Take <= 0):
+                break
+            if(Take < Token[1]):
+                Tokens[0] = RLE_Split_Token(Token, Take)
+            else:
+                del Tokens[0]
+            Frame_Tokens.append(Token)
+            Payload_Len = Payload_Len + (1 + Take if Token[0] == RLE_TOKEN_LITERAL else 2 + len(Token[2]))
+            Output_Len = Output_Len + Take
+        ''' Give the last byte of an odd frame back to the next one '''
+        if(Output_Len % 2 and len(Tokens)):
+            Token = Frame_Tokens[-1]
+            if(Token[1] == 1):
+                del Frame_Tokens[-1]
+                Tokens.insert(0, Token)
+            else:
+                Tokens.insert(0, RLE_Split_Token(Token, Token[1] - 1))
+            Output_Len = Output_Len - 1
+        Payload = bytearray()
+        for Token in Frame_Tokens:
+            if(Token[0] == RLE_TOKEN_LITERAL):
+                Payload.append(Token[1] - 1)
+            else:
+                Payload.append(Token[0] | ((Token[1] - 1) >> 8))
+                Payload.append((Token[1] - 1) & 0xFF)
+            Payload.extend(Token[2])
+        Frames.append((Offset, Output_Len, Payload))
+        Offset = Offset + Output_Len
+    return Frames
+
+def Load_Intel_Hex(File_Name):
+    ''' Return the data records of an Intel HEX file as a list of (address, bytearray) '''
+    Segments = []
+    Upper_Address = 0
+    HexFile = open(File_Name, 'r')
+    for Line in HexFile:
+        Line = Line.strip()
+        if(not Line.startswith(':')):
+            continue
+        Record = bytes.fromhex(Line[1:])
+        if((sum(Record) & 0xFF) != 0 or len(Record) != Record[0] + 5):
+            raise ValueError("Bad Intel HEX record : " + Line)
+        Record_Type = Record[3]
+        Record_Data = Record[4 : 4 + Record[0]]
+        if(Record_Type == 0x00):
+            Address = Upper_Address + ((Record[1] << 8) | Record[2])
+            if(len(Segments) and Segments[-1][0] + len(Segments[-1][1]) == Address):
+                Segments[-1][1].extend(Record_Data)
+            else:
+                Segments.append((Address, bytearray(Record_Data)))
+        elif(Record_Type == 0x01):
+            break
+        elif(Record_Type == 0x02):
+            Upper_Address = ((Record_Data[0] << 8) | Record_Data[1]) << 4
+        elif(Record_Type == 0x04):
+            Upper_Address = ((Record_Data[0] << 8) | Record_Data[1]) << 16
+    HexFile.close()
+    return Segments
+
+def Load_Elf_Segments(File_Name):
+    ''' Return the PT_LOAD program headers of a 32-bit little endian ELF as (load address, bytearray) '''
+    Segments = []
+    ElfFile = open(File_Name, 'rb')
+    Image = ElfFile.read()
+    ElfFile.close()
+    if(Image[0:4] != b'\x7fELF' or Image[4] != 1 or Image[5] != 1):
+        raise ValueError("Only 32-bit little endian ELF files are supported")
+    Ph_Offset, = struct.unpack_from('<I', Image, 28)
+    Ph_Entry_Size, Ph_Count = struct.unpack_from('<HH', Image, 42)
+    for Ph_Index in range(Ph_Count):
+        P_Type, P_Offset, P_Vaddr, P_Paddr, P_Filesz = struct.unpack_from('<5I', Image, Ph_Offset + Ph_Index * Ph_Entry_Size)
+        if(P_Type == 1 and P_Filesz):
+            Segments.append((P_Paddr, bytearray(Image[P_Offset : P_Offset + P_Filesz])))
+    return Segments
+
+def Load_Image_Segments(File_Name, Base_Address = None):
+    ''' Intel HEX and ELF carry their own addresses, a raw binary is placed at Base_Address '''
+    Extension = os.path.splitext(File_Name)[1].lower()
+    if(Extension in ('.hex', '.ihex')):
+        return Load_Intel_Hex(File_Name)
+    elif(Extension in ('.elf', '.axf', '.out')):
+        return Load_Elf_Segments(File_Name)
+    if(Base_Address is None):
+        Base_Address = int(input("\n   Enter the start address : "), 16)
+    return [(Base_Address, Map_Image_File(File_Name))]
+
+def Merge_Segments(Segments, Max_Count):
+    ''' Half-word align the segments, join the touching ones and pad the smallest gaps with 0xFF
+        until the list fits one CBL_VERIFY_SEGMENTS_CMD frame '''
+    Aligned = []
+    for Address, Data in sorted(Segments, key = lambda Segment: Segment[0]):
+        Data = bytearray(Data)
+        if(Address % 2):
+            Address = Address - 1
+            Data.insert(0, 0xFF)
+        if(len(Data) % 2):
+            Data.append(0xFF)
+        if(len(Aligned) and Aligned[-1][0] + len(Aligned[-1][1]) >= Address):
+            Offset = Address - Aligned[-1][0]
+            Aligned[-1][1][Offset : Offset + len(Data)] = Data
+        else:
+            Aligned.append((Address, Data))
+    while(len(Aligned) > Max_Count):
+        Gaps = [Aligned[Index + 1][0] - Aligned[Index][0] - len(Aligned[Index][1]) for Index in range(len(Aligned) - 1)]
+        Index = Gaps.index(min(Gaps))
+        Aligned[Index][1].extend(b'\xff' * Gaps[Index])
+        Aligned[Index][1].extend(Aligned[Index + 1][1])
+        del Aligned[Index + 1]
+    return Aligned
+
+def Segment_Page_Runs(Segments):
+    ''' Return (first page, page count) runs covering every page touched by the segments '''
+    Pages = set()
+    for Address, Data in Segments:
+        First_Page = (Address - STM32F103_FLASH_BASE) // FLASH_PAGE_SIZE
+        Last_Page = (Address + len(Data) - 1 - STM32F103_FLASH_BASE) // FLASH_PAGE_SIZE
+        Pages.update(range(First_Page, Last_Page + 1))
+    return Page_Runs(Pages)
+
+def Page_Runs(Pages):
+    ''' Group page indexes into (first page, page count) runs for CBL_FLASH_ERASE_CMD '''
+    Runs = []
+    for Page in sorted(set(Pages)):
+        if(len(Runs) and Runs[-1][0] + Runs[-1][1] == Page and Runs[-1][1] < 0xFE):
+            Runs[-1][1] = Runs[-1][1] + 1
+        else:
+            Runs.append([Page, 1])
+    return Runs
+
+def Map_Image_File(File_Name):
+    ''' Map the image read-only, frames take memoryview slices of it without copying '''
+    ImageFile = open(File_Name, 'rb')
+    if(os.path.getsize(File_Name) == 0):
+        ImageFile.close()
+        return memoryview(b'')
+    Image = mmap.mmap(ImageFile.fileno(), 0, access = mmap.ACCESS_READ)
+    ImageFile.close()
+    return memoryview(Image)
+
+def Send_CBL_Write_Frame(Command_Code, Address, Payload, Output_Len = None):
+    ''' [address][payload length][payload], shared by the raw, compressed and run-length writes.
+        Output_Len is the decoded length when the payload is compressed or run-length coded. '''
+    if(Output_Len is None):
+        Output_Len = len(Payload)
+    Send_CBL_Frame(Command_Code, struct.pack('<IB', Address, len(Payload)), Payload,
+                   Device_Time = Write_Device_Time(Address, Output_Len))
+
+def Send_CBL_Erase_Frame(First_Page, Page_Count):
+    Erase_Pages = FLASH_MAX_PAGE_COUNT if (First_Page == 0xFF) else Page_Count
+    Send_CBL_Frame(CBL_FLASH_ERASE_CMD, bytes([First_Page, Page_Count]), Device_Time = Erase_Pages * FLASH_PAGE_ERASE_TIME)
+
+def Segment_Word(Segments, Address):
+    ''' Little endian word at Address inside the image, None when no segment holds it '''
+    for Segment_Address, Segment_Data in Segments:
+        if(Segment_Address <= Address and Address + 4 <= Segment_Address + len(Segment_Data)):
+            return struct.unpack_from('<I', Segment_Data, Address - Segment_Address)[0]
+    return None
+
+def Build_AES_Tables():
+    ''' S-box from the inverse in GF(2^8) walked with the generator 3, and the T-table of bl_aes128.c '''
+    Sbox = [0x63] * 256
+    P = Q = 1
+    while True:
+        P = P ^ ((P << 1) & 0xFF) ^ (0x1B if P & 0x80 else 0)
+        Q = Q ^ (Q << 1)
+        Q = Q ^ (Q << 2)
+        Q = (Q ^ (Q << 4)) & 0xFF
+        if(Q & 0x80):
+            Q = Q ^ 0x09
+        Affine = Q
+        for Shift in range(1, 5):
+            Affine = Affine ^ (((Q << Shift) | (Q >> (8 - Shift))) & 0xFF)
+        Sbox[P] = Affine ^ 0x63
+        if(P == 1):
+            break
+    Double = [((Value << 1) ^ (0x1B if Value & 0x80 else 0)) & 0xFF for Value in Sbox]
+    Te0 = [(Double[Index] << 24) | (Sbox[Index] << 16) | (Sbox[Index] << 8) | (Double[Index] ^ Sbox[Index]) for Index in range(256)]
+    return Sbox, Te0
+
+AES_SBOX, AES_TE0 = Build_AES_Tables()
+
+def AES128_Expand_Key(Key):
+    Round_Key = list(struct.unpack('>4I', Key))
+    Rcon = 1
+    for Round in range(10):
+        Word = Round_Key[-1]
+        Word = ((AES_SBOX[(Word >> 16) & 0xFF] << 24) | (AES_SBOX[(Word >> 8) & 0xFF] << 16) |
+                (AES_SBOX[Word & 0xFF] << 8) | AES_SBOX[Word >> 24]) ^ (Rcon << 24)
+        Round_Key.append(Round_Key[-4] ^ Word)
+        for Index in range(3):
+            Round_Key.append(Round_Key[-4] ^ Round_Key[-1])
+        Rcon = ((Rcon << 1) ^ (0x1B if Rcon & 0x80 else 0)) & 0xFF
+    return Round_Key
+
+def AES128_Encrypt_Block(Round_Key, Block):
+    def Rotate(Value, Shift):
+        return ((Value >> Shift) | (Value << (32 - Shift))) & 0xFFFFFFFF
+    State = [Word ^ Round_Key[Index] for Index, Word in enumerate(struct.unpack('>4I', Block))]
+    for Round in range(1, 10):
+        State = [AES_TE0[State[Index] >> 24] ^ Rotate(AES_TE0[(State[(Index + 1) % 4] >> 16) & 0xFF], 8) ^
+                 Rotate(AES_TE0[(State[(Index + 2) % 4] >> 8) & 0xFF], 16) ^ Rotate(AES_TE0[State[(Index + 3) % 4] & 0xFF], 24) ^
+                 Round_Key[4 * Round + Index] for Index in range(4)]
+    return struct.pack('>4I', *[(AES_SBOX[State[Index] >> 24] << 24) ^ (AES_SBOX[(State[(Index + 1) % 4] >> 16) & 0xFF] << 16) ^
+                                (AES_SBOX[(State[(Index + 2) % 4] >> 8) & 0xFF] << 8) ^ AES_SBOX[State[(Index + 3) % 4] & 0xFF] ^
+                                Round_Key[40 + Index] for Index in range(4)])
+
+def AES128_CTR_Xor(Round_Key, Nonce, Data):
+    ''' BL_AES128_CTR_Xor, encryption and decryption are the same '''
+    Key_Stream = b''.join(AES128_Encrypt_Block(Round_Key, Nonce + struct.pack('>Q', Counter))
+                          for Counter in range((len(Data) + 15) // 16))
+    return bytes(Value ^ Key_Stream[Index] for Index, Value in enumerate(Data))
+
+def Load_AES_Key(File_Name):
+    ''' The key written by keygen --aes, None when the file cannot be read or holds no 16 byte key '''
+    try:
+        with open(File_Name) as Key_File:
+            Key = bytes.fromhex(Key_File.read().strip())
+    except (OSError, ValueError):
+        return None
+    return Key if len(Key) == BL_AES_KEY_SIZE and any(Key) else None
+
+class BL_Transfer_Plan:
+    ''' Every frame a flash run sends, built once per image.
+        Pages holds (page index, page CRC32, compare frame, write frames, image bytes) per touched flash page,
+        the page CRC covers the whole page as it reads after the write, bytes outside the image stay 0xFF.
+        Frames are kept as (frame bytes, device time) pairs, ready for BL_Session.Transact_Frame. '''
+    def __init__(self, Pages, Verify_Frame, Jump_Frame):
+        self.Pages = Pages
+        self.Verify_Frame = Verify_Frame
+        self.Jump_Frame = Jump_Frame
+        self.Bytes_Total = sum(Page[4] for Page in Pages)
+        self.Wire_Bytes = sum(len(Frame) for Page in Pages for Frame, Device_Time in Page[3])
+
+def Build_Plan_Frame(Frame_View, Command_Code, *Fields, Device_Time = 0):
+    Frame_Len = Build_CBL_Frame(Frame_View, Command_Code, *Fields)
+    return (bytes(Frame_View[:Frame_Len]), Device_Time)
+
+def Build_Write_Frames(Frame_View, Address, Data, Mode, Sequence_Number = 0, AES_Key = None):
+    ''' Write frames for a run of image bytes inside one page. The encoders start from an empty history
+        for every run, so a page decodes on its own whatever was written before it.
+        'seq' frames are numbered from Sequence_Number on. 'aes' frames are encrypted with AES_Key, the nonce
+        is a MAC of the address and the plain payload: the same frame always encrypts the same and
+        two different payloads never share key stream, so plans stay cacheable. '''
+    if(Mode == 'lz'):
+        Frames = LZ_Compress_Frames(Data)
+    elif(Mode == 'rle'):
+        Frames = RLE_Encode_Frames(Data)
+    else:
+        Frames = [(Offset, min(SEGMENT_WRITE_CHUNK, len(Data) - Offset), Data[Offset : Offset + SEGMENT_WRITE_CHUNK])
+                  for Offset in range(0, len(Data), SEGMENT_WRITE_CHUNK)]
+    if(Mode == 'aes'):
+        Round_Key = AES128_Expand_Key(AES_Key)
+    Write_Frames = []
+    for Index, (Offset, Output_Len, Payload) in enumerate(Frames):
+        Header = struct.pack('<IB', Address + Offset, len(Payload))
+        Device_Time = Write_Device_Time(Address + Offset, Output_Len)
+        if(Mode == 'seq'):
+            Header = struct.pack('<H', (Sequence_Number + Index) & 0xFFFF) + Header
+        elif(Mode == 'aes'):
+            Nonce = hmac.new(AES_Key, struct.pack('<I', Address + Offset) + bytes(Payload), hashlib.sha256).digest()[:BL_AES_NONCE_SIZE]
+            Header = Header + Nonce
+            Payload = AES128_CTR_Xor(Round_Key, Nonce, Payload)
+            Device_Time = Device_Time + len(Payload) * AES_DECRYPT_BYTE_TIME
+        Write_Frames.append(Build_Plan_Frame(Frame_View, BL_WRITE_MODES[Mode], Header, Payload, Device_Time = Device_Time))
+    return Write_Frames
+
+def Build_Transfer_Plan(Segments, Vector_Table_Address, Mode = 'raw', AES_Key = None):
+    ''' Write frames never cross a page boundary, so a page can be skipped or rewritten on its own.
+        Sequence numbers run through the whole plan; every transfer erases first, which clears the history
+        of the bootloader, so one plan can be sent again and again. '''
+    Frame_View = memoryview(bytearray(BL_HOST_BUFFER_LENGTH))
+    Page_Images = {}
+    Page_Frames = {}
+    Page_Bytes = {}
+    Frame_Count = 0
+    for Segment_Address, Segment_Data in Segments:
+        Segment_View = memoryview(Segment_Data)
+        Offset = 0
+        while(Offset < len(Segment_Data)):
+            Address = Segment_Address + Offset
+            Page_Index = (Address - STM32F103_FLASH_BASE) // FLASH_PAGE_SIZE
+            Page_Offset = (Address - STM32F103_FLASH_BASE) % FLASH_PAGE_SIZE
+            Run = Segment_View[Offset : Offset + FLASH_PAGE_SIZE - Page_Offset]
+            if(Page_Index not in Page_Images):
+                Page_Images[Page_Index] = bytearray(b'\xff' * FLASH_PAGE_SIZE)
+                Page_Frames[Page_Index] = []
+                Page_Bytes[Page_Index] = 0
+            Page_Images[Page_Index][Page_Offset : Page_Offset + len(Run)] = Run
+            Write_Frames = Build_Write_Frames(Frame_View, Address, Run, Mode, Frame_Count, AES_Key)
+            Page_Frames[Page_Index].extend(Write_Frames)
+            Frame_Count = Frame_Count + len(Write_Frames)
+            Page_Bytes[Page_Index] = Page_Bytes[Page_Index] + len(Run)
+            Offset = Offset + len(Run)
     
-    ''' Clear the bootloader host buffer '''
-    for counter in range(255):
-        BL_Host_Buffer.append(0)
+    Pages = []
+    for Page_Index in sorted(Page_Images):
+        Page_CRC32 = Calculate_CRC32(Page_Images[Page_Index], FLASH_PAGE_SIZE) & 0xFFFFFFFF
+        Compare_Frame = Build_Plan_Frame(Frame_View, CBL_VERIFY_SEGMENTS_CMD,
+                                         struct.pack('<BII', 1, STM32F103_FLASH_BASE + Page_Index * FLASH_PAGE_SIZE, FLASH_PAGE_SIZE),
+                                         struct.pack('<I', Page_CRC32), Device_Time = FLASH_PAGE_SIZE * FLASH_CRC_BYTE_TIME)
+        Pages.append((Page_Index, Page_CRC32, Compare_Frame, Page_Frames[Page_Index], Page_Bytes[Page_Index]))
+    
+    ''' One CRC over all segments back to back '''
+    Session_Data = bytearray()
+    Segment_List = bytearray([len(Segments)])
+    for Segment_Address, Segment_Data in Segments:
+        Session_Data.extend(Segment_Data)
+        Segment_List.extend(struct.pack('<II', Segment_Address, len(Segment_Data)))
+    Session_CRC32 = Calculate_CRC32(Session_Data, len(Session_Data)) & 0xFFFFFFFF
+    Verify_Frame = Build_Plan_Frame(Frame_View, CBL_VERIFY_SEGMENTS_CMD, Segment_List, struct.pack('<I', Session_CRC32),
+                                    Device_Time = len(Session_Data) * FLASH_CRC_BYTE_TIME)
+    
+    ''' CBL_GO_TO_ADDR_CMD calls the address it gets, so hand it the reset handler of the image '''
+    Jump_Frame = None
+    Reset_Handler = Segment_Word(Segments, Vector_Table_Address + 4)
+    if(Reset_Handler is not None):
+        Jump_Frame = Build_Plan_Frame(Frame_View, CBL_GO_TO_ADDR_CMD, struct.pack('<I', Reset_Handler & ~1))
+    return BL_Transfer_Plan(Pages, Verify_Frame, Jump_Frame)
+
+def Pack_Plan_Frame(Plan_Frame):
+    return struct.pack('<f', Plan_Frame[1]) + Plan_Frame[0]
+
+def Unpack_Plan_Frame(Data, Offset):
+    ''' The frame length byte delimits the record, returns the frame and the offset of the next record '''
+    Device_Time = struct.unpack_from('<f', Data, Offset)[0]
+    Frame_Len = Data[Offset + 4] + 1
+    return (bytes(Data[Offset + 4 : Offset + 4 + Frame_Len]), Device_Time), Offset + 4 + Frame_Len
+
+def Save_Transfer_Plan(Plan, File_Name):
+    ''' [magic][version][page count] then per page [index][CRC32][frame count][image bytes][compare frame][write frames],
+        then the verify frame and an optional jump frame. Written to a temporary file first,
+        so parallel runs never read a half written plan. '''
+    Records = [struct.pack('<6sBH', BL_PLAN_MAGIC, BL_PLAN_VERSION, len(Plan.Pages))]
+    for Page_Index, Page_CRC32, Compare_Frame, Write_Frames, Page_Bytes in Plan.Pages:
+        Records.append(struct.pack('<HIHH', Page_Index, Page_CRC32, len(Write_Frames), Page_Bytes))
+        Records.append(Pack_Plan_Frame(Compare_Frame))
+        Records.extend(Pack_Plan_Frame(Write_Frame) for Write_Frame in Write_Frames)
+    Records.append(Pack_Plan_Frame(Plan.Verify_Frame))
+    Records.append(bytes([Plan.Jump_Frame is not None]))
+    if(Plan.Jump_Frame is not None):
+        Records.append(Pack_Plan_Frame(Plan.Jump_Frame))
+    os.makedirs(os.path.dirname(File_Name), exist_ok = True)
+    Temp_File_Name = "{}.{}.tmp".format(File_Name, os.getpid())
+    with open(Temp_File_Name, 'wb') as Plan_File:
+        Plan_File.write(b''.join(Records))
+    os.replace(Temp_File_Name, File_Name)
+
+def Load_Transfer_Plan(File_Name):
+    ''' None when the file is missing, truncated or written by another plan version '''
+    try:
+        with open(File_Name, 'rb') as Plan_File:
+            Data = Plan_File.read()
+        Magic, Version, Page_Count = struct.unpack_from('<6sBH', Data, 0)
+        if(Magic != BL_PLAN_MAGIC or Version != BL_PLAN_VERSION):
+            return None
+        Offset = struct.calcsize('<6sBH')
+        Pages = []
+        for Page_Number in range(Page_Count):
+            Page_Index, Page_CRC32, Frame_Count, Page_Bytes = struct.unpack_from('<HIHH', Data, Offset)
+            Compare_Frame, Offset = Unpack_Plan_Frame(Data, Offset + struct.calcsize('<HIHH'))
+            Write_Frames = []
+            for Frame_Number in range(Frame_Count):
+                Write_Frame, Offset = Unpack_Plan_Frame(Data, Offset)
+                Write_Frames.append(Write_Frame)
+            Pages.append((Page_Index, Page_CRC32, Compare_Frame, Write_Frames, Page_Bytes))
+        Verify_Frame, Offset = Unpack_Plan_Frame(Data, Offset)
+        Jump_Frame = None
+        if(Data[Offset]):
+            Jump_Frame, Offset = Unpack_Plan_Frame(Data, Offset + 1)
+        if(Offset != len(Data)):
+            return None
+        return BL_Transfer_Plan(Pages, Verify_Frame, Jump_Frame)
+    except (OSError, struct.error, IndexError):
+        return None
+
+def Get_Transfer_Plan(File_Name, Base_Address, Cache_Directory, Mode = 'raw', Max_Segments = BL_MAX_SEGMENTS, AES_Key = None):
+    ''' Returns the plan and whether it came from the cache. The key hashes the image file together
+        with everything the frames depend on, a changed image or setting simply gets a new cache file.
+        An 'aes' plan holds only cipher text, it can be kept where the image itself may not be. '''
+    Image_Hash = hashlib.sha256(struct.pack('<BIII', BL_PLAN_VERSION, Base_Address, SEGMENT_WRITE_CHUNK, Max_Segments))
+    Image_Hash.update(os.path.splitext(File_Name)[1].lower().encode() + b':' + Mode.encode())
+    if(Mode == 'aes'):
+        Image_Hash.update(hashlib.sha256(AES_Key).digest())
+    with open(File_Name, 'rb') as ImageFile:
+        Image_Hash.update(ImageFile.read())
+    Plan_File_Name = None
+    if(Cache_Directory):
+        Plan_File_Name = os.path.join(Cache_Directory, Image_Hash.hexdigest() + ".plan")
+        Plan = Load_Transfer_Plan(Plan_File_Name)
+        if(Plan is not None):
+            return Plan, True
+    Segments = Merge_Segments(Load_Image_Segments(File_Name, Base_Address), Max_Segments)
+    Plan = Build_Transfer_Plan(Segments, Base_Address, Mode, AES_Key)
+    if(Plan_File_Name):
+        try:
+            Save_Transfer_Plan(Plan, Plan_File_Name)
+        except OSError:
+            print("plan  : cannot write the cache file " + Plan_File_Name)
+    return Plan, False
+
+def P256_Add(Point_1, Point_2):
+    ''' Affine point addition on P-256, None is the point at infinity '''
+    if(Point_1 is None):
+        return Point_2
+    if(Point_2 is None):
+        return Point_1
+    if(Point_1[0] == Point_2[0]):
+        if((Point_1[1] + Point_2[1]) % P256_P == 0):
+            return None
+        Slope = (3 * Point_1[0] * Point_1[0] - 3) * pow(2 * Point_1[1], -1, P256_P) % P256_P
+    else:
+        Slope = (Point_2[1] - Point_1[1]) * pow(Point_2[0] - Point_1[0], -1, P256_P) % P256_P
+    X = (Slope * Slope - Point_1[0] - Point_2[0]) % P256_P
+    return (X, (Slope * (Point_1[0] - X) - Point_1[1]) % P256_P)
+
+def P256_Multiply(Scalar, Point):
+    Result = None
+    for Bit in bin(Scalar)[2:]:
+        Result = P256_Add(Result, Result)
+        if(Bit == '1'):
+            Result = P256_Add(Result, Point)
+    return Result
+
+def ECDSA_P256_Sign(Private_Key, Digest):
+    ''' Signature (r, s) with the nonce of RFC 6979, the same image and key always give the same signature '''
+    Key_Bytes = Private_Key.to_bytes(32, 'big')
+    Hash_Bytes = (int.from_bytes(Digest, 'big') % P256_N).to_bytes(32, 'big')
+    V = b'\x01' * 32
+    K = b'\x00' * 32
+    K = hmac.new(K, V + b'\x00' + Key_Bytes + Hash_Bytes, hashlib.sha256).digest()
+    V = hmac.new(K, V, hashlib.sha256).digest()
+    K = hmac.new(K, V + b'\x01' + Key_Bytes + Hash_Bytes, hashlib.sha256).digest()
+    V = hmac.new(K, V, hashlib.sha256).digest()
+    while True:
+        V = hmac.new(K, V, hashlib.sha256).digest()
+        Nonce = int.from_bytes(V, 'big')
+        if(1 <= Nonce < P256_N):
+            R = P256_Multiply(Nonce, P256_G)[0] % P256_N
+            S = pow(Nonce, -1, P256_N) * (int.from_bytes(Digest, 'big') + R * Private_Key) % P256_N
+            if(R and S):
+                return R, S
+        K = hmac.new(K, V + b'\x00', hashlib.sha256).digest()
+        V = hmac.new(K, V, hashlib.sha256).digest()
+
+def ECDSA_P256_Verify(Public_Key, Digest, R, S):
+    ''' Same checks as BL_ECDSA_P256_Verify, used to test a signature before it is sent '''
+    if(not (1 <= R < P256_N and 1 <= S < P256_N)):
+        return False
+    W = pow(S, -1, P256_N)
+    Point = P256_Add(P256_Multiply(int.from_bytes(Digest, 'big') * W % P256_N, P256_G), P256_Multiply(R * W % P256_N, Public_Key))
+    return Point is not None and Point[0] % P256_N == R
+
+def Keygen(Arguments):
+    ''' A new signing key: the private key as hex in the --key file, the public key X || Y as hex in the .pub file
+        next to it and as the initializer for Bootloader/bl_auth_key.h on the console. With --aes an image
+        encryption key for Bootloader/bl_aes_key.h instead. Returns the process exit code. '''
+    if(os.path.exists(Arguments.key)):
+        print("key   : {} exists, it is not overwritten".format(Arguments.key))
+        return EXIT_AUTH_FAILED
+    if(Arguments.aes):
+        AES_Key = secrets.token_bytes(BL_AES_KEY_SIZE)
+        with open(Arguments.key, 'x') as Key_File:
+            Key_File.write(AES_Key.hex() + "\n")
+        print("key   : AES-128 key in {}, the same key goes into Bootloader/bl_aes_key.h".format(Arguments.key))
+        print("#define BL_AES_KEY { \\")
+        print("\t" + ", ".join("0x{:02X}".format(Value) for Value in AES_Key) + "  \\")
+        print("}")
+        return EXIT_OK
+    Private_Key = secrets.randbelow(P256_N - 1) + 1
+    Public_Key = P256_Multiply(Private_Key, P256_G)
+    Public_Bytes = Public_Key[0].to_bytes(32, 'big') + Public_Key[1].to_bytes(32, 'big')
+    with open(Arguments.key, 'x') as Key_File:
+        Key_File.write("{:064x}\n".format(Private_Key))
+    with open(Arguments.key + ".pub", 'w') as Key_File:
+        Key_File.write(Public_Bytes.hex() + "\n")
+    print("key   : private key in {}, keep it off the build machines; public key in {}.pub".format(Arguments.key, Arguments.key))
+    print("#define BL_AUTH_PUBLIC_KEY { \\")
+    for Offset in range(0, len(Public_Bytes), 16):
+        print("\t" + ", ".join("0x{:02X}".format(Value) for Value in Public_Bytes[Offset : Offset + 16]) +
+              (", \\" if Offset + 16 < len(Public_Bytes) else "  \\"))
+    print("}")
+    return EXIT_OK
+
+def Build_Auth_Frame(Segments, Key_File_Name):
+    ''' CBL_AUTH_VERIFY_CMD for an image flashed as one segment, the signature covers exactly the bytes written.
+        Returns (frame bytes, device time) for BL_Session.Transact_Frame, None when the key cannot be read. '''
+    try:
+        with open(Key_File_Name) as Key_File:
+            Private_Key = int(Key_File.read().strip(), 16)
+    except (OSError, ValueError):
+        return None
+    Address, Data = Segments[0]
+    Digest = hashlib.sha256(Data).digest()
+    R, S = ECDSA_P256_Sign(Private_Key, Digest)
+    if(not ECDSA_P256_Verify(P256_Multiply(Private_Key, P256_G), Digest, R, S)):
+        return None
+    return Build_Plan_Frame(memoryview(bytearray(BL_HOST_BUFFER_LENGTH)), CBL_AUTH_VERIFY_CMD,
+                            struct.pack('<II', Address, len(Data)), R.to_bytes(32, 'big'), S.to_bytes(32, 'big'),
+                            Device_Time = len(Data) * FLASH_HASH_BYTE_TIME + BL_AUTH_VERIFY_TIME)
+
+def Batch_Flash(Arguments):
+    ''' Erase, write, verify and jump on every --port at once, one session thread per device.
+        The transfer plan is built or loaded once and only read by the sessions. Returns the process exit code. '''
+    ''' A signed image goes out as one segment, the gaps filled with 0xFF, so the bootloader hashes what it wrote '''
+    Max_Segments = 1 if Arguments.sign else BL_MAX_SEGMENTS
+    AES_Key = None
+    if(Arguments.mode == 'aes'):
+        AES_Key = Load_AES_Key(Arguments.aes_key or "")
+        if(AES_Key is None):
+            print("aes   : --mode aes needs --aes-key with the key from keygen --aes")
+            return EXIT_AUTH_FAILED
+    Plan, Plan_Cached = Get_Transfer_Plan(Arguments.image, Arguments.addr, None if Arguments.no_cache else BL_PLAN_CACHE_DIR,
+                                          Arguments.mode, Max_Segments, AES_Key)
+    if(Arguments.jump and Plan.Jump_Frame is None):
+        print("jump  : no vector table at 0x{:08X}".format(Arguments.addr))
+        return EXIT_JUMP_FAILED
+    Auth_Frame = None
+    if(Arguments.sign):
+        Auth_Frame = Build_Auth_Frame(Merge_Segments(Load_Image_Segments(Arguments.image, Arguments.addr), 1), Arguments.sign)
+        if(Auth_Frame is None):
+            print("sign  : cannot sign with the key in " + Arguments.sign)
+            return EXIT_AUTH_FAILED
+    
+    print("image : {} bytes in {} pages, {} page runs, {} {} frame bytes, plan {}".format(Plan.Bytes_Total, len(Plan.Pages),
+          len(Page_Runs(Page[0] for Page in Plan.Pages)), Plan.Wire_Bytes, Arguments.mode, "cached" if Plan_Cached else "built"))
+    Sessions = [BL_Session(Port_Name, BL_Baudrate, BL_Pace_Delay, Arguments.verbose, Arguments.retries, Arguments.window)
+                for Port_Name in Arguments.port]
+    Threads = [threading.Thread(target = Session.Run_Flash, args = (Plan, Arguments.verify, Arguments.jump, Arguments.delta, Auth_Frame),
+                                daemon = True) for Session in Sessions]
+    Start_Time = time.time()
+    for Session_Thread in Threads:
+        Session_Thread.start()
+    while any(Session_Thread.is_alive() for Session_Thread in Threads):
+        [Session_Thread for Session_Thread in Threads if Session_Thread.is_alive()][0].join(BL_PROGRESS_INTERVAL)
+        if(not Arguments.verbose):
+            print("   " + "  ".join("{}:{} {}%".format(Session.Port_Name, Session.Stage, Session.Progress()) for Session in Sessions))
+    Elapsed_Time = time.time() - Start_Time
+    
+    Exit_Code = EXIT_OK
+    Flashed_Bytes = 0
+    for Session in Sessions:
+        if(Session.Exit_Code == EXIT_OK):
+            print("{} : done, {}/{} pages written, {} link errors, {} pages repaired".format(Session.Port_Name,
+                  Session.Pages_Written, len(Plan.Pages), Session.Link_Errors, Session.Page_Repairs))
+            if(Session.Auth_Reply is not None):
+                Streamed_Bytes, Hash_Cycles, Verify_Cycles = struct.unpack_from('<III', Session.Auth_Reply, 2)
+                print("{} : signature ok, {} hash, {} of {} bytes hashed while writing, {:.1f} cycles/byte, verify {} cycles".format(
+                      Session.Port_Name, "streamed" if Session.Auth_Reply[1] == BL_AUTH_PATH_STREAMED else "full", Streamed_Bytes,
+                      Plan.Bytes_Total, Hash_Cycles / Plan.Bytes_Total if Plan.Bytes_Total else 0, Verify_Cycles))
+            Flashed_Bytes = Flashed_Bytes + Session.Bytes_Written
+        else:
+            print("{} : failed in {}, {} (exit {})".format(Session.Port_Name, Session.Stage, Session.Error_Message, Session.Exit_Code))
+            if(Exit_Code == EXIT_OK):
+                Exit_Code = Session.Exit_Code
+    print("done  : {}/{} devices, {} bytes in {:.2f} s, {:.0f} B/s aggregate".format(
+          sum(Session.Exit_Code == EXIT_OK for Session in Sessions), len(Sessions), Flashed_Bytes, Elapsed_Time,
+          Flashed_Bytes / Elapsed_Time if Elapsed_Time else 0))
+    return Exit_Code
+
+def Broadcast_Flash(Arguments):
+    ''' Update every node of a shared bus at once: the erase and the sequence numbered frames go out a single time,
+        then each node is selected in turn, reports the frames it missed and gets only those again. A node that still
+        fails the session CRC, e.g. because it missed the erase, gets the pages that differ. Returns the process exit code. '''
+    Plan, Plan_Cached = Get_Transfer_Plan(Arguments.image, Arguments.addr, None if Arguments.no_cache else BL_PLAN_CACHE_DIR, 'seq')
+    Frames = [Frame for Page in Plan.Pages for Frame in Page[3]]
+    if(len(Frames) > BL_BCAST_MAX_FRAMES):
+        print("image : {} frames, a broadcast takes at most {}".format(len(Frames), BL_BCAST_MAX_FRAMES))
+        return EXIT_WRITE_FAILED
+    if(Arguments.jump and Plan.Jump_Frame is None):
+        print("jump  : no vector table at 0x{:08X}".format(Arguments.addr))
+        return EXIT_JUMP_FAILED
+    
+    print("image : {} bytes in {} pages, {} seq frames, {} frame bytes, plan {}".format(Plan.Bytes_Total, len(Plan.Pages),
+          len(Frames), Plan.Wire_Bytes, "cached" if Plan_Cached else "built"))
+    Session = BL_Session(Arguments.port, BL_Baudrate, BL_Pace_Delay, Arguments.verbose, Arguments.retries, Arguments.window)
+    Results = {}
+    Start_Time = time.time()
+    try:
+        Session.Open()
+        ''' A node that is not there now would need the whole image later '''
+        Nodes = []
+        for Node in Arguments.nodes:
+            try:
+                Session.Select_Node(Node)
+                Nodes.append(Node)
+            except BL_Session_Error as Error:
+                Results[Node] = (Error.Exit_Code, str(Error))
+        Session.Select_Node(BL_NODE_BROADCAST)
+        for First_Page, Page_Count in Page_Runs(Page[0] for Page in Plan.Pages):
+            Session.Broadcast(CBL_FLASH_ERASE_CMD, bytes([First_Page, Page_Count]), Device_Time = Page_Count * FLASH_PAGE_ERASE_TIME)
+        for Frame, Device_Time in Frames:
+            Session.Broadcast_Frame(Frame, Device_Time)
+        ''' A node that missed every broadcast select answered the stream '''
+        Session.Wait_Frame_Gap()
+        print("bcast : {} frames to {} nodes in {:.2f} s".format(len(Frames), len(Nodes), time.time() - Start_Time))
+        Pages_Rewritten = 0
+        for Node in Nodes:
+            Missing = []
+            Session.Pages_Written = 0
+            try:
+                Session.Select_Node(Node)
+                Missing = Session.Broadcast_Missing(len(Frames))
+                if(len(Missing)):
+                    Session.Transact_Window([Frames[Index] for Index in Missing])
+                if(Session.Transact_Frame(*Plan.Verify_Frame)[0] != SEGMENT_CRC_PASSED):
+                    Session.Flash(Plan, True, False, True)
+                Pages_Rewritten = Pages_Rewritten + Session.Pages_Written
+                Results[Node] = (EXIT_OK, "done, {} frames missed, {} pages rewritten".format(len(Missing), Session.Pages_Written))
+            except BL_Session_Error as Error:
+                Results[Node] = (Error.Exit_Code, str(Error))
+        ''' A node still listening to the broadcast when it missed its deselect also takes the erase of a page rewrite,
+            so after one the finished nodes are checked again. The jumps come last, an application may talk on the bus. '''
+        for Node in [Node for Node in Nodes if Results[Node][0] == EXIT_OK and (Pages_Rewritten or Arguments.jump)]:
+            try:
+                Session.Select_Node(Node)
+                if(Pages_Rewritten and Session.Transact_Frame(*Plan.Verify_Frame)[0] != SEGMENT_CRC_PASSED):
+                    Session.Flash(Plan, True, False, True)
+                if(Arguments.jump and Session.Transact_Frame(*Plan.Jump_Frame)[0] != 1):
+                    raise BL_Session_Error(EXIT_JUMP_FAILED, "jump refused")
+            except BL_Session_Error as Error:
+                Results[Node] = (Error.Exit_Code, str(Error))
+    except BL_Session_Error as Error:
+        print("{} : {} (exit {})".format(Arguments.port, Error, Error.Exit_Code))
+        return Error.Exit_Code
+    except (OSError, serial.SerialException) as Error:
+        print("{} : {} (exit {})".format(Arguments.port, Error, EXIT_PORT_ERROR))
+        return EXIT_PORT_ERROR
+    finally:
+        Session.Close()
+    Elapsed_Time = time.time() - Start_Time
+    
+    Exit_Code = EXIT_OK
+    for Node in Arguments.nodes:
+        Node_Exit_Code, Message = Results.get(Node, (EXIT_NO_RESPONSE, "not reached"))
+        print("0x{:04X} : {}{}".format(Node, Message, "" if Node_Exit_Code == EXIT_OK else " (exit {})".format(Node_Exit_Code)))
+        if(Node_Exit_Code != EXIT_OK and Exit_Code == EXIT_OK):
+            Exit_Code = Node_Exit_Code
+    print("done  : {}/{} nodes, {} bytes each in {:.2f} s, {} link errors".format(
+          sum(Results.get(Node, (EXIT_NO_RESPONSE,))[0] == EXIT_OK for Node in Arguments.nodes), len(Arguments.nodes),
+          Plan.Bytes_Total, Elapsed_Time, Session.Link_Errors))
+    return Exit_Code
+
+def Bench(Arguments):
+    ''' Flash the image Runs times in every write mode and report goodput, the bytes of image written per second,
+        and what the link errors cost, e.g. against BL_Simulator.py with fault injection. Returns the process exit code. '''
+    Exit_Code = EXIT_OK
+    AES_Key = None
+    if('aes' in Arguments.modes):
+        AES_Key = Load_AES_Key(Arguments.aes_key or "")
+        if(AES_Key is None):
+            print("aes   : the aes mode needs --aes-key with the key from keygen --aes")
+            return EXIT_AUTH_FAILED
+    print("mode run  result  time s  goodput B/s  frame B  errors  resent  repairs  recovery s")
+    for Mode in Arguments.modes:
+        Plan, Plan_Cached = Get_Transfer_Plan(Arguments.image, Arguments.addr, None if Arguments.no_cache else BL_PLAN_CACHE_DIR, Mode,
+                                              AES_Key = AES_Key)
+        Results = []
+        for Run in range(Arguments.runs):
+            Session = BL_Session(Arguments.port, BL_Baudrate, BL_Pace_Delay, Arguments.verbose, Arguments.retries, Arguments.window)
+            Start_Time = time.time()
+            Session.Run_Flash(Plan, True, False, False)
+            Elapsed_Time = time.time() - Start_Time
+            Goodput = Plan.Bytes_Total / Elapsed_Time if Session.Exit_Code == EXIT_OK else 0
+            Results.append((Session, Elapsed_Time, Goodput))
+            print("{:<4} {:>3}  {:<6} {:>7.2f} {:>12.0f} {:>8} {:>7} {:>7} {:>8} {:>11.2f}".format(Mode, Run + 1,
+                  "ok" if Session.Exit_Code == EXIT_OK else "exit {}".format(Session.Exit_Code), Elapsed_Time, Goodput,
+                  Plan.Wire_Bytes, Session.Link_Errors, Session.Retransmissions, Session.Page_Repairs, Session.Recovery_Time))
+            if(Session.Exit_Code != EXIT_OK and Exit_Code == EXIT_OK):
+                Exit_Code = Session.Exit_Code
+        Recoveries = sum(Session.Recoveries for Session, Elapsed_Time, Goodput in Results)
+        print("{:<4} mean {}/{} ok, {:.0f} B/s, {:.3f} s per recovery".format(Mode,
+              sum(Session.Exit_Code == EXIT_OK for Session, Elapsed_Time, Goodput in Results), len(Results),
+              sum(Goodput for Session, Elapsed_Time, Goodput in Results) / len(Results),
+              sum(Session.Recovery_Time for Session, Elapsed_Time, Goodput in Results) / Recoveries if Recoveries else 0))
+    return Exit_Code
+
+def Decode_CBL_Command(Command):
+    global Memory_Write_All
     
     if(Command == 1):
         print("Request the bootloader version")
-        CBL_GET_VER_CMD_Len = 6
-        BL_Host_Buffer[0] = CBL_GET_VER_CMD_Len - 1
-        BL_Host_Buffer[1] = CBL_GET_VER_CMD
-        CRC32_Value = Calculate_CRC32(BL_Host_Buffer, CBL_GET_VER_CMD_Len - 4)
-        CRC32_Value = CRC32_Value & 0xFFFFFFFF
-        print("Host CRC = ", hex(CRC32_Value))
-        BL_Host_Buffer[2] = Word_Value_To_Byte_Value(CRC32_Value, 1, 1)
-        BL_Host_Buffer[3] = Word_Value_To_Byte_Value(CRC32_Value, 2, 1)
-        BL_Host_Buffer[4] = Word_Value_To_Byte_Value(CRC32_Value, 3, 1)
-        BL_Host_Buffer[5] = Word_Value_To_Byte_Value(CRC32_Value, 4, 1)
-        Write_Data_To_Serial_Port(BL_Host_Buffer[0], 1)
-        for Data in BL_Host_Buffer[1 : CBL_GET_VER_CMD_Len]:
-            Write_Data_To_Serial_Port(Data, CBL_GET_VER_CMD_Len - 1)
+        Send_CBL_Frame(CBL_GET_VER_CMD)
         Read_Data_From_Serial_Port(CBL_GET_VER_CMD)
     elif (Command == 2):
         print("Read the commands supported by the bootloader")
-        CBL_GET_HELP_CMD_Len = 6
-        BL_Host_Buffer[0] = CBL_GET_HELP_CMD_Len - 1
-        BL_Host_Buffer[1] = CBL_GET_HELP_CMD
-        CRC32_Value = Calculate_CRC32(BL_Host_Buffer, CBL_GET_HELP_CMD_Len - 4)
-        CRC32_Value = CRC32_Value & 0xFFFFFFFF
-        BL_Host_Buffer[2] = Word_Value_To_Byte_Value(CRC32_Value, 1, 1)
-        BL_Host_Buffer[3] = Word_Value_To_Byte_Value(CRC32_Value, 2, 1)
-        BL_Host_Buffer[4] = Word_Value_To_Byte_Value(CRC32_Value, 3, 1)
-        BL_Host_Buffer[5] = Word_Value_To_Byte_Value(CRC32_Value, 4, 1)
-        Write_Data_To_Serial_Port(BL_Host_Buffer[0], 1)
-        for Data in BL_Host_Buffer[1 : CBL_GET_HELP_CMD_Len]:
-            Write_Data_To_Serial_Port(Data, CBL_GET_HELP_CMD_Len - 1)
+        Send_CBL_Frame(CBL_GET_HELP_CMD)
         Read_Data_From_Serial_Port(CBL_GET_HELP_CMD)
     elif (Command == 3):
         print("Read the MCU chip identification number")
-        CBL_GET_CID_CMD_Len = 6
-        BL_Host_Buffer[0] = CBL_GET_CID_CMD_Len - 1
-        BL_Host_Buffer[1] = CBL_GET_CID_CMD
-        CRC32_Value = Calculate_CRC32(BL_Host_Buffer, CBL_GET_CID_CMD_Len - 4)
-        CRC32_Value = CRC32_Value & 0xFFFFFFFF
-        BL_Host_Buffer[2] = Word_Value_To_Byte_Value(CRC32_Value, 1, 1)
-        BL_Host_Buffer[3] = Word_Value_To_Byte_Value(CRC32_Value, 2, 1)
-        BL_Host_Buffer[4] = Word_Value_To_Byte_Value(CRC32_Value, 3, 1)
-        BL_Host_Buffer[5] = Word_Value_To_Byte_Value(CRC32_Value, 4, 1)
-        Write_Data_To_Serial_Port(BL_Host_Buffer[0], 1)
-        for Data in BL_Host_Buffer[1 : CBL_GET_CID_CMD_Len]:
-            Write_Data_To_Serial_Port(Data, CBL_GET_CID_CMD_Len - 1)
+        Send_CBL_Frame(CBL_GET_CID_CMD)
         Read_Data_From_Serial_Port(CBL_GET_CID_CMD)
     elif (Command == 4):
         print("Read the FLASH Read Protection level")
-        CBL_GET_RDP_STATUS_CMD_Len = 6
-        BL_Host_Buffer[0] = CBL_GET_RDP_STATUS_CMD_Len - 1
-        BL_Host_Buffer[1] = CBL_GET_RDP_STATUS_CMD
-        CRC32_Value = Calculate_CRC32(BL_Host_Buffer, CBL_GET_RDP_STATUS_CMD_Len - 4)
-        CRC32_Value = CRC32_Value & 0xFFFFFFFF
-        BL_Host_Buffer[2] = Word_Value_To_Byte_Value(CRC32_Value, 1, 1)
-        BL_Host_Buffer[3] = Word_Value_To_Byte_Value(CRC32_Value, 2, 1)
-        BL_Host_Buffer[4] = Word_Value_To_Byte_Value(CRC32_Value, 3, 1)
-        BL_Host_Buffer[5] = Word_Value_To_Byte_Value(CRC32_Value, 4, 1)
-        Write_Data_To_Serial_Port(BL_Host_Buffer[0], 1)
-        for Data in BL_Host_Buffer[1 : CBL_GET_RDP_STATUS_CMD_Len]:
-            Write_Data_To_Serial_Port(Data, CBL_GET_RDP_STATUS_CMD_Len - 1)
+        Send_CBL_Frame(CBL_GET_RDP_STATUS_CMD)
         Read_Data_From_Serial_Port(CBL_GET_RDP_STATUS_CMD)
     elif (Command == 5):
         print("Jump bootloader to specified address command")
-        CBL_GO_TO_ADDR_CMD_Len = 10
         CBL_Jump_Address = input("\n   Please Enter the Address in Hex : ")
         CBL_Jump_Address = int(CBL_Jump_Address, 16)
-        BL_Host_Buffer[0] = CBL_GO_TO_ADDR_CMD_Len - 1
-        BL_Host_Buffer[1] = CBL_GO_TO_ADDR_CMD
-        BL_Host_Buffer[2] = Word_Value_To_Byte_Value(CBL_Jump_Address, 1, 1) 
-        BL_Host_Buffer[3] = Word_Value_To_Byte_Value(CBL_Jump_Address, 2, 1) 
-        BL_Host_Buffer[4] = Word_Value_To_Byte_Value(CBL_Jump_Address, 3, 1) 
-        BL_Host_Buffer[5] = Word_Value_To_Byte_Value(CBL_Jump_Address, 4, 1)
-        CRC32_Value = Calculate_CRC32(BL_Host_Buffer, CBL_GO_TO_ADDR_CMD_Len - 4) 
-        CRC32_Value = CRC32_Value & 0xFFFFFFFF
-        BL_Host_Buffer[6] = Word_Value_To_Byte_Value(CRC32_Value, 1, 1)
-        BL_Host_Buffer[7] = Word_Value_To_Byte_Value(CRC32_Value, 2, 1)
-        BL_Host_Buffer[8] = Word_Value_To_Byte_Value(CRC32_Value, 3, 1)
-        BL_Host_Buffer[9] = Word_Value_To_Byte_Value(CRC32_Value, 4, 1)
-        Write_Data_To_Serial_Port(BL_Host_Buffer[0], 1)
-        for Data in BL_Host_Buffer[1 : CBL_GO_TO_ADDR_CMD_Len]:
-            Write_Data_To_Serial_Port(Data, CBL_GO_TO_ADDR_CMD_Len - 1)
+        Send_CBL_Frame(CBL_GO_TO_ADDR_CMD, struct.pack('<I', CBL_Jump_Address))
         Read_Data_From_Serial_Port(CBL_GO_TO_ADDR_CMD)
     elif (Command == 6):
         print("Mass erase or sector erase of the user flash command")
-        CBL_FLASH_ERASE_CMD_Len = 8
-        SectorNumber = 0
         NumberOfSectors = 0
-        BL_Host_Buffer[0] = CBL_FLASH_ERASE_CMD_Len - 1
-        BL_Host_Buffer[1] = CBL_FLASH_ERASE_CMD
         SectorNumber = input("\n   Please enter start sector number(0-11)          : ")
         SectorNumber = int(SectorNumber, 16)
         if(SectorNumber != 0xFF):
             NumberOfSectors = int(input("\n   Please enter number of sectors to erase (12 Max): "), 16)
-        BL_Host_Buffer[2] = SectorNumber
-        BL_Host_Buffer[3] = NumberOfSectors
-        CRC32_Value = Calculate_CRC32(BL_Host_Buffer, CBL_FLASH_ERASE_CMD_Len - 4) 
-        CRC32_Value = CRC32_Value & 0xFFFFFFFF
-        BL_Host_Buffer[4] = Word_Value_To_Byte_Value(CRC32_Value, 1, 1)
-        BL_Host_Buffer[5] = Word_Value_To_Byte_Value(CRC32_Value, 2, 1)
-        BL_Host_Buffer[6] = Word_Value_To_Byte_Value(CRC32_Value, 3, 1)
-        BL_Host_Buffer[7] = Word_Value_To_Byte_Value(CRC32_Value, 4, 1)
-        Write_Data_To_Serial_Port(BL_Host_Buffer[0], 1)
-        for Data in BL_Host_Buffer[1 : CBL_FLASH_ERASE_CMD_Len]:
-            Write_Data_To_Serial_Port(Data, CBL_FLASH_ERASE_CMD_Len - 1)
+        Send_CBL_Erase_Frame(SectorNumber, NumberOfSectors)
         Read_Data_From_Serial_Port(CBL_FLASH_ERASE_CMD)
     elif (Command == 7):
         print("Write data into different memories of the MCU command")
-        global Memory_Write_Is_Active
-        global Memory_Write_All
-        File_Total_Len = 0
-        BinFileRemainingBytes = 0
-        BinFileSentBytes = 0
-        BaseMemoryAddress = 0
-        BinFileReadLength = 0
         Memory_Write_All = 1
         
-        ''' Get the total length of the binary file '''
-        File_Total_Len = CalulateBinFileLength()
-        print("   Preparing writing a binary file with length (", File_Total_Len, ") Bytes")
-        ''' Open the binary file '''
-        OpenBinFile()
-        ''' Calculate the remaining payload '''
-        BinFileRemainingBytes = File_Total_Len - BinFileSentBytes
+        ''' Map the binary file, each frame takes a 128 bytes slice of it '''
+        Image = Map_Image_File('Application.bin')
+        print("   Preparing writing a binary file with length (", len(Image), ") Bytes")
         ''' Get the start address to write the payload '''
         BaseMemoryAddress = input("\n   Enter the start address : ")
         BaseMemoryAddress = int(BaseMemoryAddress, 16)
         ''' Keep sending the write packet till the last payload byte '''
-        while(BinFileRemainingBytes):
-            ''' Memory write is active '''
-            Memory_Write_Is_Active = 1
-            
-            ''' Read 128 bytes from the binary file each time '''
-            if(BinFileRemainingBytes >= 128):
-                BinFileReadLength = 128
-            else:
-                BinFileReadLength = BinFileRemainingBytes
-            
-            for BinFileByte in range(BinFileReadLength):
-                BinFileByteValue = BinFile.read(1)
-                BinFileByteValue = bytearray(BinFileByteValue)
-                BL_Host_Buffer[7 + BinFileByte] = int(BinFileByteValue[0])
-            
-            ''' Update the Host packet with the command code ID '''
-            BL_Host_Buffer[1] = CBL_MEM_WRITE_CMD
-        
-            ''' Update the Host packet with the base address '''
-            BL_Host_Buffer[2] = Word_Value_To_Byte_Value(BaseMemoryAddress, 1, 1)
-            BL_Host_Buffer[3] = Word_Value_To_Byte_Value(BaseMemoryAddress, 2, 1)
-            BL_Host_Buffer[4] = Word_Value_To_Byte_Value(BaseMemoryAddress, 3, 1)
-            BL_Host_Buffer[5] = Word_Value_To_Byte_Value(BaseMemoryAddress, 4, 1)
+        for BinFileSentBytes in range(0, len(Image), 128):
+            Chunk = Image[BinFileSentBytes : BinFileSentBytes + 128]
+            Send_CBL_Write_Frame(CBL_MEM_WRITE_CMD, BaseMemoryAddress + BinFileSentBytes, Chunk)
+            print("\n   Bytes sent to the bootloader :{0}".format(BinFileSentBytes + len(Chunk)))
             
-            ''' Update the Host packet with the payload length '''
-            BL_Host_Buffer[6] = BinFileReadLength
-            
-            ''' Update the Host packet with the packet length '''
-            CBL_MEM_WRITE_CMD_Len = (BinFileReadLength + 11)
-            BL_Host_Buffer[0] = CBL_MEM_WRITE_CMD_Len - 1
-            
-            ''' Update the Host packet with the calculated CRC32 '''
-            CRC32_Value = Calculate_CRC32(BL_Host_Buffer, CBL_MEM_WRITE_CMD_Len - 4) 
-            CRC32_Value = CRC32_Value & 0xFFFFFFFF
-            BL_Host_Buffer[7 + BinFileReadLength] = Word_Value_To_Byte_Value(CRC32_Value, 1, 1)
-            BL_Host_Buffer[8 + BinFileReadLength] = Word_Value_To_Byte_Value(CRC32_Value, 2, 1)
-            BL_Host_Buffer[9 + BinFileReadLength] = Word_Value_To_Byte_Value(CRC32_Value, 3, 1)
-            BL_Host_Buffer[10+ BinFileReadLength] = Word_Value_To_Byte_Value(CRC32_Value, 4, 1)
-            
-            ''' Calculate the next Base memory address '''
-            BaseMemoryAddress = BaseMemoryAddress + BinFileReadLength
-            
-            ''' Send the packet length to the bootloader '''
-            Write_Data_To_Serial_Port(BL_Host_Buffer[0], 1)
-            
-            ''' Send the complete packet to the bootloader '''
-            for Data in BL_Host_Buffer[1 : CBL_MEM_WRITE_CMD_Len]:
-                Write_Data_To_Serial_Port(Data, CBL_MEM_WRITE_CMD_Len - 1)
-            
-            ''' Update the total number of bytes sent to the bootloader '''
-            BinFileSentBytes = BinFileSentBytes + BinFileReadLength
-            
-            ''' Calculate the remaining payload '''
-            BinFileRemainingBytes = File_Total_Len - BinFileSentBytes
-            print("\n   Bytes sent to the bootloader :{0}".format(BinFileSentBytes))
-            
-            ''' Read the response from the bootloader '''
-            BL_Return_Value = Read_Data_From_Serial_Port(CBL_MEM_WRITE_CMD)
-            sleep(0.1)
-        ''' Memory write is inactive '''
-        Memory_Write_Is_Active = 0
+            ''' The write status releases the next frame '''
+            if(not Read_Data_From_Serial_Port(CBL_MEM_WRITE_CMD) or not Memory_Write_All):
+                break
+        if(Memory_Write_All == 1):
+            print("\n\n Payload Written Successfully")
+    elif (Command == 15):
+        print("Write a compressed image into the MCU flash command")
+        Memory_Write_All = 1
+        Image = Map_Image_File('Application.bin')
+        BaseMemoryAddress = int(input("\n   Enter the start address : "), 16)
+        Frames = LZ_Compress_Frames(Image)
+        Compressed_Len = sum(len(Frame[2]) for Frame in Frames)
+        print("   Compressed (", len(Image), ") Bytes into (", Compressed_Len, ") Bytes in", len(Frames), "frames")
+        for Frame_Offset, Frame_Output_Len, Payload in Frames:
+            Send_CBL_Write_Frame(CBL_MEM_WRITE_LZ_CMD, BaseMemoryAddress + Frame_Offset, Payload, Frame_Output_Len)
+            print("\n   Bytes written to the flash :{0}".format(Frame_Offset + Frame_Output_Len))
+            if(not Read_Data_From_Serial_Port(CBL_MEM_WRITE_LZ_CMD) or not Memory_Write_All):
+                break
         if(Memory_Write_All == 1):
             print("\n\n Payload Written Successfully")
+    elif (Command == 16):
+        print("Write a run-length coded image into the MCU flash command")
+        Memory_Write_All = 1
+        Image = Map_Image_File('Application.bin')
+        BaseMemoryAddress = int(input("\n   Enter the start address : "), 16)
+        Frames = RLE_Encode_Frames(Image)
+        Coded_Len = sum(len(Frame[2]) for Frame in Frames)
+        print("   Coded (", len(Image), ") Bytes into (", Coded_Len, ") Bytes in", len(Frames), "frames")
+        for Frame_Offset, Frame_Output_Len, Payload in Frames:
+            Send_CBL_Write_Frame(CBL_MEM_WRITE_RLE_CMD, BaseMemoryAddress + Frame_Offset, Payload, Frame_Output_Len)
+            print("\n   Bytes written to the flash :{0}".format(Frame_Offset + Frame_Output_Len))
+            if(not Read_Data_From_Serial_Port(CBL_MEM_WRITE_RLE_CMD) or not Memory_Write_All):
+                break
+        if(Memory_Write_All == 1):
+            print("\n\n Payload Written Successfully")
+    elif (Command == 17):
+        print("Write a sparse image (Intel HEX / ELF) segment by segment and verify the session CRC")
+        Memory_Write_All = 1
+        Segments = Merge_Segments(Load_Image_Segments(input("\n   Enter the image file name : ")), BL_MAX_SEGMENTS)
+        Payload_Total_Len = sum(len(Segment[1]) for Segment in Segments)
+        print("   Sending (", Payload_Total_Len, ") Bytes in", len(Segments), "segments, span (",
+              Segments[-1][0] + len(Segments[-1][1]) - Segments[0][0], ") Bytes")
+        ''' Only the pages touched by a segment are erased, the rest of such a page reads 0xFF afterwards '''
+        for First_Page, Page_Count in Segment_Page_Runs(Segments):
+            Send_CBL_Erase_Frame(First_Page, Page_Count)
+            Read_Data_From_Serial_Port(CBL_FLASH_ERASE_CMD)
+        for Segment_Address, Segment_Data in Segments:
+            Segment_View = memoryview(Segment_Data)
+            for Chunk_Offset in range(0, len(Segment_Data), SEGMENT_WRITE_CHUNK):
+                Chunk = Segment_View[Chunk_Offset : Chunk_Offset + SEGMENT_WRITE_CHUNK]
+                Send_CBL_Write_Frame(CBL_MEM_WRITE_CMD, Segment_Address + Chunk_Offset, Chunk)
+                print("\n   Segment 0x{:08X} bytes written :{}".format(Segment_Address, Chunk_Offset + len(Chunk)))
+                if(not Read_Data_From_Serial_Port(CBL_MEM_WRITE_CMD) or not Memory_Write_All):
+                    break
+            if(not Memory_Write_All):
+                break
+        ''' One CRC over all segments back to back '''
+        Session_Data = bytearray()
+        Segment_List = bytearray([len(Segments)])
+        for Segment_Address, Segment_Data in Segments:
+            Session_Data.extend(Segment_Data)
+            Segment_List.extend(struct.pack('<II', Segment_Address, len(Segment_Data)))
+        Session_CRC32 = Calculate_CRC32(Session_Data, len(Session_Data)) & 0xFFFFFFFF
+        Send_CBL_Frame(CBL_VERIFY_SEGMENTS_CMD, Segment_List, struct.pack('<I', Session_CRC32),
+                       Device_Time = len(Session_Data) * FLASH_CRC_BYTE_TIME)
+        Read_Data_From_Serial_Port(CBL_VERIFY_SEGMENTS_CMD)
+        if(Memory_Write_All == 1):
+            print("\n\n Payload Written Successfully")
+    elif (Command == 10):
+        print("Read the protection, blank state and CRC of every flash page")
+        Send_CBL_Frame(CBL_READ_SECTOR_STATUS_CMD, Device_Time = FLASH_MAX_PAGE_COUNT * FLASH_PAGE_SIZE * FLASH_CRC_BYTE_TIME)
+        Read_Data_From_Serial_Port(CBL_READ_SECTOR_STATUS_CMD)
+    elif (Command == 18):
+        print("Read version, chip ID, protection level and commands in one frame")
+        try:
+            Process_CBL_BATCH_CMD(BL_Menu_Session.Batch(BL_IDENTIFY_COMMANDS))
+        except BL_Session_Error as Error:
+            print("\n   {}".format(Error))
     elif (Command == 12):
         print("Change read protection level of the user flash command")
         Protection_level = input("\n   Please Enter one of these Protection levels : 0,1,2 : ")
@@ -430,25 +1855,114 @@ def Decode_CBL_Command(Command):
             print("\n   Protection level (2) not supported !!")
         elif(Protection_level == 0 or Protection_level == 1):
             print("\n   Changing the protection level to be : ", Protection_level)
-            CBL_CHANGE_ROP_Level_CMD_Len = 7
-            BL_Host_Buffer[0] = CBL_CHANGE_ROP_Level_CMD_Len - 1
-            BL_Host_Buffer[1] = CBL_CHANGE_ROP_Level_CMD
-            BL_Host_Buffer[2] = Protection_level
-            CRC32_Value = Calculate_CRC32(BL_Host_Buffer, CBL_CHANGE_ROP_Level_CMD_Len - 4) 
-            CRC32_Value = CRC32_Value & 0xFFFFFFFF
-            BL_Host_Buffer[3] = Word_Value_To_Byte_Value(CRC32_Value, 1, 1)
-            BL_Host_Buffer[4] = Word_Value_To_Byte_Value(CRC32_Value, 2, 1)
-            BL_Host_Buffer[5] = Word_Value_To_Byte_Value(CRC32_Value, 3, 1)
-            BL_Host_Buffer[6] = Word_Value_To_Byte_Value(CRC32_Value, 4, 1)
-            Write_Data_To_Serial_Port(BL_Host_Buffer[0], 1)
-            for Data in BL_Host_Buffer[1 : CBL_CHANGE_ROP_Level_CMD_Len]:
-                Write_Data_To_Serial_Port(Data, CBL_CHANGE_ROP_Level_CMD_Len - 1)
+            Send_CBL_Frame(CBL_CHANGE_ROP_Level_CMD, bytes([Protection_level]), Device_Time = 2 * FLASH_PAGE_ERASE_TIME)
             Read_Data_From_Serial_Port(CBL_CHANGE_ROP_Level_CMD)
         else:
             print("\n   Protection level (", Protection_level, ") not supported !!")
+    elif (Command == 13 or Command == 14):
+        if(Command == 13):
+            print("Read the A/B slot layout")
+            CBL_SLOT_CMD = CBL_GET_SLOT_INFO_CMD
+        else:
+            print("Boot the image in the update slot from the next reset")
+            CBL_SLOT_CMD = CBL_SWITCH_SLOT_CMD
+        Send_CBL_Frame(CBL_SLOT_CMD)
+        Read_Data_From_Serial_Port(CBL_SLOT_CMD)
             
         
 
+Parser = argparse.ArgumentParser(description = "STM32F103 custom bootloader host")
+Parser.add_argument('--baud', type = int, default = BL_Baudrate, help = "UART baud rate, also used for the response timeouts")
+Parser.add_argument('--pace', type = float, default = 0, metavar = 'SECONDS',
+                    help = "extra delay after every response, only for legacy bootloader firmware")
+Subparsers = Parser.add_subparsers(dest = 'action', help = "without an action the interactive menu starts")
+Subparsers.add_parser('ports', help = "list the serial ports found on this machine")
+Flash_Parser = Subparsers.add_parser('flash', help = "erase, write and optionally verify and start an image")
+Flash_Parser.add_argument('image', help = ".bin, .hex or .elf image")
+Flash_Parser.add_argument('--port', required = True, nargs = '+',
+                          help = "serial port, e.g. /dev/ttyUSB0 or COM3, several ports are flashed in parallel")
+Flash_Parser.add_argument('--addr', type = lambda Value: int(Value, 0), default = APP_BASE_ADDRESS,
+                          help = "load address of a .bin image and vector table address for --jump")
+Flash_Parser.add_argument('--verify', action = 'store_true', help = "check the session CRC after writing")
+Flash_Parser.add_argument('--jump', action = 'store_true', help = "start the image after writing")
+Flash_Parser.add_argument('--delta', action = 'store_true',
+                          help = "read the page CRCs first and only erase and write the pages that differ")
+Flash_Parser.add_argument('--mode', choices = sorted(BL_WRITE_MODES), default = 'raw',
+                          help = "write frames: raw, LZ compressed, run length encoded or sequence numbered")
+Flash_Parser.add_argument('--window', type = int, default = BL_DEFAULT_WINDOW,
+                          help = "sequence numbered frames in flight with --mode seq, as many as fit in 1 KB")
+Flash_Parser.add_argument('--retries', type = int, default = BL_DEFAULT_RETRIES,
+                          help = "resend a frame and rewrite a page this many times after a link error")
+Flash_Parser.add_argument('--sign', metavar = 'KEY', help = "sign the image with the private key from keygen, "
+                          "the bootloader checks the signature before --jump")
+Flash_Parser.add_argument('--aes-key', metavar = 'KEY', help = "image encryption key from keygen --aes, for --mode aes")
+Flash_Parser.add_argument('--no-cache', action = 'store_true', help = "always rebuild the transfer plan")
+Flash_Parser.add_argument('--verbose', action = 'store_true', help = "show every frame and reply")
+Bench_Parser = Subparsers.add_parser('bench', help = "flash an image repeatedly and report goodput and recovery time per write mode")
+Bench_Parser.add_argument('image', help = ".bin, .hex or .elf image")
+Bench_Parser.add_argument('--port', required = True, help = "serial port, usually a BL_Simulator.py link")
+Bench_Parser.add_argument('--addr', type = lambda Value: int(Value, 0), default = APP_BASE_ADDRESS,
+                          help = "load address of a .bin image")
+Bench_Parser.add_argument('--modes', nargs = '+', choices = sorted(BL_WRITE_MODES), default = ['raw', 'lz', 'rle', 'seq'])
+Bench_Parser.add_argument('--window', type = int, default = BL_DEFAULT_WINDOW, help = "sequence numbered frames in flight")
+Bench_Parser.add_argument('--runs', type = int, default = 3, help = "flash runs per mode")
+Bench_Parser.add_argument('--retries', type = int, default = BL_DEFAULT_RETRIES,
+                          help = "resend a frame and rewrite a page this many times after a link error")
+Bench_Parser.add_argument('--aes-key', metavar = 'KEY', help = "image encryption key from keygen --aes, for the aes mode")
+Bench_Parser.add_argument('--no-cache', action = 'store_true', help = "always rebuild the transfer plans")
+Bench_Parser.add_argument('--verbose', action = 'store_true', help = "show every frame and reply")
+Broadcast_Parser = Subparsers.add_parser('broadcast', help = "update every node of a shared RS-485 or CAN bus with one stream")
+Broadcast_Parser.add_argument('image', help = ".bin, .hex or .elf image")
+Broadcast_Parser.add_argument('--port', required = True, help = "serial port of the bus adapter")
+Broadcast_Parser.add_argument('--nodes', required = True, nargs = '+', type = lambda Value: int(Value, 0),
+                              help = "node addresses, e.g. 0x3A5C, as printed at start-up or read with the node action")
+Broadcast_Parser.add_argument('--addr', type = lambda Value: int(Value, 0), default = APP_BASE_ADDRESS,
+                              help = "load address of a .bin image and vector table address for --jump")
+Broadcast_Parser.add_argument('--jump', action = 'store_true', help = "start the image on every node after it checked fine")
+Broadcast_Parser.add_argument('--window', type = int, default = BL_DEFAULT_WINDOW, help = "repair frames in flight per node")
+Broadcast_Parser.add_argument('--retries', type = int, default = BL_DEFAULT_RETRIES,
+                              help = "resend a frame and rewrite a page this many times after a link error")
+Broadcast_Parser.add_argument('--no-cache', action = 'store_true', help = "always rebuild the transfer plan")
+Broadcast_Parser.add_argument('--verbose', action = 'store_true', help = "show every frame and reply")
+Keygen_Parser = Subparsers.add_parser('keygen', help = "make a P-256 key pair for signed images, or an AES key")
+Keygen_Parser.add_argument('--key', required = True, help = "private key file, the public key goes to KEY.pub")
+Keygen_Parser.add_argument('--aes', action = 'store_true', help = "make an AES-128 key for encrypted images instead")
+Info_Parser = Subparsers.add_parser('info', help = "read version, chip ID, protection level and commands in one round trip")
+Info_Parser.add_argument('--port', required = True, help = "serial port, e.g. /dev/ttyUSB0 or COM3")
+Node_Parser = Subparsers.add_parser('node', help = "read the bus address of the one board on the port")
+Node_Parser.add_argument('--port', required = True, help = "serial port, e.g. /dev/ttyUSB0 or COM3")
+Arguments = Parser.parse_args()
+BL_Baudrate = Arguments.baud
+BL_Pace_Delay = Arguments.pace
+
+CRC32_Self_Test()
+if(Arguments.action == 'ports'):
+    for Serial_Port in Check_Serial_Ports():
+        print(Serial_Port)
+    sys.exit(EXIT_OK)
+elif(Arguments.action == 'flash'):
+    sys.exit(Batch_Flash(Arguments))
+elif(Arguments.action == 'bench'):
+    sys.exit(Bench(Arguments))
+elif(Arguments.action == 'broadcast'):
+    sys.exit(Broadcast_Flash(Arguments))
+elif(Arguments.action == 'keygen'):
+    sys.exit(Keygen(Arguments))
+elif(Arguments.action == 'node' or Arguments.action == 'info'):
+    Session = BL_Session(Arguments.port, BL_Baudrate, BL_Pace_Delay, Retries = BL_DEFAULT_RETRIES)
+    try:
+        Session.Open()
+        if(Arguments.action == 'node'):
+            print("0x{:04X}".format(Session.Select_Node(BL_NODE_ANY)))
+        else:
+            Process_CBL_BATCH_CMD(Session.Batch(BL_IDENTIFY_COMMANDS))
+    except BL_Session_Error as Error:
+        print("{} : {} (exit {})".format(Arguments.port, Error, Error.Exit_Code))
+        sys.exit(Error.Exit_Code)
+    finally:
+        Session.Close()
+    sys.exit(EXIT_OK)
+
 SerialPortName = input("Enter the Port Name of your device(Ex: COM3):")
 Serial_Port_Configuration(SerialPortName)
         
@@ -468,6 +1982,12 @@ while True:
     print("   CBL_READ_SECTOR_STATUS_CMD   --> 10")
     print("   CBL_OTP_READ_CMD             --> 11")
     print("   CBL_CHANGE_ROP_Level_CMD     --> 12")
+    print("   CBL_GET_SLOT_INFO_CMD        --> 13")
+    print("   CBL_SWITCH_SLOT_CMD          --> 14")
+    print("   CBL_MEM_WRITE_LZ_CMD         --> 15")
+    print("   CBL_MEM_WRITE_RLE_CMD        --> 16")
+    print("   CBL_VERIFY_SEGMENTS_CMD      --> 17")
+    print("   CBL_BATCH_CMD                --> 18")
     
     CBL_Command = input("\nEnter the command code : ")
     
@@ -477,4 +1997,4 @@ while True:
         Decode_CBL_Command(int(CBL_Command))
     
     input("\nPlease press any key to continue ...")
-    Serial_Port_Obj.reset_input_buffer()
\ No newline at end of file
+    Serial_Port_Obj.reset_input_buffer()
\ No newline at end of file